@@ -12,8 +12,16 @@ const EventType = {
     InputText : '13 ',
 };
 
+// must match ImDrawDataCompressor::Encoding
+const DrawListEncoding = {
+    Tessellated : 0,
+    Semantic : 1,
+};
+
+// must match ImGuiWS::EServerEventType
 const ServerEventType = {
     SetClipboardText : 0,
+    FreeTexture : 1,
 };
 
 var imgui_ws = {
@@ -29,6 +37,7 @@ var imgui_ws = {
     attribute_location_position: null,
     attribute_location_uv: null,
     attribute_location_color: null,
+    attribute_location_sdf_spread: null,
 
     device_pixel_ratio: window.device_pixel_ratio || 1,
 
@@ -38,6 +47,14 @@ var imgui_ws = {
 
     n_draw_lists: null,
     draw_lists_abuf: {},
+    semantic_cache: {},
+
+    glyph_table_rev: 0,
+    glyph_table: null,
+    glyph_table_u32: null,
+
+    // distance covered by the glyphs of the font texture, 0 when they hold coverage
+    font_sdf_spread: 0,
 
     io: {
         mouse_x: 0.0,
@@ -71,6 +88,9 @@ var imgui_ws = {
                     let clipboard_text = incppect.abut_to_str(payload);
                     navigator.clipboard.writeText(clipboard_text);
                     break;
+                case ServerEventType.FreeTexture:
+                    imgui_ws.free_tex(incppect, new Uint32Array(payload, 0, 1)[0]);
+                    break;
                 default:
                     console.error("to server event %s not handle", event_id);
             }
@@ -246,13 +266,24 @@ var imgui_ws = {
         this.gl.shaderSource(vertex_shader, vertex_shader_source);
         this.gl.compileShader(vertex_shader);
 
+        // distance fields are resolved with their screen space rate of change, so text is sharp at any scale
+        const has_derivatives = this.gl.getExtension('OES_standard_derivatives') !== null;
         const fragment_shader_source = [
+            (has_derivatives ? '#extension GL_OES_standard_derivatives : enable\n' : '') +
             'precision mediump float;' +
             'uniform sampler2D Texture;' +
+            'uniform float SdfSpread;' +
             'varying vec2 Frag_UV;' +
             'varying vec4 Frag_Color;' +
             'void main() {' +
-            '	gl_FragColor = Frag_Color * texture2D(Texture, Frag_UV.st);' +
+            '	vec4 col = texture2D(Texture, Frag_UV.st);' +
+            '	if (SdfSpread > 0.0) {' +
+            '		float dist = (col.a * 255.0 - 128.0) * SdfSpread / 128.0;' +
+            (has_derivatives ?
+            '		col.a = clamp(dist / max(fwidth(dist), 0.0001) + 0.5, 0.0, 1.0);' :
+            '		col.a = clamp(dist + 0.5, 0.0, 1.0);') +
+            '	}' +
+            '	gl_FragColor = Frag_Color * col;' +
             '}'
         ];
 
@@ -270,9 +301,11 @@ var imgui_ws = {
         this.attribute_location_position = this.gl.getAttribLocation(this.shader_program,    "Position");
         this.attribute_location_uv       = this.gl.getAttribLocation(this.shader_program,    "UV");
         this.attribute_location_color    = this.gl.getAttribLocation(this.shader_program,    "Color");
+        this.attribute_location_sdf_spread = this.gl.getUniformLocation(this.shader_program, "SdfSpread");
     },
 
     incppect_textures: function(incppect) {
+        this.font_sdf_spread = incppect.get_int32('imgui.font_sdf_spread') || 0;
         const n_textures = incppect.get_int32('imgui.n_textures');
 
         for (let i = 0; i < n_textures; ++i) {
@@ -351,7 +384,29 @@ var imgui_ws = {
         }
     },
 
+    free_tex: function(incppect, tex_id) {
+        if (this.tex_map_id[tex_id]) {
+            this.gl.deleteTexture(this.tex_map_id[tex_id]);
+        }
+        delete this.tex_map_id[tex_id];
+        delete this.tex_map_rev[tex_id];
+        delete this.tex_map_abuf[tex_id];
+
+        // incppect.vars_map keeps the last received pixels of the var, the server diffs a restored texture against them
+    },
+
     incppect_draw_lists: function(incppect) {
+        // the table only changes with the font atlas, stop requesting it once it is loaded
+        const glyph_table_rev = incppect.get_int32('imgui.glyph_table_revision');
+        if (glyph_table_rev > 0 && glyph_table_rev != this.glyph_table_rev) {
+            const abuf = incppect.get_abuf('imgui.glyph_table');
+            if (abuf.byteLength >= 8 && new Uint32Array(abuf, 0, 1)[0] == glyph_table_rev) {
+                this.glyph_table = new Float32Array(abuf.slice(8));
+                this.glyph_table_u32 = new Uint32Array(this.glyph_table.buffer);
+                this.glyph_table_rev = glyph_table_rev;
+            }
+        }
+
         this.n_draw_lists = incppect.get_int32('imgui.n_draw_lists');
         if (this.n_draw_lists < 1) return;
 
@@ -360,6 +415,126 @@ var imgui_ws = {
         }
     },
 
+    // rebuilds the vertex and index buffers from a semantic draw list, see compressor-semantic-per-draw-list.cpp
+    decode_semantic_list: function(abuf, draw_data_offset) {
+        const u32 = new Uint32Array(abuf, draw_data_offset);
+        const f32 = new Float32Array(abuf, draw_data_offset);
+
+        // glyph runs need the matching glyph table, skip the list until it arrives
+        const glyph_table_rev = u32[0];
+        if (glyph_table_rev != 0 && glyph_table_rev != this.glyph_table_rev) {
+            return null;
+        }
+        const gf = this.glyph_table;
+        const gu = this.glyph_table_u32;
+
+        const offset_x = f32[1];
+        const offset_y = f32[2];
+        const n_vertices = u32[3];
+        const n_indices = u32[4];
+        let r = 5;
+
+        const av = new Float32Array(5*n_vertices);
+        const av_u32 = new Uint32Array(av.buffer);
+        let nv = 0;
+
+        const vtx = function(x, y, u, v, col) {
+            av[5*nv + 0] = x + offset_x;
+            av[5*nv + 1] = y + offset_y;
+            av_u32[5*nv + 2] = u;
+            av_u32[5*nv + 3] = v;
+            av_u32[5*nv + 4] = col;
+            ++nv;
+        };
+
+        while (nv < n_vertices) {
+            const op = u32[r] & 0xFF;
+            const count = u32[r] >>> 8;
+            r += 1;
+            if (op == 0) {
+                for (let k = 0; k < count; ++k, r += 5) {
+                    vtx(f32[r], f32[r + 1], u32[r + 2], u32[r + 3], u32[r + 4]);
+                }
+            } else if (op == 1) {
+                for (let k = 0; k < count; ++k, r += 9) {
+                    const x0 = f32[r], y0 = f32[r + 1], x1 = f32[r + 2], y1 = f32[r + 3];
+                    const u0 = u32[r + 4], v0 = u32[r + 5], u1 = u32[r + 6], v1 = u32[r + 7];
+                    const col = u32[r + 8];
+                    vtx(x0, y0, u0, v0, col);
+                    vtx(x1, y0, u1, v0, col);
+                    vtx(x1, y1, u1, v1, col);
+                    vtx(x0, y1, u0, v1, col);
+                }
+            } else if (op == 2) {
+                const u = u32[r], v = u32[r + 1];
+                r += 2;
+                for (let k = 0; k < count; ++k, r += 5) {
+                    const x0 = f32[r], y0 = f32[r + 1], x1 = f32[r + 2], y1 = f32[r + 3];
+                    const col = u32[r + 4];
+                    vtx(x0, y0, u, v, col);
+                    vtx(x1, y0, u, v, col);
+                    vtx(x1, y1, u, v, col);
+                    vtx(x0, y1, u, v, col);
+                }
+            } else if (op == 3) {
+                const u = u32[r], v = u32[r + 1], col = u32[r + 2];
+                r += 3;
+                for (let k = 0; k < count; ++k, r += 2) {
+                    vtx(f32[r], f32[r + 1], u, v, col);
+                }
+            } else if (op == 4) {
+                // pen + glyph*scale, rounded to float32 after each operation like the server does
+                const scale = f32[r], col = u32[r + 1], pen_y = f32[r + 2];
+                r += 3;
+                for (let k = 0; k < count; ++k, r += 2) {
+                    const g = 8*u32[r];
+                    const pen_x = f32[r + 1];
+                    const x0 = Math.fround(pen_x + Math.fround(gf[g + 0]*scale));
+                    const y0 = Math.fround(pen_y + Math.fround(gf[g + 1]*scale));
+                    const x1 = Math.fround(pen_x + Math.fround(gf[g + 2]*scale));
+                    const y1 = Math.fround(pen_y + Math.fround(gf[g + 3]*scale));
+                    const u0 = gu[g + 4], v0 = gu[g + 5], u1 = gu[g + 6], v1 = gu[g + 7];
+                    vtx(x0, y0, u0, v0, col);
+                    vtx(x1, y0, u1, v0, col);
+                    vtx(x1, y1, u1, v1, col);
+                    vtx(x0, y1, u0, v1, col);
+                }
+            } else {
+                throw new Error('imgui-ws: unknown vertex op ' + op);
+            }
+        }
+
+        const ai = new Uint32Array(n_indices);
+        let ni = 0;
+
+        while (ni < n_indices) {
+            const op = u32[r] & 0xFF;
+            const count = u32[r] >>> 8;
+            r += 1;
+            if (op == 0) {
+                for (let k = 0; k < count; ++k) {
+                    ai[ni++] = u32[r++];
+                }
+            } else if (op == 1) {
+                let base = u32[r++];
+                for (let k = 0; k < count; ++k, base += 4) {
+                    ai[ni++] = base; ai[ni++] = base + 1; ai[ni++] = base + 2;
+                    ai[ni++] = base; ai[ni++] = base + 2; ai[ni++] = base + 3;
+                }
+            } else if (op == 2) {
+                const base = u32[r++];
+                for (let k = 2; k < count; ++k) {
+                    ai[ni++] = base; ai[ni++] = base + k - 1; ai[ni++] = base + k;
+                }
+            } else {
+                throw new Error('imgui-ws: unknown index op ' + op);
+            }
+        }
+
+        // incppect applies diffs to the var buffer in place, the commands are copied to stay with the vertices
+        return { abuf: abuf, av: av, ai: ai, cmds: abuf.slice(draw_data_offset + 4*r) };
+    },
+
     render: function(n_draw_lists, draw_lists_abuf) {
         if (typeof n_draw_lists === "undefined" && typeof draw_lists_abuf === "undefined") {
             if (this.n_draw_lists === null) return;
@@ -416,56 +591,86 @@ var imgui_ws = {
 
         for (let i_list = 0; i_list < n_draw_lists; ++i_list) {
             if (draw_lists_abuf[i_list].byteLength < 1) continue;
+            // semantic lists read their commands from the decoded copy
+            let list_abuf = draw_lists_abuf[i_list];
 
             let draw_data_offset = 0;
 
-            let p = new Float32Array(draw_lists_abuf[i_list], draw_data_offset, 2);
-            const offset_x = p[0];
-            draw_data_offset += 4;
-            const offset_y = p[1];
-            draw_data_offset += 4;
-
-            p = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 1);
-            const n_vertices = p[0];
+            let p = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 1);
+            const encoding = p[0];
             draw_data_offset += 4;
 
-            const av = new Float32Array(draw_lists_abuf[i_list], draw_data_offset, 5 * n_vertices);
-
-            for (let k = 0; k < n_vertices; ++k) {
-                av[5*k + 0] += offset_x;
-                av[5*k + 1] += offset_y;
-            }
+            if (encoding == DrawListEncoding.Semantic) {
+                let cache = this.semantic_cache[i_list];
+                const rev = incppect.get_rev('imgui.draw_list[%d]', i_list);
+                if (typeof cache === "undefined" || cache.abuf !== draw_lists_abuf[i_list] || cache.rev !== rev) {
+                    const decoded = this.decode_semantic_list(draw_lists_abuf[i_list], draw_data_offset);
+                    if (decoded !== null) {
+                        decoded.rev = rev;
+                        this.semantic_cache[i_list] = decoded;
+                        cache = decoded;
+                    } else if (typeof cache === "undefined") {
+                        continue;
+                    }
+                    // otherwise the previous list stays on screen until the matching glyph table is loaded
+                }
+                list_abuf = cache.cmds;
+                draw_data_offset = 0;
+
+                this.gl.bindBuffer(this.gl.ARRAY_BUFFER, this.vertex_buffer);
+                this.gl.bufferData(this.gl.ARRAY_BUFFER, cache.av, this.gl.STREAM_DRAW);
+
+                this.gl.bindBuffer(this.gl.ELEMENT_ARRAY_BUFFER, this.index_buffer);
+                this.gl.bufferData(this.gl.ELEMENT_ARRAY_BUFFER, cache.ai, this.gl.STREAM_DRAW);
+            } else {
+                p = new Float32Array(draw_lists_abuf[i_list], draw_data_offset, 2);
+                const offset_x = p[0];
+                draw_data_offset += 4;
+                const offset_y = p[1];
+                draw_data_offset += 4;
+
+                p = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 1);
+                const n_vertices = p[0];
+                draw_data_offset += 4;
+
+                const av = new Float32Array(draw_lists_abuf[i_list], draw_data_offset, 5 * n_vertices);
+
+                for (let k = 0; k < n_vertices; ++k) {
+                    av[5*k + 0] += offset_x;
+                    av[5*k + 1] += offset_y;
+                }
 
-            this.gl.bindBuffer(this.gl.ARRAY_BUFFER, this.vertex_buffer);
-            this.gl.bufferData(this.gl.ARRAY_BUFFER, av, this.gl.STREAM_DRAW);
+                this.gl.bindBuffer(this.gl.ARRAY_BUFFER, this.vertex_buffer);
+                this.gl.bufferData(this.gl.ARRAY_BUFFER, av, this.gl.STREAM_DRAW);
 
-            for (let k = 0; k < n_vertices; ++k) {
-                av[5*k + 0] -= offset_x;
-                av[5*k + 1] -= offset_y;
-            }
+                for (let k = 0; k < n_vertices; ++k) {
+                    av[5*k + 0] -= offset_x;
+                    av[5*k + 1] -= offset_y;
+                }
 
-            draw_data_offset += 5*4*n_vertices;
+                draw_data_offset += 5*4*n_vertices;
 
-            p = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 1);
-            const n_indices = p[0]; draw_data_offset += 4;
+                p = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 1);
+                const n_indices = p[0]; draw_data_offset += 4;
 
-            const ai = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, n_indices);
-            this.gl.bindBuffer(this.gl.ELEMENT_ARRAY_BUFFER, this.index_buffer);
-            this.gl.bufferData(this.gl.ELEMENT_ARRAY_BUFFER, ai, this.gl.STREAM_DRAW);
-            draw_data_offset += 4*n_indices;
+                const ai = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, n_indices);
+                this.gl.bindBuffer(this.gl.ELEMENT_ARRAY_BUFFER, this.index_buffer);
+                this.gl.bufferData(this.gl.ELEMENT_ARRAY_BUFFER, ai, this.gl.STREAM_DRAW);
+                draw_data_offset += 4*n_indices;
+            }
 
-            p = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 1);
+            p = new Uint32Array(list_abuf, draw_data_offset, 1);
             const n_cmd = p[0]; draw_data_offset += 4;
 
             for (let i_cmd = 0; i_cmd < n_cmd; ++i_cmd) {
-                const pi = new Uint32Array(draw_lists_abuf[i_list], draw_data_offset, 4);
+                const pi = new Uint32Array(list_abuf, draw_data_offset, 4);
                 const n_elements = pi[0]; draw_data_offset += 4;
                 // uint32 -> int32
                 const texture_id = (pi[1] << 0); draw_data_offset += 4;
                 const offset_vtx = pi[2]; draw_data_offset += 4;
                 const offset_idx = pi[3]; draw_data_offset += 4;
 
-                const pf = new Float32Array(draw_lists_abuf[i_list], draw_data_offset, 4);
+                const pf = new Float32Array(list_abuf, draw_data_offset, 4);
                 const clip_x = pf[0] - clip_off_x; draw_data_offset += 4;
                 const clip_y = pf[1] - clip_off_y; draw_data_offset += 4;
                 const clip_z = pf[2] - clip_off_x; draw_data_offset += 4;
@@ -477,6 +682,7 @@ var imgui_ws = {
                         this.gl.activeTexture(this.gl.TEXTURE0);
                         this.gl.bindTexture(this.gl.TEXTURE_2D, this.tex_map_id[texture_id]);
                     }
+                    this.gl.uniform1f(this.attribute_location_sdf_spread, texture_id === 0 ? this.font_sdf_spread : 0.0);
                     this.gl.drawElements(this.gl.TRIANGLES, n_elements, this.gl.UNSIGNED_INT, 4*offset_idx);
                 }
             }
@@ -8,6 +8,7 @@
     // vars data
     nvars: 0,
     vars_map: {},
+    vars_rev: {},
     var_to_id: {},
     id_to_var: {},
     last_data: null,
@@ -126,6 +127,15 @@
         return this.vars_map[path];
     },
 
+    // incremented each time the server updates the var, diffs modify the buffer in place
+    get_rev: function(path, ...args) {
+        for (let i = 1; i < arguments.length; i++) {
+            path = path.replace('%d', arguments[i]);
+        }
+
+        return this.vars_rev[path] || 0;
+    },
+
     get_abuf: function(path, ...args) {
         return this.get(path, ...args);
     },
@@ -347,6 +357,7 @@
             offset_new = offset + len/4;
             if (type === 0) {
                 this.vars_map[this.id_to_var[id]] = this.last_data.slice(4*offset, 4*offset_new);
+                this.vars_rev[this.id_to_var[id]] = (this.vars_rev[this.id_to_var[id]] || 0) + 1;
             }
             else if (type === 1) {
                 const src_view = new Uint32Array(this.last_data, 4 * offset);
@@ -361,6 +372,7 @@
                         ++k;
                     }
                 }
+                this.vars_rev[this.id_to_var[id]] = (this.vars_rev[this.id_to_var[id]] || 0) + 1;
             }
             else if (type === 2) {
                 this.event_handle(id, this.last_data.slice(4*offset, 4*offset_new));
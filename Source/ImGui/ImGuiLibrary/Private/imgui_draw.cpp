@@ -3783,11 +3783,14 @@ void ImFont::AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst)
 
 const ImFontGlyph* ImFont::FindGlyph(ImWchar c) const
 {
-    if (c >= (size_t)IndexLookup.Size)
-        return FallbackGlyph;
-    const ImWchar i = IndexLookup.Data[c];
+    const ImWchar i = (c < (size_t)IndexLookup.Size) ? IndexLookup.Data[c] : (ImWchar)-1;
     if (i == (ImWchar)-1)
+    {
+        // [UnrealImGui] Let the owner of the atlas bake the glyph, the fallback is drawn until then
+        if (ContainerAtlas && ContainerAtlas->RecordMissingGlyphs && !ContainerAtlas->MissingGlyphs.contains(c))
+            ContainerAtlas->MissingGlyphs.push_back(c);
         return FallbackGlyph;
+    }
     return &Glyphs.Data[i];
 }
 
@@ -3177,6 +3177,10 @@ struct ImFontAtlas
     int                         PackIdMouseCursors; // Custom texture rectangle ID for white pixel and mouse cursors
     int                         PackIdLines;        // Custom texture rectangle ID for baked anti-aliased lines
 
+    // [UnrealImGui] Glyphs baked on demand
+    bool                        RecordMissingGlyphs; // When set, FindGlyph() records codepoints without a glyph so the owner can bake them before the next frame.
+    ImVector<ImWchar>           MissingGlyphs;      // Codepoints recorded since the owner last cleared the list.
+
     // [Obsolete]
     //typedef ImFontAtlasCustomRect    CustomRect;         // OBSOLETED in 1.72+
     //typedef ImFontGlyphRangesBuilder GlyphRangesBuilder; // OBSOLETED in 1.67+
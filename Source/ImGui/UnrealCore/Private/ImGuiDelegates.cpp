@@ -9,3 +9,5 @@ FImGuiDelegates::FOnImGui_WS_Enable FImGuiDelegates::OnImGui_WS_Enable;
 FImGuiDelegates::FOnImGui_WS_Disable FImGuiDelegates::OnImGui_WS_Disable;
 FImGuiDelegates::FOnImGuiLocalPanelEnable FImGuiDelegates::OnImGuiLocalPanelEnable;
 FImGuiDelegates::FOnImGuiLocalPanelDisable FImGuiDelegates::OnImGuiLocalPanelDisable;
+FImGuiDelegates::FOnImGuiRequestRedraw FImGuiDelegates::OnImGuiRequestRedraw;
+FImGuiDelegates::FOnImGuiFontAtlasChanged FImGuiDelegates::OnImGuiFontAtlasChanged;
@@ -4,10 +4,486 @@
 #include "ImGuiFontAtlas.h"
 
 #include "imgui.h"
+#include "imgui_internal.h"
 #include "imgui_notify.h"
+#include "ImGuiDelegates.h"
 #include "ImGuiSettings.h"
+#include "UnrealImGui_Log.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
 #include "Interfaces/IPluginManager.h"
+#include "Misc/CoreDelegates.h"
 #include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+#ifndef STB_RECT_PACK_IMPLEMENTATION
+#define STBRP_STATIC
+#define STBRP_ASSERT(x) check(x)
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../../ImGuiLibrary/Private/imstb_rectpack.h"
+#endif
+
+#ifndef STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#define STBTT_assert(x) check(x)
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../../ImGuiLibrary/Private/imstb_truetype.h"
+#endif
+
+bool UnrealImGui::IsSignedDistanceFieldFont()
+{
+	static const bool bSignedDistanceField = GetDefault<UImGuiSettings>()->bSignedDistanceFieldFont;
+	return bSignedDistanceField;
+}
+
+namespace UnrealImGui
+{
+	// pixels of a glyph and their offset from the pen position
+	struct FGlyphBitmap
+	{
+		TArray<uint8> Pixels;
+		int32 Width = 0;
+		int32 Height = 0;
+		int32 OffsetX = 0;
+		int32 OffsetY = 0;
+	};
+
+	// distance fields are larger than the outline by the spread on every side
+	void RasterizeGlyph(const stbtt_fontinfo& FontInfo, float Scale, int GlyphIndex, FGlyphBitmap& Out)
+	{
+		Out = FGlyphBitmap{};
+		if (IsSignedDistanceFieldFont())
+		{
+			int Width, Height, OffsetX, OffsetY;
+			unsigned char* Pixels = stbtt_GetGlyphSDF(&FontInfo, Scale, GlyphIndex, FontSdfSpread, FontSdfOnEdge, (float)FontSdfOnEdge / FontSdfSpread, &Width, &Height, &OffsetX, &OffsetY);
+			if (Pixels)
+			{
+				Out.Pixels = TArray<uint8>{ Pixels, Width * Height };
+				Out.Width = Width;
+				Out.Height = Height;
+				Out.OffsetX = OffsetX;
+				Out.OffsetY = OffsetY;
+				stbtt_FreeSDF(Pixels, nullptr);
+			}
+			return;
+		}
+
+		int X0, Y0, X1, Y1;
+		stbtt_GetGlyphBitmapBox(&FontInfo, GlyphIndex, Scale, Scale, &X0, &Y0, &X1, &Y1);
+		if (X1 > X0 && Y1 > Y0)
+		{
+			Out.Width = X1 - X0;
+			Out.Height = Y1 - Y0;
+			Out.OffsetX = X0;
+			Out.OffsetY = Y0;
+			Out.Pixels.SetNumZeroed(Out.Width * Out.Height);
+			stbtt_MakeGlyphBitmap(&FontInfo, Out.Pixels.GetData(), Out.Width, Out.Height, Out.Width, Scale, Scale, GlyphIndex);
+		}
+	}
+
+	void CopyToAtlas(ImFontAtlas& FontAtlas, int32 X, int32 Y, const FGlyphBitmap& Bitmap)
+	{
+		for (int32 Row = FMath::Max(-Y, 0); Row < FMath::Min(Bitmap.Height, FontAtlas.TexHeight - Y); ++Row)
+		{
+			const int32 Begin = FMath::Max(-X, 0);
+			const int32 End = FMath::Min(Bitmap.Width, FontAtlas.TexWidth - X);
+			if (End > Begin)
+			{
+				FMemory::Memcpy(FontAtlas.TexPixelsAlpha8 + (Y + Row) * FontAtlas.TexWidth + X + Begin, Bitmap.Pixels.GetData() + Row * Bitmap.Width + Begin, End - Begin);
+			}
+		}
+	}
+}
+
+// the built atlas keeps its layout, every glyph is rendered again as a distance field into its rect grown by the spread
+// the padding between glyphs leaves room for it, see GetDefaultFontAtlas
+namespace UnrealImGui::SignedDistanceField
+{
+	void ConvertGlyphs(ImFontAtlas& FontAtlas)
+	{
+		struct FSource
+		{
+			const ImFontConfig* Config;
+			stbtt_fontinfo FontInfo;
+			float Scale;
+		};
+		TArray<FSource> Sources;
+		for (const ImFontConfig& Config : FontAtlas.ConfigData)
+		{
+			FSource& Source = Sources.Add_GetRef({ &Config });
+			const uint8* FontData = static_cast<const uint8*>(Config.FontData);
+			if (stbtt_InitFont(&Source.FontInfo, FontData, stbtt_GetFontOffsetForIndex(FontData, Config.FontNo)) == 0)
+			{
+				Sources.Pop();
+				continue;
+			}
+			Source.Scale = stbtt_ScaleForPixelHeight(&Source.FontInfo, Config.SizePixels);
+		}
+
+		FGlyphBitmap Bitmap;
+		for (ImFont* Font : FontAtlas.Fonts)
+		{
+			for (ImFontGlyph& Glyph : Font->Glyphs)
+			{
+				if (Glyph.Visible == false)
+				{
+					continue;
+				}
+				// the first source of the font with the codepoint made the glyph, as in the atlas build
+				const FSource* GlyphSource = nullptr;
+				int GlyphIndex = 0;
+				for (const FSource& Source : Sources)
+				{
+					bool bInRanges = false;
+					for (const ImWchar* Range = Source.Config->GlyphRanges; Range && Range[0] && bInRanges == false; Range += 2)
+					{
+						bInRanges = Glyph.Codepoint >= Range[0] && Glyph.Codepoint <= Range[1];
+					}
+					if (Source.Config->DstFont == Font && bInRanges)
+					{
+						GlyphIndex = stbtt_FindGlyphIndex(&Source.FontInfo, Glyph.Codepoint);
+						if (GlyphIndex != 0)
+						{
+							GlyphSource = &Source;
+							break;
+						}
+					}
+				}
+				if (GlyphSource == nullptr)
+				{
+					continue;
+				}
+
+				const int32 X = FMath::RoundToInt(Glyph.U0 * FontAtlas.TexWidth);
+				const int32 Y = FMath::RoundToInt(Glyph.V0 * FontAtlas.TexHeight);
+				const int32 Width = FMath::RoundToInt(Glyph.U1 * FontAtlas.TexWidth) - X;
+				const int32 Height = FMath::RoundToInt(Glyph.V1 * FontAtlas.TexHeight) - Y;
+				RasterizeGlyph(GlyphSource->FontInfo, GlyphSource->Scale, GlyphIndex, Bitmap);
+				if (Bitmap.Width != Width + 2 * FontSdfSpread || Bitmap.Height != Height + 2 * FontSdfSpread)
+				{
+					UE_LOG(LogImGui, Warning, TEXT("glyph %d of the font atlas doesn't match its distance field and keeps its coverage"), (int32)Glyph.Codepoint);
+					continue;
+				}
+				CopyToAtlas(FontAtlas, X - FontSdfSpread, Y - FontSdfSpread, Bitmap);
+
+				Glyph.X0 -= FontSdfSpread;
+				Glyph.Y0 -= FontSdfSpread;
+				Glyph.X1 += FontSdfSpread;
+				Glyph.Y1 += FontSdfSpread;
+				Glyph.U0 = (X - FontSdfSpread) * FontAtlas.TexUvScale.x;
+				Glyph.V0 = (Y - FontSdfSpread) * FontAtlas.TexUvScale.y;
+				Glyph.U1 = (X + Width + FontSdfSpread) * FontAtlas.TexUvScale.x;
+				Glyph.V1 = (Y + Height + FontSdfSpread) * FontAtlas.TexUvScale.y;
+			}
+		}
+	}
+}
+
+namespace UnrealImGui::DynamicFontAtlas
+{
+	// the default range and the icons are built up front, glyphs of the lazy ranges are rasterized on first use
+	const ImWchar* LazyRanges = nullptr;
+	TArray<uint8> FontData;
+	stbtt_fontinfo FontInfo;
+	float Scale = 1.f;
+
+	// the built atlas is packed as one rect at the top, new glyphs go below it and the texture height doubles when full
+	constexpr int32 MaxTextureHeight = 8192;
+	stbrp_context Packer;
+	TArray<stbrp_node> Nodes;
+	bool bBakedGlyphs = false;
+
+	bool IsLazy(ImWchar Codepoint)
+	{
+		for (const ImWchar* Range = LazyRanges; Range && Range[0]; Range += 2)
+		{
+			if (Codepoint >= Range[0] && Codepoint <= Range[1])
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Init(ImFontAtlas& FontAtlas, const ImWchar* InLazyRanges, TArray<uint8>&& InFontData)
+	{
+		const ImFontConfig& FontConfig = FontAtlas.ConfigData[0];
+		FontData = MoveTemp(InFontData);
+		if (stbtt_InitFont(&FontInfo, FontData.GetData(), stbtt_GetFontOffsetForIndex(FontData.GetData(), FontConfig.FontNo)) == 0)
+		{
+			UE_LOG(LogImGui, Warning, TEXT("glyphs of the font atlas can't be baked on demand, the font failed to load"));
+			return;
+		}
+		LazyRanges = InLazyRanges;
+		Scale = stbtt_ScaleForPixelHeight(&FontInfo, FontConfig.SizePixels);
+
+		int32 UsedHeight = 0;
+		for (const ImFont* Font : FontAtlas.Fonts)
+		{
+			for (const ImFontGlyph& Glyph : Font->Glyphs)
+			{
+				UsedHeight = FMath::Max(UsedHeight, FMath::CeilToInt(Glyph.V1 * FontAtlas.TexHeight));
+			}
+		}
+		for (const ImFontAtlasCustomRect& Rect : FontAtlas.CustomRects)
+		{
+			UsedHeight = FMath::Max(UsedHeight, Rect.Y + Rect.Height);
+		}
+		Nodes.SetNum(FontAtlas.TexWidth);
+		stbrp_init_target(&Packer, FontAtlas.TexWidth, MaxTextureHeight, Nodes.GetData(), Nodes.Num());
+		stbrp_rect UsedRect{};
+		UsedRect.w = FontAtlas.TexWidth;
+		UsedRect.h = UsedHeight + FontAtlas.TexGlyphPadding;
+		stbrp_pack_rects(&Packer, &UsedRect, 1);
+
+		FontAtlas.RecordMissingGlyphs = true;
+	}
+
+	// pixel positions are kept, only the V coordinates of the atlas are rescaled
+	void Grow(ImFontAtlas& FontAtlas, int32 NewHeight)
+	{
+		const float VScale = (float)FontAtlas.TexHeight / NewHeight;
+		const int32 OldBytes = FontAtlas.TexWidth * FontAtlas.TexHeight;
+		unsigned char* Pixels = (unsigned char*)IM_ALLOC(FontAtlas.TexWidth * NewHeight);
+		FMemory::Memcpy(Pixels, FontAtlas.TexPixelsAlpha8, OldBytes);
+		FMemory::Memzero(Pixels + OldBytes, FontAtlas.TexWidth * NewHeight - OldBytes);
+		IM_FREE(FontAtlas.TexPixelsAlpha8);
+		FontAtlas.TexPixelsAlpha8 = Pixels;
+		// converted again when requested
+		if (FontAtlas.TexPixelsRGBA32)
+		{
+			IM_FREE(FontAtlas.TexPixelsRGBA32);
+			FontAtlas.TexPixelsRGBA32 = nullptr;
+		}
+
+		FontAtlas.TexHeight = NewHeight;
+		FontAtlas.TexUvScale.y = 1.f / NewHeight;
+		FontAtlas.TexUvWhitePixel.y *= VScale;
+		for (ImVec4& Line : FontAtlas.TexUvLines)
+		{
+			Line.y *= VScale;
+			Line.w *= VScale;
+		}
+		for (ImFont* Font : FontAtlas.Fonts)
+		{
+			for (ImFontGlyph& Glyph : Font->Glyphs)
+			{
+				Glyph.V0 *= VScale;
+				Glyph.V1 *= VScale;
+			}
+		}
+	}
+
+	void BakeMissingGlyphs()
+	{
+		ImFontAtlas& FontAtlas = GetDefaultFontAtlas();
+		if (FontAtlas.MissingGlyphs.Size == 0 || FontAtlas.Locked)
+		{
+			return;
+		}
+
+		ImFont* Font = FontAtlas.Fonts[0];
+		const ImFontConfig& FontConfig = FontAtlas.ConfigData[0];
+		const ImFontGlyph FallbackGlyph = *Font->FallbackGlyph;
+		const float OffsetX = FontConfig.GlyphOffset.x;
+		const float OffsetY = FontConfig.GlyphOffset.y + FMath::TruncToFloat(Font->Ascent + 0.5f);
+		const int32 Padding = FontAtlas.TexGlyphPadding;
+		// BuildLookupTable only reuses the tab glyph while it is the last one, it is added again behind the new glyphs
+		if (Font->Glyphs.Size > 0 && Font->Glyphs.back().Codepoint == '\t')
+		{
+			Font->Glyphs.pop_back();
+		}
+		FGlyphBitmap Bitmap;
+		for (const ImWchar Codepoint : FontAtlas.MissingGlyphs)
+		{
+			if (Font->FindGlyphNoFallback(Codepoint))
+			{
+				continue;
+			}
+			const int GlyphIndex = IsLazy(Codepoint) ? stbtt_FindGlyphIndex(&FontInfo, Codepoint) : 0;
+			stbrp_rect Rect{};
+			if (GlyphIndex != 0)
+			{
+				RasterizeGlyph(FontInfo, Scale, GlyphIndex, Bitmap);
+				Rect.w = Bitmap.Width + Padding;
+				Rect.h = Bitmap.Height + Padding;
+				if (Bitmap.Width > 0)
+				{
+					stbrp_pack_rects(&Packer, &Rect, 1);
+				}
+				if (Rect.was_packed)
+				{
+					while (Rect.y + Rect.h > FontAtlas.TexHeight)
+					{
+						Grow(FontAtlas, FontAtlas.TexHeight * 2);
+					}
+					CopyToAtlas(FontAtlas, Rect.x, Rect.y, Bitmap);
+				}
+				else if (Bitmap.Width > 0)
+				{
+					UE_LOG(LogImGui, Warning, TEXT("font atlas is full, glyph %d is drawn as the fallback glyph"), Codepoint);
+					Font->AddGlyph(nullptr, Codepoint, FallbackGlyph.X0, FallbackGlyph.Y0, FallbackGlyph.X1, FallbackGlyph.Y1, FallbackGlyph.U0, FallbackGlyph.V0, FallbackGlyph.U1, FallbackGlyph.V1, FallbackGlyph.AdvanceX);
+					continue;
+				}
+
+				int AdvanceX, LeftSideBearing;
+				stbtt_GetGlyphHMetrics(&FontInfo, GlyphIndex, &AdvanceX, &LeftSideBearing);
+				const ImVec2& UVScale = FontAtlas.TexUvScale;
+				const float X0 = Bitmap.OffsetX + OffsetX;
+				const float Y0 = Bitmap.OffsetY + OffsetY;
+				Font->AddGlyph(&FontConfig, Codepoint, X0, Y0, X0 + Bitmap.Width, Y0 + Bitmap.Height,
+					Rect.x * UVScale.x, Rect.y * UVScale.y, (Rect.x + Bitmap.Width) * UVScale.x, (Rect.y + Bitmap.Height) * UVScale.y, AdvanceX * Scale);
+			}
+			else
+			{
+				// codepoints outside the ranges or missing in the font draw the fallback glyph without being looked up again
+				Font->AddGlyph(nullptr, Codepoint, FallbackGlyph.X0, FallbackGlyph.Y0, FallbackGlyph.X1, FallbackGlyph.Y1, FallbackGlyph.U0, FallbackGlyph.V0, FallbackGlyph.U1, FallbackGlyph.V1, FallbackGlyph.AdvanceX);
+			}
+		}
+		FontAtlas.MissingGlyphs.clear();
+		Font->BuildLookupTable();
+		bBakedGlyphs = true;
+
+		FImGuiDelegates::OnImGuiFontAtlasChanged.Broadcast();
+	}
+}
+
+// the built atlas is saved to Saved/ImGui_WS and mapped on the next start instead of rasterizing the fonts again
+namespace UnrealImGui::FontAtlasCache
+{
+	constexpr uint32 Magic = 0x41464749;
+	// 2 drops the atlases saved with a duplicated tab glyph per bake
+	constexpr uint32 Version = 2;
+
+	FString GetFilePath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT(UE_PLUGIN_NAME) / TEXT("FontAtlas.bin");
+	}
+
+	int32 GetRangesSize(const ImWchar* Ranges)
+	{
+		int32 Num = 0;
+		while (Ranges && Ranges[Num])
+		{
+			Num += 2;
+		}
+		return Num * sizeof(ImWchar);
+	}
+
+	// everything the build depends on, any change builds the atlas again
+	uint64 MakeKey(const TArray<uint8>& FontData, const ImFontAtlas& FontAtlas, const ImWchar* LazyRanges)
+	{
+		uint64 Key = CityHash64(reinterpret_cast<const char*>(FontData.GetData()), FontData.Num());
+		auto Combine = [&Key](const void* Data, int32 Size)
+		{
+			Key = CityHash64WithSeed(static_cast<const char*>(Data), Size, Key);
+		};
+		const int32 Layout[] = { (int32)Version, IMGUI_VERSION_NUM, (int32)sizeof(ImFontGlyph), FontAtlas.Flags, FontAtlas.TexDesiredWidth, FontAtlas.TexGlyphPadding,
+			IsSignedDistanceFieldFont() ? FontSdfSpread : 0 };
+		Combine(Layout, sizeof(Layout));
+		for (const ImFontConfig& Config : FontAtlas.ConfigData)
+		{
+			const float Params[] = { (float)Config.FontDataSize, (float)Config.FontNo, Config.SizePixels, (float)Config.OversampleH, (float)Config.OversampleV, (float)Config.PixelSnapH, (float)Config.MergeMode,
+				Config.GlyphOffset.x, Config.GlyphOffset.y, Config.GlyphExtraSpacing.x, Config.GlyphMinAdvanceX, Config.GlyphMaxAdvanceX, Config.RasterizerMultiply };
+			Combine(Params, sizeof(Params));
+			Combine(Config.GlyphRanges, GetRangesSize(Config.GlyphRanges));
+		}
+		Combine(LazyRanges, GetRangesSize(LazyRanges));
+		return Key;
+	}
+
+	bool Load(ImFontAtlas& FontAtlas, uint64 Key)
+	{
+		const TUniquePtr<IMappedFileHandle> MappedFile{ FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*GetFilePath()) };
+		if (MappedFile.IsValid() == false || MappedFile->GetFileSize() <= 0)
+		{
+			return false;
+		}
+		const TUniquePtr<IMappedFileRegion> MappedRegion{ MappedFile->MapRegion(0, MappedFile->GetFileSize()) };
+		if (MappedRegion.IsValid() == false)
+		{
+			return false;
+		}
+		FMemoryReaderView Reader{ MakeArrayView(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()) };
+
+		uint32 FileMagic = 0, FileVersion = 0;
+		uint64 FileKey = 0;
+		int32 TexWidth = 0, TexHeight = 0, NumCustomRects = 0;
+		Reader << FileMagic << FileVersion << FileKey << TexWidth << TexHeight << NumCustomRects;
+		if (Reader.IsError() || FileMagic != Magic || FileVersion != Version || FileKey != Key)
+		{
+			return false;
+		}
+
+		// a failed load leaves state that Build sets up again
+		ImFontAtlasBuildInit(&FontAtlas);
+		if (NumCustomRects != FontAtlas.CustomRects.Size)
+		{
+			return false;
+		}
+		for (ImFontAtlasCustomRect& Rect : FontAtlas.CustomRects)
+		{
+			Reader << Rect.X << Rect.Y;
+		}
+		for (ImFont* Font : FontAtlas.Fonts)
+		{
+			float Ascent = 0.f, Descent = 0.f;
+			int32 NumGlyphs = 0;
+			Reader << Ascent << Descent << NumGlyphs;
+			const int64 GlyphBytes = (int64)NumGlyphs * sizeof(ImFontGlyph);
+			if (Reader.IsError() || NumGlyphs < 0 || GlyphBytes > Reader.TotalSize() - Reader.Tell())
+			{
+				return false;
+			}
+			ImFontAtlasBuildSetupFont(&FontAtlas, Font, Font->ConfigData, Ascent, Descent);
+			Font->Glyphs.resize(NumGlyphs);
+			Reader.Serialize(Font->Glyphs.Data, GlyphBytes);
+			Font->DirtyLookupTables = true;
+		}
+		const int64 NumPixels = (int64)TexWidth * TexHeight;
+		if (Reader.IsError() || NumPixels <= 0 || NumPixels != Reader.TotalSize() - Reader.Tell())
+		{
+			return false;
+		}
+
+		FontAtlas.TexWidth = TexWidth;
+		FontAtlas.TexHeight = TexHeight;
+		FontAtlas.TexUvScale = ImVec2(1.f / TexWidth, 1.f / TexHeight);
+		FontAtlas.TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(NumPixels);
+		Reader.Serialize(FontAtlas.TexPixelsAlpha8, NumPixels);
+		// the white pixel, mouse cursors and lines are rendered again into the same rects
+		ImFontAtlasBuildFinish(&FontAtlas);
+		return true;
+	}
+
+	void Save(ImFontAtlas& FontAtlas, uint64 Key)
+	{
+		TArray<uint8> Data;
+		FMemoryWriter Writer{ Data };
+		uint32 FileMagic = Magic, FileVersion = Version;
+		int32 NumCustomRects = FontAtlas.CustomRects.Size;
+		Writer << FileMagic << FileVersion << Key << FontAtlas.TexWidth << FontAtlas.TexHeight << NumCustomRects;
+		for (ImFontAtlasCustomRect& Rect : FontAtlas.CustomRects)
+		{
+			Writer << Rect.X << Rect.Y;
+		}
+		for (ImFont* Font : FontAtlas.Fonts)
+		{
+			int32 NumGlyphs = Font->Glyphs.Size;
+			Writer << Font->Ascent << Font->Descent << NumGlyphs;
+			Writer.Serialize(Font->Glyphs.Data, (int64)NumGlyphs * sizeof(ImFontGlyph));
+		}
+		Writer.Serialize(FontAtlas.TexPixelsAlpha8, (int64)FontAtlas.TexWidth * FontAtlas.TexHeight);
+
+		if (FFileHelper::SaveArrayToFile(Data, *GetFilePath()) == false)
+		{
+			UE_LOG(LogImGui, Warning, TEXT("failed to save the font atlas cache to %s"), *GetFilePath());
+		}
+	}
+}
 
 ImFontAtlas& UnrealImGui::GetDefaultFontAtlas()
 {
@@ -61,13 +537,58 @@ ImFontAtlas& UnrealImGui::GetDefaultFontAtlas()
 		ensure(FFileHelper::LoadFileToArray(Bin, *ChineseFontPath));
 		constexpr char FontName[] = "YaHeiUI, 12px";
 		FCStringAnsi::Strcpy(FontConfig.Name, sizeof(FontName), FontName);
+		const ImWchar* LazyRanges = nullptr;
+		if (Settings->bBakeGlyphsOnDemand && FontConfig.GlyphRanges != FontAtlas.GetGlyphRangesDefault())
+		{
+			LazyRanges = FontConfig.GlyphRanges;
+			FontConfig.GlyphRanges = FontAtlas.GetGlyphRangesDefault();
+			// glyphs baked on demand are rasterized without oversampling, the up front ones match them
+			FontConfig.OversampleH = 1;
+			// rows wide enough that a few thousand glyphs fit before the height limit
+			FontAtlas.TexDesiredWidth = 1024;
+		}
 		FontAtlas.AddFontFromMemoryTTF(Bin.GetData(), Bin.Num(), 12.0f * DPIScale, &FontConfig);
 
 		// Initialize notify
 		ImGui::MergeIconsWithLatestFont(FontAtlas, 12.f * DPIScale, false);
 
+		if (IsSignedDistanceFieldFont())
+		{
+			// a distance field grows the glyph by the spread on every side, the padding between two glyphs holds both
+			FontAtlas.TexGlyphPadding = 2 * FontSdfSpread + 1;
+			// lines are drawn as geometry, the baked line texture holds coverage
+			FontAtlas.Flags |= ImFontAtlasFlags_NoBakedLines;
+			for (ImFontConfig& Config : FontAtlas.ConfigData)
+			{
+				Config.OversampleH = Config.OversampleV = 1;
+			}
+		}
+
 		// build font
-		FontAtlas.Build();
+		const uint64 CacheKey = FontAtlasCache::MakeKey(Bin, FontAtlas, LazyRanges);
+		if (FontAtlasCache::Load(FontAtlas, CacheKey) == false)
+		{
+			FontAtlas.Build();
+			if (IsSignedDistanceFieldFont())
+			{
+				SignedDistanceField::ConvertGlyphs(FontAtlas);
+			}
+			FontAtlasCache::Save(FontAtlas, CacheKey);
+		}
+
+		if (LazyRanges)
+		{
+			DynamicFontAtlas::Init(FontAtlas, LazyRanges, MoveTemp(Bin));
+			FCoreDelegates::OnEndFrame.AddStatic(&DynamicFontAtlas::BakeMissingGlyphs);
+			// glyphs baked in this session are loaded up front next time
+			FCoreDelegates::OnPreExit.AddLambda([CacheKey]
+			{
+				if (DynamicFontAtlas::bBakedGlyphs)
+				{
+					FontAtlasCache::Save(GetDefaultFontAtlas(), CacheKey);
+				}
+			});
+		}
 
 		return FontAtlas;
 	}();
@@ -0,0 +1,392 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnrealImGuiPixelConversion.h"
+
+#if PLATFORM_CPU_X86_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS
+#define UNREAL_IMGUI_PIXEL_SSE 1
+#include <emmintrin.h>
+// pshufb, only used where the target CPU is guaranteed to have it
+#if PLATFORM_ALWAYS_HAS_SSE4_1
+#define UNREAL_IMGUI_PIXEL_SSSE3 1
+#include <tmmintrin.h>
+#endif
+#elif PLATFORM_CPU_ARM_FAMILY && PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#define UNREAL_IMGUI_PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+#ifndef UNREAL_IMGUI_PIXEL_SSE
+#define UNREAL_IMGUI_PIXEL_SSE 0
+#endif
+#ifndef UNREAL_IMGUI_PIXEL_SSSE3
+#define UNREAL_IMGUI_PIXEL_SSSE3 0
+#endif
+#ifndef UNREAL_IMGUI_PIXEL_NEON
+#define UNREAL_IMGUI_PIXEL_NEON 0
+#endif
+
+namespace UnrealImGui::PixelConversion
+{
+	namespace
+	{
+		FORCEINLINE uint8 FloatToUnorm8(float Value)
+		{
+			const float Scaled = Value * 255.f;
+			// NaN fails both compares and ends up 0
+			return Scaled > 0.f ? (Scaled < 255.f ? static_cast<uint8>(Scaled) : 255) : 0;
+		}
+
+		FORCEINLINE uint8 Unorm16ToUnorm8(uint16 Value)
+		{
+			// floor(Value / 257), the exact Value * 255 / 65535 of the scalar code
+			return static_cast<uint8>((Value * 0xFF01u) >> 24);
+		}
+
+		void FloatsToUnorm8(uint8* Dst, const float* Src, int64 Num)
+		{
+			int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSE
+			const __m128 Scale = _mm_set1_ps(255.f);
+			const __m128 Zero = _mm_setzero_ps();
+			for (; Idx + 16 <= Num; Idx += 16)
+			{
+				__m128i Values[4];
+				for (int32 Lane = 0; Lane < 4; ++Lane)
+				{
+					const __m128 Scaled = _mm_mul_ps(_mm_loadu_ps(Src + Idx + Lane * 4), Scale);
+					// max returns the second operand for NaN
+					Values[Lane] = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(Scaled, Zero), Scale));
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Idx), _mm_packus_epi16(_mm_packs_epi32(Values[0], Values[1]), _mm_packs_epi32(Values[2], Values[3])));
+			}
+#elif UNREAL_IMGUI_PIXEL_NEON
+			const float32x4_t Scale = vdupq_n_f32(255.f);
+			const uint32x4_t Max = vdupq_n_u32(255);
+			for (; Idx + 8 <= Num; Idx += 8)
+			{
+				// the conversion saturates, negative values and NaN become 0
+				const uint32x4_t Lo = vminq_u32(vcvtq_u32_f32(vmulq_f32(vld1q_f32(Src + Idx), Scale)), Max);
+				const uint32x4_t Hi = vminq_u32(vcvtq_u32_f32(vmulq_f32(vld1q_f32(Src + Idx + 4), Scale)), Max);
+				vst1_u8(Dst + Idx, vmovn_u16(vcombine_u16(vmovn_u32(Lo), vmovn_u32(Hi))));
+			}
+#endif
+			for (; Idx < Num; ++Idx)
+			{
+				Dst[Idx] = FloatToUnorm8(Src[Idx]);
+			}
+		}
+
+		void HalvesToUnorm8(uint8* Dst, const FFloat16* Src, int64 Num)
+		{
+			// widened in blocks, the float kernel does the rest
+			float Block[256];
+			for (int64 Idx = 0; Idx < Num; Idx += UE_ARRAY_COUNT(Block))
+			{
+				const int32 BlockNum = FMath::Min<int64>(UE_ARRAY_COUNT(Block), Num - Idx);
+				for (int32 BlockIdx = 0; BlockIdx < BlockNum; ++BlockIdx)
+				{
+					Block[BlockIdx] = Src[Idx + BlockIdx].GetFloat();
+				}
+				FloatsToUnorm8(Dst + Idx, Block, BlockNum);
+			}
+		}
+
+		void Unorm16sToUnorm8(uint8* Dst, const uint16* Src, int64 Num)
+		{
+			int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSE
+			const __m128i Mul = _mm_set1_epi16(static_cast<int16>(0xFF01));
+			for (; Idx + 16 <= Num; Idx += 16)
+			{
+				const __m128i Lo = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Idx)), Mul), 8);
+				const __m128i Hi = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Idx + 8)), Mul), 8);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Idx), _mm_packus_epi16(Lo, Hi));
+			}
+#elif UNREAL_IMGUI_PIXEL_NEON
+			const uint16x4_t Mul = vdup_n_u16(0xFF01);
+			for (; Idx + 8 <= Num; Idx += 8)
+			{
+				const uint16x8_t Values = vld1q_u16(Src + Idx);
+				const uint16x8_t High = vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(Values), Mul), 16), vshrn_n_u32(vmull_u16(vget_high_u16(Values), Mul), 16));
+				vst1_u8(Dst + Idx, vshrn_n_u16(High, 8));
+			}
+#endif
+			for (; Idx < Num; ++Idx)
+			{
+				Dst[Idx] = Unorm16ToUnorm8(Src[Idx]);
+			}
+		}
+
+		// Src has 4 channels per pixel, used for the layouts without a vector kernel
+		template<typename T, typename FConvert>
+		void ConvertChannels(uint8* Dst, const T* Src, int64 NumPixels, int32 DstChannels, FConvert Convert)
+		{
+			if (DstChannels == 1)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					Dst[Idx] = Convert(Src[Idx * 4 + 3]);
+				}
+				return;
+			}
+			check(DstChannels == 3 || DstChannels == 4);
+			for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+			{
+				for (int32 Channel = 0; Channel < DstChannels; ++Channel)
+				{
+					Dst[Idx * DstChannels + Channel] = Convert(Src[Idx * 4 + Channel]);
+				}
+			}
+		}
+	}
+
+	void Alpha8ToRGBA8(uint8* Dst, const uint8* Src, int64 NumPixels)
+	{
+		int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSE
+		const __m128i Zero = _mm_setzero_si128();
+		const __m128i White = _mm_set1_epi32(0x00FFFFFF);
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			const __m128i Alpha = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Idx));
+			// alpha moves to the top byte of every 32 bit lane
+			const __m128i Lo = _mm_unpacklo_epi8(Zero, Alpha);
+			const __m128i Hi = _mm_unpackhi_epi8(Zero, Alpha);
+			__m128i* Out = reinterpret_cast<__m128i*>(Dst + Idx * 4);
+			_mm_storeu_si128(Out + 0, _mm_or_si128(_mm_unpacklo_epi16(Zero, Lo), White));
+			_mm_storeu_si128(Out + 1, _mm_or_si128(_mm_unpackhi_epi16(Zero, Lo), White));
+			_mm_storeu_si128(Out + 2, _mm_or_si128(_mm_unpacklo_epi16(Zero, Hi), White));
+			_mm_storeu_si128(Out + 3, _mm_or_si128(_mm_unpackhi_epi16(Zero, Hi), White));
+		}
+#elif UNREAL_IMGUI_PIXEL_NEON
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			uint8x16x4_t Pixels;
+			Pixels.val[0] = Pixels.val[1] = Pixels.val[2] = vdupq_n_u8(255);
+			Pixels.val[3] = vld1q_u8(Src + Idx);
+			vst4q_u8(Dst + Idx * 4, Pixels);
+		}
+#endif
+		for (; Idx < NumPixels; ++Idx)
+		{
+			uint8* Pixel = Dst + Idx * 4;
+			Pixel[0] = Pixel[1] = Pixel[2] = 255;
+			Pixel[3] = Src[Idx];
+		}
+	}
+
+	void Gray8ToRGBA8(uint8* Dst, const uint8* Src, int64 NumPixels)
+	{
+		int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSE
+		const __m128i Alpha = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			const __m128i Gray = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Idx));
+			// every byte repeated to fill its 32 bit lane
+			const __m128i Lo = _mm_unpacklo_epi8(Gray, Gray);
+			const __m128i Hi = _mm_unpackhi_epi8(Gray, Gray);
+			__m128i* Out = reinterpret_cast<__m128i*>(Dst + Idx * 4);
+			_mm_storeu_si128(Out + 0, _mm_or_si128(_mm_unpacklo_epi16(Lo, Lo), Alpha));
+			_mm_storeu_si128(Out + 1, _mm_or_si128(_mm_unpackhi_epi16(Lo, Lo), Alpha));
+			_mm_storeu_si128(Out + 2, _mm_or_si128(_mm_unpacklo_epi16(Hi, Hi), Alpha));
+			_mm_storeu_si128(Out + 3, _mm_or_si128(_mm_unpackhi_epi16(Hi, Hi), Alpha));
+		}
+#elif UNREAL_IMGUI_PIXEL_NEON
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			uint8x16x4_t Pixels;
+			Pixels.val[0] = Pixels.val[1] = Pixels.val[2] = vld1q_u8(Src + Idx);
+			Pixels.val[3] = vdupq_n_u8(255);
+			vst4q_u8(Dst + Idx * 4, Pixels);
+		}
+#endif
+		for (; Idx < NumPixels; ++Idx)
+		{
+			uint8* Pixel = Dst + Idx * 4;
+			Pixel[0] = Pixel[1] = Pixel[2] = Src[Idx];
+			Pixel[3] = 255;
+		}
+	}
+
+	void RGB8ToRGBA8(uint8* Dst, const uint8* Src, int64 NumPixels)
+	{
+		int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSSE3
+		const __m128i Shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+		const __m128i Alpha = _mm_set1_epi32(static_cast<int32>(0xFF000000));
+		// 16 bytes are read for 4 pixels, the scalar loop takes the last ones
+		for (; Idx * 3 + 16 <= NumPixels * 3; Idx += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Src + Idx * 3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Idx * 4), _mm_or_si128(_mm_shuffle_epi8(Pixels, Shuffle), Alpha));
+		}
+#elif UNREAL_IMGUI_PIXEL_NEON
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			const uint8x16x3_t RGB = vld3q_u8(Src + Idx * 3);
+			uint8x16x4_t Pixels;
+			Pixels.val[0] = RGB.val[0];
+			Pixels.val[1] = RGB.val[1];
+			Pixels.val[2] = RGB.val[2];
+			Pixels.val[3] = vdupq_n_u8(255);
+			vst4q_u8(Dst + Idx * 4, Pixels);
+		}
+#endif
+		for (; Idx < NumPixels; ++Idx)
+		{
+			uint8* Pixel = Dst + Idx * 4;
+			Pixel[0] = Src[Idx * 3];
+			Pixel[1] = Src[Idx * 3 + 1];
+			Pixel[2] = Src[Idx * 3 + 2];
+			Pixel[3] = 255;
+		}
+	}
+
+	void BGRA8ToRGBA8(uint8* Dst, const FColor* Src, int64 NumPixels)
+	{
+		const uint8* SrcBytes = reinterpret_cast<const uint8*>(Src);
+		int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSE
+		const __m128i MaskGA = _mm_set1_epi32(static_cast<int32>(0xFF00FF00));
+		const __m128i MaskByte = _mm_set1_epi32(0xFF);
+		for (; Idx + 4 <= NumPixels; Idx += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SrcBytes + Idx * 4));
+			// B and R swap places, G and A stay
+			const __m128i R = _mm_and_si128(_mm_srli_epi32(Pixels, 16), MaskByte);
+			const __m128i B = _mm_slli_epi32(_mm_and_si128(Pixels, MaskByte), 16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Idx * 4), _mm_or_si128(_mm_and_si128(Pixels, MaskGA), _mm_or_si128(R, B)));
+		}
+#elif UNREAL_IMGUI_PIXEL_NEON
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			uint8x16x4_t Pixels = vld4q_u8(SrcBytes + Idx * 4);
+			const uint8x16_t B = Pixels.val[0];
+			Pixels.val[0] = Pixels.val[2];
+			Pixels.val[2] = B;
+			vst4q_u8(Dst + Idx * 4, Pixels);
+		}
+#endif
+		for (; Idx < NumPixels; ++Idx)
+		{
+			uint8* Pixel = Dst + Idx * 4;
+			Pixel[0] = Src[Idx].R;
+			Pixel[1] = Src[Idx].G;
+			Pixel[2] = Src[Idx].B;
+			Pixel[3] = Src[Idx].A;
+		}
+	}
+
+	void BGRA8ToRGB8(uint8* Dst, const FColor* Src, int64 NumPixels)
+	{
+		int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSSE3 || UNREAL_IMGUI_PIXEL_NEON
+		const uint8* SrcBytes = reinterpret_cast<const uint8*>(Src);
+#endif
+#if UNREAL_IMGUI_PIXEL_SSSE3
+		const __m128i Shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+		// 16 bytes are written for 4 pixels, the next store overwrites the extra ones
+		for (; Idx * 3 + 16 <= NumPixels * 3; Idx += 4)
+		{
+			const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(SrcBytes + Idx * 4));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Idx * 3), _mm_shuffle_epi8(Pixels, Shuffle));
+		}
+#elif UNREAL_IMGUI_PIXEL_NEON
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			const uint8x16x4_t Pixels = vld4q_u8(SrcBytes + Idx * 4);
+			uint8x16x3_t RGB;
+			RGB.val[0] = Pixels.val[2];
+			RGB.val[1] = Pixels.val[1];
+			RGB.val[2] = Pixels.val[0];
+			vst3q_u8(Dst + Idx * 3, RGB);
+		}
+#endif
+		for (; Idx < NumPixels; ++Idx)
+		{
+			uint8* Pixel = Dst + Idx * 3;
+			Pixel[0] = Src[Idx].R;
+			Pixel[1] = Src[Idx].G;
+			Pixel[2] = Src[Idx].B;
+		}
+	}
+
+	void BGRA8ToChannel8(uint8* Dst, const FColor* Src, int64 NumPixels, int32 Channel)
+	{
+		check(Channel >= 0 && Channel < 4);
+		const uint8* SrcBytes = reinterpret_cast<const uint8*>(Src);
+		int64 Idx = 0;
+#if UNREAL_IMGUI_PIXEL_SSE
+		const __m128i Shift = _mm_cvtsi32_si128(Channel * 8);
+		const __m128i MaskByte = _mm_set1_epi32(0xFF);
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			__m128i Values[4];
+			for (int32 Lane = 0; Lane < 4; ++Lane)
+			{
+				Values[Lane] = _mm_and_si128(_mm_srl_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(SrcBytes + (Idx + Lane * 4) * 4)), Shift), MaskByte);
+			}
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(Dst + Idx), _mm_packus_epi16(_mm_packs_epi32(Values[0], Values[1]), _mm_packs_epi32(Values[2], Values[3])));
+		}
+#elif UNREAL_IMGUI_PIXEL_NEON
+		for (; Idx + 16 <= NumPixels; Idx += 16)
+		{
+			const uint8x16x4_t Pixels = vld4q_u8(SrcBytes + Idx * 4);
+			vst1q_u8(Dst + Idx, Pixels.val[Channel]);
+		}
+#endif
+		for (; Idx < NumPixels; ++Idx)
+		{
+			Dst[Idx] = SrcBytes[Idx * 4 + Channel];
+		}
+	}
+
+	void RGBA16ToUnorm8(uint8* Dst, const uint16* Src, int64 NumPixels, int32 DstChannels)
+	{
+		if (DstChannels == 4)
+		{
+			Unorm16sToUnorm8(Dst, Src, NumPixels * 4);
+			return;
+		}
+		ConvertChannels(Dst, Src, NumPixels, DstChannels, [](uint16 Value) { return Unorm16ToUnorm8(Value); });
+	}
+
+	void RGBA16FToUnorm8(uint8* Dst, const FFloat16Color* Src, int64 NumPixels, int32 DstChannels)
+	{
+		const FFloat16* Halves = reinterpret_cast<const FFloat16*>(Src);
+		if (DstChannels == 4)
+		{
+			HalvesToUnorm8(Dst, Halves, NumPixels * 4);
+			return;
+		}
+		ConvertChannels(Dst, Halves, NumPixels, DstChannels, [](FFloat16 Value) { return FloatToUnorm8(Value.GetFloat()); });
+	}
+
+	void RGBA32FToUnorm8(uint8* Dst, const FLinearColor* Src, int64 NumPixels, int32 DstChannels)
+	{
+		const float* Floats = reinterpret_cast<const float*>(Src);
+		if (DstChannels == 4)
+		{
+			FloatsToUnorm8(Dst, Floats, NumPixels * 4);
+			return;
+		}
+		ConvertChannels(Dst, Floats, NumPixels, DstChannels, [](float Value) { return FloatToUnorm8(Value); });
+	}
+
+	void R16ToUnorm8(uint8* Dst, const uint16* Src, int64 NumPixels)
+	{
+		Unorm16sToUnorm8(Dst, Src, NumPixels);
+	}
+
+	void R16FToUnorm8(uint8* Dst, const FFloat16* Src, int64 NumPixels)
+	{
+		HalvesToUnorm8(Dst, Src, NumPixels);
+	}
+
+	void R32FToUnorm8(uint8* Dst, const float* Src, int64 NumPixels)
+	{
+		FloatsToUnorm8(Dst, Src, NumPixels);
+	}
+}
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16Color.h"
+
+// pixel format conversion for texture uploads, vectorized with SSE or NEON where the platform has it
+// every kernel takes the number of pixels, Dst and Src never overlap
+// 8 bit results are truncated like the scalar conversions they replace, out of range values are clamped
+namespace UnrealImGui::PixelConversion
+{
+	void Alpha8ToRGBA8(uint8* Dst, const uint8* Src, int64 NumPixels);
+	void Gray8ToRGBA8(uint8* Dst, const uint8* Src, int64 NumPixels);
+	void RGB8ToRGBA8(uint8* Dst, const uint8* Src, int64 NumPixels);
+
+	void BGRA8ToRGBA8(uint8* Dst, const FColor* Src, int64 NumPixels);
+	void BGRA8ToRGB8(uint8* Dst, const FColor* Src, int64 NumPixels);
+	// one byte of every pixel in memory order, 0 B, 1 G, 2 R, 3 A
+	void BGRA8ToChannel8(uint8* Dst, const FColor* Src, int64 NumPixels, int32 Channel);
+
+	// DstChannels 4 keeps RGBA, 3 drops alpha and 1 keeps alpha only
+	void RGBA16ToUnorm8(uint8* Dst, const uint16* Src, int64 NumPixels, int32 DstChannels);
+	void RGBA16FToUnorm8(uint8* Dst, const FFloat16Color* Src, int64 NumPixels, int32 DstChannels);
+	void RGBA32FToUnorm8(uint8* Dst, const FLinearColor* Src, int64 NumPixels, int32 DstChannels);
+
+	void R16ToUnorm8(uint8* Dst, const uint16* Src, int64 NumPixels);
+	void R16FToUnorm8(uint8* Dst, const FFloat16* Src, int64 NumPixels);
+	void R32FToUnorm8(uint8* Dst, const float* Src, int64 NumPixels);
+}
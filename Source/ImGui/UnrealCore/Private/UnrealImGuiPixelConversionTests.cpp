@@ -0,0 +1,284 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnrealImGuiPixelConversion.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace UnrealImGui::PixelConversionTests
+{
+	// the plain per value conversions the kernels have to match
+	uint8 ReferenceFloatToUnorm8(float Value)
+	{
+		if (FMath::IsNaN(Value))
+		{
+			return 0;
+		}
+		return static_cast<uint8>(FMath::Clamp(Value * 255.f, 0.f, 255.f));
+	}
+
+	uint8 ReferenceUnorm16ToUnorm8(uint16 Value)
+	{
+		return static_cast<uint8>(Value * 255u / 65535u);
+	}
+
+	// Src has 4 channels per pixel, DstChannels 1 keeps alpha only
+	template<typename T, typename FConvert>
+	void ReferenceChannels(uint8* Dst, const T* Src, int64 NumPixels, int32 DstChannels, FConvert Convert)
+	{
+		for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+		{
+			for (int32 Channel = 0; Channel < DstChannels; ++Channel)
+			{
+				const int32 SrcChannel = DstChannels == 1 ? 3 : Channel;
+				Dst[Idx * DstChannels + Channel] = Convert(Src[Idx * 4 + SrcChannel]);
+			}
+		}
+	}
+
+	struct FSource
+	{
+		TArray<uint8> Bytes;
+		TArray<FColor> Colors;
+		TArray<uint16> Unorm16s;
+		TArray<FFloat16> Halves;
+		TArray<float> Floats;
+
+		// random channels with the edge values mixed in, enough for NumPixels of any layout
+		explicit FSource(int64 NumPixels)
+		{
+			static const float SpecialFloats[] = { NAN, -NAN, INFINITY, -INFINITY, 0.f, -0.f, 1.f, 1.0000001f, 0.9999999f, 254.5f / 255.f, -1.f, 2.f, 65504.f, 1e30f };
+			static const uint16 SpecialUnorm16s[] = { 0, 1, 256, 257, 65278, 65534, 65535 };
+
+			FRandomStream Random(0x1A5F);
+			const int64 NumValues = NumPixels * 4;
+			Bytes.SetNumUninitialized(NumValues);
+			Colors.SetNumUninitialized(NumPixels);
+			Unorm16s.SetNumUninitialized(NumValues);
+			Halves.SetNumUninitialized(NumValues);
+			Floats.SetNumUninitialized(NumValues);
+			for (int64 Idx = 0; Idx < NumValues; ++Idx)
+			{
+				Bytes[Idx] = static_cast<uint8>(Random.RandRange(0, 255));
+				Unorm16s[Idx] = Idx % 5 == 0 ? SpecialUnorm16s[Random.RandRange(0, static_cast<int32>(UE_ARRAY_COUNT(SpecialUnorm16s)) - 1)] : static_cast<uint16>(Random.RandRange(0, 65535));
+				Floats[Idx] = Idx % 7 == 0 ? SpecialFloats[Random.RandRange(0, static_cast<int32>(UE_ARRAY_COUNT(SpecialFloats)) - 1)] : Random.FRandRange(-0.5f, 1.5f);
+				Halves[Idx] = FFloat16(Floats[Idx]);
+			}
+			for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+			{
+				Colors[Idx] = FColor(Bytes[Idx * 4 + 2], Bytes[Idx * 4 + 1], Bytes[Idx * 4], Bytes[Idx * 4 + 3]);
+			}
+		}
+	};
+
+	// converts NumPixels starting at pixel First of the source
+	using FConvertFunc = TFunction<void(uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)>;
+
+	struct FKernel
+	{
+		FString Name;
+		int32 DstChannels;
+		FConvertFunc Convert;
+		FConvertFunc Reference;
+	};
+
+	TArray<FKernel> MakeKernels()
+	{
+		TArray<FKernel> Kernels;
+		Kernels.Add({ TEXT("Alpha8ToRGBA8"), 4,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::Alpha8ToRGBA8(Dst, Source.Bytes.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					Dst[Idx * 4] = Dst[Idx * 4 + 1] = Dst[Idx * 4 + 2] = 255;
+					Dst[Idx * 4 + 3] = Source.Bytes[First + Idx];
+				}
+			} });
+		Kernels.Add({ TEXT("Gray8ToRGBA8"), 4,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::Gray8ToRGBA8(Dst, Source.Bytes.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					Dst[Idx * 4] = Dst[Idx * 4 + 1] = Dst[Idx * 4 + 2] = Source.Bytes[First + Idx];
+					Dst[Idx * 4 + 3] = 255;
+				}
+			} });
+		Kernels.Add({ TEXT("RGB8ToRGBA8"), 4,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::RGB8ToRGBA8(Dst, Source.Bytes.GetData() + First * 3, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					for (int32 Channel = 0; Channel < 3; ++Channel)
+					{
+						Dst[Idx * 4 + Channel] = Source.Bytes[(First + Idx) * 3 + Channel];
+					}
+					Dst[Idx * 4 + 3] = 255;
+				}
+			} });
+		Kernels.Add({ TEXT("BGRA8ToRGBA8"), 4,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::BGRA8ToRGBA8(Dst, Source.Colors.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					const FColor& Color = Source.Colors[First + Idx];
+					Dst[Idx * 4] = Color.R;
+					Dst[Idx * 4 + 1] = Color.G;
+					Dst[Idx * 4 + 2] = Color.B;
+					Dst[Idx * 4 + 3] = Color.A;
+				}
+			} });
+		Kernels.Add({ TEXT("BGRA8ToRGB8"), 3,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::BGRA8ToRGB8(Dst, Source.Colors.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					const FColor& Color = Source.Colors[First + Idx];
+					Dst[Idx * 3] = Color.R;
+					Dst[Idx * 3 + 1] = Color.G;
+					Dst[Idx * 3 + 2] = Color.B;
+				}
+			} });
+		for (int32 Channel = 0; Channel < 4; ++Channel)
+		{
+			Kernels.Add({ FString::Printf(TEXT("BGRA8ToChannel8 %d"), Channel), 1,
+				[Channel](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::BGRA8ToChannel8(Dst, Source.Colors.GetData() + First, NumPixels, Channel); },
+				[Channel](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+				{
+					for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+					{
+						const FColor& Color = Source.Colors[First + Idx];
+						const uint8 Values[] = { Color.B, Color.G, Color.R, Color.A };
+						Dst[Idx] = Values[Channel];
+					}
+				} });
+		}
+		for (const int32 DstChannels : { 4, 3, 1 })
+		{
+			Kernels.Add({ FString::Printf(TEXT("RGBA16ToUnorm8 %d"), DstChannels), DstChannels,
+				[DstChannels](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::RGBA16ToUnorm8(Dst, Source.Unorm16s.GetData() + First * 4, NumPixels, DstChannels); },
+				[DstChannels](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { ReferenceChannels(Dst, Source.Unorm16s.GetData() + First * 4, NumPixels, DstChannels, ReferenceUnorm16ToUnorm8); } });
+			Kernels.Add({ FString::Printf(TEXT("RGBA16FToUnorm8 %d"), DstChannels), DstChannels,
+				[DstChannels](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::RGBA16FToUnorm8(Dst, reinterpret_cast<const FFloat16Color*>(Source.Halves.GetData() + First * 4), NumPixels, DstChannels); },
+				[DstChannels](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { ReferenceChannels(Dst, Source.Halves.GetData() + First * 4, NumPixels, DstChannels, [](FFloat16 Value) { return ReferenceFloatToUnorm8(Value.GetFloat()); }); } });
+			Kernels.Add({ FString::Printf(TEXT("RGBA32FToUnorm8 %d"), DstChannels), DstChannels,
+				[DstChannels](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::RGBA32FToUnorm8(Dst, reinterpret_cast<const FLinearColor*>(Source.Floats.GetData() + First * 4), NumPixels, DstChannels); },
+				[DstChannels](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { ReferenceChannels(Dst, Source.Floats.GetData() + First * 4, NumPixels, DstChannels, ReferenceFloatToUnorm8); } });
+		}
+		Kernels.Add({ TEXT("R16ToUnorm8"), 1,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::R16ToUnorm8(Dst, Source.Unorm16s.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					Dst[Idx] = ReferenceUnorm16ToUnorm8(Source.Unorm16s[First + Idx]);
+				}
+			} });
+		Kernels.Add({ TEXT("R16FToUnorm8"), 1,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::R16FToUnorm8(Dst, Source.Halves.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					Dst[Idx] = ReferenceFloatToUnorm8(Source.Halves[First + Idx].GetFloat());
+				}
+			} });
+		Kernels.Add({ TEXT("R32FToUnorm8"), 1,
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels) { PixelConversion::R32FToUnorm8(Dst, Source.Floats.GetData() + First, NumPixels); },
+			[](uint8* Dst, const FSource& Source, int64 First, int64 NumPixels)
+			{
+				for (int64 Idx = 0; Idx < NumPixels; ++Idx)
+				{
+					Dst[Idx] = ReferenceFloatToUnorm8(Source.Floats[First + Idx]);
+				}
+			} });
+		return Kernels;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealImGuiPixelConversionTest, "ImGui.PixelConversion.MatchesReference", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FUnrealImGuiPixelConversionTest::RunTest(const FString& Parameters)
+{
+	using namespace UnrealImGui::PixelConversionTests;
+
+	// around every vector width, the 256 value block of the half kernels and odd tails
+	static const int64 PixelCounts[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 255, 256, 257, 1001 };
+	// bytes past the end that must stay untouched
+	constexpr int32 GuardBytes = 32;
+	constexpr uint8 GuardValue = 0xCD;
+
+	const FSource Source(1001 + 1);
+	for (const FKernel& Kernel : MakeKernels())
+	{
+		for (const int64 NumPixels : PixelCounts)
+		{
+			// the second pass reads from an unaligned source
+			for (const int64 First : { 0, 1 })
+			{
+				const int64 NumBytes = NumPixels * Kernel.DstChannels;
+				TArray<uint8> Expected;
+				Expected.Init(GuardValue, NumBytes + GuardBytes);
+				Kernel.Reference(Expected.GetData(), Source, First, NumPixels);
+
+				// written at an odd offset so the stores are unaligned as well
+				TArray<uint8> Actual;
+				Actual.Init(GuardValue, 1 + NumBytes + GuardBytes);
+				Kernel.Convert(Actual.GetData() + 1, Source, First, NumPixels);
+
+				for (int64 Idx = 0; Idx < NumBytes + GuardBytes; ++Idx)
+				{
+					if (Actual[1 + Idx] != Expected[Idx])
+					{
+						AddError(FString::Printf(TEXT("%s with %lld pixels from %lld: byte %lld is %d, expected %d"), *Kernel.Name, NumPixels, First, Idx, Actual[1 + Idx], Expected[Idx]));
+						break;
+					}
+				}
+				TestTrue(*FString::Printf(TEXT("%s leaves the byte before the output"), *Kernel.Name), Actual[0] == GuardValue);
+			}
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealImGuiPixelConversionTimingTest, "ImGui.PixelConversion.Timing", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FUnrealImGuiPixelConversionTimingTest::RunTest(const FString& Parameters)
+{
+	using namespace UnrealImGui::PixelConversionTests;
+
+	// a 1024 x 1024 texture, the best of a few runs
+	constexpr int64 NumPixels = 1024 * 1024;
+	constexpr int32 NumRuns = 5;
+
+	const FSource Source(NumPixels);
+	TArray<uint8> Dst;
+	Dst.SetNumUninitialized(NumPixels * 4);
+
+	const auto BestSeconds = [&](const FConvertFunc& Convert)
+	{
+		double Best = TNumericLimits<double>::Max();
+		for (int32 Run = 0; Run < NumRuns; ++Run)
+		{
+			const double StartSeconds = FPlatformTime::Seconds();
+			Convert(Dst.GetData(), Source, 0, NumPixels);
+			Best = FMath::Min(Best, FPlatformTime::Seconds() - StartSeconds);
+		}
+		return Best;
+	};
+
+	for (const FKernel& Kernel : MakeKernels())
+	{
+		const double KernelSeconds = BestSeconds(Kernel.Convert);
+		const double ReferenceSeconds = BestSeconds(Kernel.Reference);
+		AddInfo(FString::Printf(TEXT("%s: %.3f ms, reference %.3f ms, %.2fx"), *Kernel.Name, KernelSeconds * 1000.0, ReferenceSeconds * 1000.0, ReferenceSeconds / FMath::Max(KernelSeconds, 1e-9)));
+	}
+	return true;
+}
+
+#endif
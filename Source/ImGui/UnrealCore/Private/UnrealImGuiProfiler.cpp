@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnrealImGuiProfiler.h"
+
+#include <atomic>
+
+#include "imgui.h"
+#include "implot.h"
+#include "Misc/ScopeLock.h"
+
+namespace UnrealImGui::Profiler
+{
+	namespace
+	{
+		constexpr int32 HistorySize = 300;
+		// tracks stop being shown when no sample arrived for this long, e.g. closed panels and disconnected clients
+		constexpr double TrackTimeoutSeconds = 5.0;
+
+		struct FTrack
+		{
+			EGroup Group;
+			FName Name;
+			TArray<float> Values;
+			int32 Offset = 0;
+			double LastSampleSeconds = 0.0;
+
+			void Add(float Value)
+			{
+				if (Values.Num() < HistorySize)
+				{
+					Values.Add(Value);
+				}
+				else
+				{
+					Values[Offset] = Value;
+					Offset = (Offset + 1) % HistorySize;
+				}
+			}
+			float Last() const
+			{
+				return Values.Num() < HistorySize ? Values.Last() : Values[(Offset + HistorySize - 1) % HistorySize];
+			}
+		};
+
+		std::atomic<bool> bEnabled{ false };
+		FCriticalSection TracksCriticalSection;
+		TMap<TPair<EGroup, FName>, FTrack> Tracks;
+
+		const char* GetGroupName(EGroup Group)
+		{
+			switch (Group)
+			{
+			case EGroup::GameThread: return "Game Thread";
+			case EGroup::Panels: return "Panels";
+			case EGroup::WSThread: return "WS Thread";
+			case EGroup::Clients: return "Clients";
+			default: return "Unknown";
+			}
+		}
+	}
+
+	bool IsEnabled()
+	{
+		return bEnabled.load(std::memory_order_relaxed);
+	}
+
+	void SetEnabled(bool bEnable)
+	{
+		if (bEnabled.exchange(bEnable) && bEnable == false)
+		{
+			FScopeLock ScopeLock{ &TracksCriticalSection };
+			Tracks.Empty();
+		}
+	}
+
+	void AddSample(EGroup Group, FName Track, double Value)
+	{
+		if (IsEnabled() == false)
+		{
+			return;
+		}
+		FScopeLock ScopeLock{ &TracksCriticalSection };
+		FTrack& Data = Tracks.FindOrAdd({ Group, Track });
+		if (Data.Values.Num() == 0)
+		{
+			Data.Group = Group;
+			Data.Name = Track;
+			Data.Values.Reserve(HistorySize);
+		}
+		Data.Add(Value);
+		Data.LastSampleSeconds = FPlatformTime::Seconds();
+	}
+
+	void DrawWindow(bool* bOpen)
+	{
+		SetEnabled(*bOpen);
+		if (*bOpen == false)
+		{
+			return;
+		}
+
+		ImGui::SetNextWindowSize({ 720.f, 640.f }, ImGuiCond_FirstUseEver);
+		if (ImGui::Begin("Pipeline Profiler", bOpen) == false)
+		{
+			ImGui::End();
+			return;
+		}
+
+		// snapshot so that the samplers aren't blocked while drawing
+		TArray<FTrack> Snapshot;
+		{
+			FScopeLock ScopeLock{ &TracksCriticalSection };
+			const double CurSeconds = FPlatformTime::Seconds();
+			for (auto It = Tracks.CreateIterator(); It; ++It)
+			{
+				if (CurSeconds - It.Value().LastSampleSeconds > TrackTimeoutSeconds)
+				{
+					It.RemoveCurrent();
+					continue;
+				}
+				Snapshot.Add(It.Value());
+			}
+		}
+		Snapshot.Sort([](const FTrack& LHS, const FTrack& RHS)
+		{
+			return LHS.Group != RHS.Group ? LHS.Group < RHS.Group : LHS.Name.LexicalLess(RHS.Name);
+		});
+
+		TArray<float> Sorted;
+		for (int32 GroupIdx = 0; GroupIdx < (int32)EGroup::Num; ++GroupIdx)
+		{
+			const EGroup Group = EGroup(GroupIdx);
+			const bool bIsBytes = Group == EGroup::Clients;
+			const TArrayView<FTrack> GroupTracks = [&]
+			{
+				const int32 Start = Snapshot.IndexOfByPredicate([Group](const FTrack& Track) { return Track.Group == Group; });
+				if (Start == INDEX_NONE)
+				{
+					return TArrayView<FTrack>{};
+				}
+				int32 End = Start;
+				while (End < Snapshot.Num() && Snapshot[End].Group == Group)
+				{
+					End += 1;
+				}
+				return TArrayView<FTrack>{ Snapshot.GetData() + Start, End - Start };
+			}();
+			if (GroupTracks.Num() == 0 || ImGui::CollapsingHeader(GetGroupName(Group), ImGuiTreeNodeFlags_DefaultOpen) == false)
+			{
+				continue;
+			}
+
+			ImGui::PushID(GroupIdx);
+			if (ImPlot::BeginPlot("##History", { -1.f, 180.f }, ImPlotFlags_NoTitle))
+			{
+				ImPlot::SetupAxes(nullptr, bIsBytes ? "bytes" : "ms", ImPlotAxisFlags_NoTickLabels, ImPlotAxisFlags_AutoFit);
+				ImPlot::SetupAxisLimits(ImAxis_X1, 0, HistorySize, ImGuiCond_Always);
+				for (const FTrack& Track : GroupTracks)
+				{
+					ImPlot::PlotLine(TCHAR_TO_UTF8(*Track.Name.ToString()), Track.Values.GetData(), Track.Values.Num(), 1.0, 0.0, ImPlotLineFlags_None, Track.Values.Num() < HistorySize ? 0 : Track.Offset);
+				}
+				ImPlot::EndPlot();
+			}
+
+			if (ImGui::BeginTable("##Stats", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp))
+			{
+				ImGui::TableSetupColumn("Track", ImGuiTableColumnFlags_WidthStretch, 3.f);
+				ImGui::TableSetupColumn("Last");
+				ImGui::TableSetupColumn("Min");
+				ImGui::TableSetupColumn("Avg");
+				ImGui::TableSetupColumn("P99");
+				ImGui::TableHeadersRow();
+				for (const FTrack& Track : GroupTracks)
+				{
+					Sorted = Track.Values;
+					Sorted.Sort();
+					double Sum = 0.0;
+					for (const float Value : Sorted)
+					{
+						Sum += Value;
+					}
+					const float P99 = Sorted[FMath::Min(FMath::FloorToInt(Sorted.Num() * 0.99f), Sorted.Num() - 1)];
+					const char* Format = bIsBytes ? "%.0f" : "%.3f";
+
+					ImGui::TableNextRow();
+					ImGui::TableNextColumn();
+					ImGui::TextUnformatted(TCHAR_TO_UTF8(*Track.Name.ToString()));
+					ImGui::TableNextColumn();
+					ImGui::Text(Format, Track.Last());
+					ImGui::TableNextColumn();
+					ImGui::Text(Format, Sorted[0]);
+					ImGui::TableNextColumn();
+					ImGui::Text(Format, Sum / Sorted.Num());
+					ImGui::TableNextColumn();
+					ImGui::Text(Format, P99);
+				}
+				ImGui::EndTable();
+			}
+			ImGui::PopID();
+		}
+
+		ImGui::End();
+	}
+}
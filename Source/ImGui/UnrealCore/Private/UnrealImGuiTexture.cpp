@@ -6,13 +6,36 @@
 #include "ImageUtils.h"
 #include "imgui.h"
 #include "RenderingThread.h"
+#include "RHIGPUReadback.h"
 #include "TextureResource.h"
+#include "UnrealImGuiPixelConversion.h"
+#include "Misc/App.h"
+#include "Misc/CoreDelegates.h"
 #include "Engine/Texture2D.h"
 #include "Engine/TextureRenderTarget2D.h"
+#include <atomic>
+
+#ifndef STB_RECT_PACK_IMPLEMENTATION // imgui_draw.cpp already has it when both end up in one unity file
+#define STBRP_STATIC
+#define STBRP_ASSERT(x) check(x)
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "../../ImGuiLibrary/Private/imstb_rectpack.h"
+#endif
+
+TAutoConsoleVariable<int32> CVar_ImGui_TextureAtlas
+{
+	TEXT("ImGui.TextureAtlas"),
+	0,
+	TEXT("ImGui Texture Atlas\n")
+	TEXT("0: Every texture is drawn on its own\n")
+	TEXT("1: Small UTexture2D images share atlas pages, draw commands of neighbouring images merge")
+};
 
 namespace UnrealImGui
 {
 	Private::FUpdateTextureData_WS Private::UpdateTextureData_WS;
+	Private::FRemoveTextureData_WS Private::RemoveTextureData_WS;
+	Private::FReadRenderTarget_CPU Private::ReadRenderTarget_CPU;
 
 	namespace TextureIdManager
 	{
@@ -20,6 +43,167 @@ namespace UnrealImGui
 		uint32 HandleIdCounter = 0;
 		TMap<TWeakObjectPtr<const UTexture>, uint32> HandleIdMap;
 		TMap<uint32, TWeakObjectPtr<const UTexture>> IdTextureMap;
+		// format of the last upload to the web clients, used to restore evicted textures
+		TMap<uint32, ETextureFormat> IdFormatMap;
+		FDelegateHandle PostGarbageCollectHandle;
+	}
+
+	// converted WS payloads of UTexture2D sources, a repeated upload of an unchanged asset skips decompressing and converting
+	namespace TexturePayloadCache
+	{
+		struct FKey
+		{
+			FObjectKey Texture;
+			FGuid Revision;
+			ETextureFormat Format;
+
+			bool operator==(const FKey& Other) const
+			{
+				return Texture == Other.Texture && Revision == Other.Revision && Format == Other.Format;
+			}
+			friend uint32 GetTypeHash(const FKey& Key)
+			{
+				return HashCombine(HashCombine(GetTypeHash(Key.Texture), GetTypeHash(Key.Revision)), static_cast<uint32>(Key.Format));
+			}
+		};
+		struct FPayload
+		{
+			ETextureFormat Format;
+			int32 Width;
+			int32 Height;
+			TArray<uint8> Data;
+			uint64 LastUsed;
+		};
+		constexpr int64 MaxBytes = 64 * 1024 * 1024;
+		TMap<FKey, FPayload> Payloads;
+		int64 TotalBytes = 0;
+		uint64 UseCounter = 0;
+
+		// changes whenever the source is reimported or edited, invalid when the texture can't tell
+		FGuid GetRevision(const UTexture2D* Texture2D)
+		{
+#if WITH_EDITORONLY_DATA
+			return Texture2D->Source.GetId();
+#else
+			return Texture2D->GetLightingGuid();
+#endif
+		}
+
+		bool Convert(UTexture2D* Texture2D, ETextureFormat TextureFormat, FPayload& OutPayload)
+		{
+			FImage Image;
+			if (FImageUtils::GetTexture2DSourceImage(Texture2D, Image) == false)
+			{
+				return false;
+			}
+			using namespace PixelConversion;
+			const int64 NumPixels = Image.GetNumPixels();
+			const int32 DstChannels = TextureFormat == ETextureFormat::RGBA8 ? 4 : TextureFormat == ETextureFormat::RGB8 ? 3 : 1;
+			// single channel sources stay single channel
+			const ETextureFormat SingleChannelFormat = TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8;
+			TArray<uint8>& Data = OutPayload.Data;
+			switch (Image.Format) {
+			case ERawImageFormat::G8:
+				TextureFormat = SingleChannelFormat;
+				Data.Append(Image.RawData.GetData(), Image.RawData.Num());
+				break;
+			case ERawImageFormat::BGRA8:
+			case ERawImageFormat::BGRE8:
+				{
+					const FColor* RawData = (Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8()).GetData();
+					Data.SetNumUninitialized(NumPixels * DstChannels);
+					switch (DstChannels)
+					{
+					case 4:
+						BGRA8ToRGBA8(Data.GetData(), RawData, NumPixels);
+						break;
+					case 3:
+						BGRA8ToRGB8(Data.GetData(), RawData, NumPixels);
+						break;
+					default:
+						BGRA8ToChannel8(Data.GetData(), RawData, NumPixels, 3);
+					}
+				}
+				break;
+			case ERawImageFormat::RGBA16:
+				Data.SetNumUninitialized(NumPixels * DstChannels);
+				RGBA16ToUnorm8(Data.GetData(), Image.AsRGBA16().GetData(), NumPixels, DstChannels);
+				break;
+			case ERawImageFormat::RGBA16F:
+				Data.SetNumUninitialized(NumPixels * DstChannels);
+				RGBA16FToUnorm8(Data.GetData(), Image.AsRGBA16F().GetData(), NumPixels, DstChannels);
+				break;
+			case ERawImageFormat::RGBA32F:
+				Data.SetNumUninitialized(NumPixels * DstChannels);
+				RGBA32FToUnorm8(Data.GetData(), Image.AsRGBA32F().GetData(), NumPixels, DstChannels);
+				break;
+			case ERawImageFormat::G16:
+				TextureFormat = SingleChannelFormat;
+				Data.SetNumUninitialized(NumPixels);
+				R16ToUnorm8(Data.GetData(), Image.AsG16().GetData(), NumPixels);
+				break;
+			case ERawImageFormat::R16F:
+				TextureFormat = SingleChannelFormat;
+				Data.SetNumUninitialized(NumPixels);
+				R16FToUnorm8(Data.GetData(), Image.AsR16F().GetData(), NumPixels);
+				break;
+			case ERawImageFormat::R32F:
+				TextureFormat = SingleChannelFormat;
+				Data.SetNumUninitialized(NumPixels);
+				R32FToUnorm8(Data.GetData(), Image.AsR32F().GetData(), NumPixels);
+				break;
+			default:
+				ensure(false);
+				return false;
+			}
+			OutPayload.Format = TextureFormat;
+			OutPayload.Width = Image.GetWidth();
+			OutPayload.Height = Image.GetHeight();
+			return true;
+		}
+
+		// payloads that can't be cached live here until the next conversion
+		FPayload Uncached;
+
+		// null when the source can't be read
+		const FPayload* FindOrConvert(UTexture2D* Texture2D, ETextureFormat TextureFormat)
+		{
+			const FKey Key{ FObjectKey{ Texture2D }, GetRevision(Texture2D), TextureFormat };
+			if (FPayload* Payload = Payloads.Find(Key))
+			{
+				Payload->LastUsed = ++UseCounter;
+				return Payload;
+			}
+
+			FPayload Payload;
+			if (Convert(Texture2D, TextureFormat, Payload) == false)
+			{
+				return nullptr;
+			}
+			const int64 PayloadBytes = Payload.Data.Num();
+			if (Key.Revision.IsValid() == false || PayloadBytes > MaxBytes)
+			{
+				Uncached = MoveTemp(Payload);
+				return &Uncached;
+			}
+			// least recently used first, rare enough for a linear search
+			while (TotalBytes + PayloadBytes > MaxBytes && Payloads.Num() > 0)
+			{
+				auto Oldest = Payloads.CreateIterator();
+				for (auto It = Payloads.CreateIterator(); It; ++It)
+				{
+					if (It->Value.LastUsed < Oldest->Value.LastUsed)
+					{
+						Oldest = It;
+					}
+				}
+				TotalBytes -= Oldest->Value.Data.Num();
+				Oldest.RemoveCurrent();
+			}
+			TotalBytes += PayloadBytes;
+			Payload.LastUsed = ++UseCounter;
+			return &Payloads.Add(Key, MoveTemp(Payload));
+		}
 	}
 
 	UTextureRenderTarget2D* CreateTexture(FImGuiTextureHandle& Handle, ETextureFormat TextureFormat, int32 Width, int32 Height, UObject* Outer, const FName& Name)
@@ -40,101 +224,99 @@ namespace UnrealImGui
 	{
 		if (Private::UpdateTextureData_WS)
 		{
+			TextureIdManager::IdFormatMap.Add(Handle, TextureFormat);
 			Private::UpdateTextureData_WS(Handle, TextureFormat, Width, Height, Data);
 		}
 	}
 
-	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, int32 Width, int32 Height, const uint8* Data, UTextureRenderTarget2D* Texture)
+	int32 GetBytesPerPixel(ETextureFormat TextureFormat)
 	{
-		UpdateTextureDataToWS(Handle, TextureFormat, Width, Height, Data);
-		if (Texture)
+		switch (TextureFormat)
 		{
-			int32 BytesPerPixel;
-			switch (TextureFormat)
+		case ETextureFormat::Alpha8:
+		case ETextureFormat::Gray8:
+			return 1;
+		case ETextureFormat::RGB8:
+			return 3;
+		case ETextureFormat::RGBA8:
+			return 4;
+		default:
+			checkNoEntry();
+			return 0;
+		}
+	}
+
+	// Data holds Width x Height pixels written at X, Y, clipped to the texture
+	void EnqueueTextureUpload(UTextureRenderTarget2D* Texture, ETextureFormat TextureFormat, int32 X, int32 Y, int32 Width, int32 Height, TArray<uint8>&& Data)
+	{
+		ENQUEUE_RENDER_COMMAND(ImGuiUpdateTexture)(
+			[TextureDataRaw = MoveTemp(Data),
+			TextureFormat,
+			X, Y, Width, Height,
+			RenderTargetPtr = TWeakObjectPtr<UTextureRenderTarget2D>(Texture)]
+			(FRHICommandListImmediate& RHICmdList)
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
-				BytesPerPixel = 1;
-				break;
-			case ETextureFormat::RGB8:
-				BytesPerPixel = 3;
-				break;
-			case ETextureFormat::RGBA8:
-				BytesPerPixel = 4;
-				break;
-			default:
-				checkNoEntry();
-				BytesPerPixel = 0;
-			}
-			ENQUEUE_RENDER_COMMAND(ImGuiFontAtlas)(
-				[TextureDataRaw = TArray<uint8>{ Data, Width * Height * BytesPerPixel },
-				TextureFormat,
-				RenderTargetPtr = TWeakObjectPtr<UTextureRenderTarget2D>(Texture)]
-				(FRHICommandListImmediate& RHICmdList)
+				UTextureRenderTarget2D* RT = RenderTargetPtr.Get();
+				if (!RT)
 				{
-					UTextureRenderTarget2D* RT = RenderTargetPtr.Get();
-					if (!RT)
-					{
-						return;
-					}
-					const FTextureResource* RenderTargetResource = RT->GetResource();
-					if (RenderTargetResource == nullptr)
-					{
-						return;
-					}
+					return;
+				}
+				const FTextureResource* RenderTargetResource = RT->GetResource();
+				if (RenderTargetResource == nullptr)
+				{
+					return;
+				}
+
+				const int64 NumPixels = int64(Width) * Height;
+				const uint32 RegionWidth = FMath::Min(Width, int32(RT->SizeX) - X);
+				const uint32 RegionHeight = FMath::Min(Height, int32(RT->SizeY) - Y);
+				if (TextureDataRaw.Num() < NumPixels * GetBytesPerPixel(TextureFormat) || int32(RegionWidth) <= 0 || int32(RegionHeight) <= 0)
+				{
+					return;
+				}
 
-					TArray<uint8> FontAtlasTextureData;
-					FontAtlasTextureData.SetNumUninitialized(TextureDataRaw.Num() * 4);
+				// RGBA8 is uploaded as is
+				TArray<uint8> FontAtlasTextureData;
+				if (TextureFormat != ETextureFormat::RGBA8)
+				{
+					using namespace PixelConversion;
+					FontAtlasTextureData.SetNumUninitialized(NumPixels * 4);
+					switch (TextureFormat)
 					{
-						const uint8* Src = TextureDataRaw.GetData();
-						uint32* Dst = reinterpret_cast<uint32*>(FontAtlasTextureData.GetData());
-						switch (TextureFormat)
-						{
-						case ETextureFormat::Alpha8:
-							for (int32 Idx = RT->SizeX * RT->SizeY; Idx > 0; --Idx)
-							{
-								*Dst++ = IM_COL32(255, 255, 255, *Src++);
-							}
-							break;
-						case ETextureFormat::Gray8:
-							for (int32 Idx = RT->SizeX * RT->SizeY; Idx > 0; --Idx)
-							{
-								const uint8 V = *Src++;
-								*Dst++ = IM_COL32(V, V, V, 255);
-							}
-							break;
-						case ETextureFormat::RGB8:
-							for (int32 Idx = RT->SizeX * RT->SizeY; Idx > 0; --Idx)
-							{
-								const uint8 R = *Src++;
-								const uint8 G = *Src++;
-								const uint8 B = *Src++;
-								*Dst++ = IM_COL32(R, G, B, 255);
-							}
-							break;
-						case ETextureFormat::RGBA8:
-							for (int32 Idx = RT->SizeX * RT->SizeY; Idx > 0; --Idx)
-							{
-								const uint8 R = *Src++;
-								const uint8 G = *Src++;
-								const uint8 B = *Src++;
-								*Dst++ = IM_COL32(R, G, B, *Src++);
-							}
-							break;
-						}
+					case ETextureFormat::Alpha8:
+						Alpha8ToRGBA8(FontAtlasTextureData.GetData(), TextureDataRaw.GetData(), NumPixels);
+						break;
+					case ETextureFormat::Gray8:
+						Gray8ToRGBA8(FontAtlasTextureData.GetData(), TextureDataRaw.GetData(), NumPixels);
+						break;
+					case ETextureFormat::RGB8:
+						RGB8ToRGBA8(FontAtlasTextureData.GetData(), TextureDataRaw.GetData(), NumPixels);
+						break;
+					default:
+						break;
 					}
+				}
+				const uint8* UploadData = TextureFormat == ETextureFormat::RGBA8 ? TextureDataRaw.GetData() : FontAtlasTextureData.GetData();
 
-					constexpr uint32 SrcBpp = sizeof(uint32);
-					const uint32 SrcPitch = RT->SizeX * SrcBpp;
-					FRHITexture2D* Texture = RenderTargetResource->GetTexture2DRHI();
-					const FUpdateTextureRegion2D Region{ 0, 0, 0, 0, uint32(RT->SizeX), uint32(RT->SizeY) };
-					RHIUpdateTexture2D(
-						Texture,
-						0,
-						Region,
-						SrcPitch,
-						FontAtlasTextureData.GetData());
-				});
+				constexpr uint32 SrcBpp = sizeof(uint32);
+				const uint32 SrcPitch = Width * SrcBpp;
+				FRHITexture2D* Texture = RenderTargetResource->GetTexture2DRHI();
+				const FUpdateTextureRegion2D Region{ uint32(X), uint32(Y), 0, 0, RegionWidth, RegionHeight };
+				RHIUpdateTexture2D(
+					Texture,
+					0,
+					Region,
+					SrcPitch,
+					UploadData);
+			});
+	}
+
+	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, int32 Width, int32 Height, const uint8* Data, UTextureRenderTarget2D* Texture)
+	{
+		UpdateTextureDataToWS(Handle, TextureFormat, Width, Height, Data);
+		if (Texture)
+		{
+			EnqueueTextureUpload(Texture, TextureFormat, 0, 0, Width, Height, TArray<uint8>{ Data, Width * Height * GetBytesPerPixel(TextureFormat) });
 		}
 	}
 
@@ -144,328 +326,641 @@ namespace UnrealImGui
 		{
 			return;
 		}
-		FImage Image;
-		if (FImageUtils::GetTexture2DSourceImage(Texture2D, Image) == false)
+		if (!Private::UpdateTextureData_WS)
+		{
+			return;
+		}
+		if (const TexturePayloadCache::FPayload* Payload = TexturePayloadCache::FindOrConvert(Texture2D, TextureFormat))
+		{
+			UpdateTextureDataToWS(Handle, Payload->Format, Payload->Width, Payload->Height, Payload->Data.GetData());
+		}
+	}
+
+	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D)
+	{
+		if (RenderTarget2D == nullptr)
+		{
+			return;
+		}
+
+		FTextureRenderTarget2DResource* RTResource = static_cast<FTextureRenderTarget2DResource*>(RenderTarget2D->GameThread_GetRenderTargetResource());
+		if (!ensure(RTResource))
+		{
+			return;
+		}
+		TArray<FColor> RawData;
+		if (!ensure(RTResource->ReadPixels(RawData, {}, FIntRect{ 0, 0, RenderTarget2D->SizeX, RenderTarget2D->SizeY })))
 		{
 			return;
 		}
-		switch (Image.Format) {
-		case ERawImageFormat::G8:
-			UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Image.AsG8().GetData());
+
+		const ETextureRenderTargetFormat Format = RenderTarget2D->RenderTargetFormat;
+		const bool bSingleChannel = Format == RTF_R8 || Format == RTF_R16f || Format == RTF_R32f;
+		if (bSingleChannel && TextureFormat != ETextureFormat::Alpha8)
+		{
+			TextureFormat = ETextureFormat::Gray8;
+		}
+
+		using namespace PixelConversion;
+		TArray<uint8> Data;
+		switch (TextureFormat)
+		{
+		case ETextureFormat::Alpha8:
+		case ETextureFormat::Gray8:
+			Data.SetNumUninitialized(RawData.Num());
+			// FColor is BGRA in memory, single channel targets read back in R
+			BGRA8ToChannel8(Data.GetData(), RawData.GetData(), RawData.Num(), bSingleChannel ? 2 : 3);
 			break;
-		case ERawImageFormat::BGRA8:
-		case ERawImageFormat::BGRE8:
-			switch (TextureFormat)
+		case ETextureFormat::RGB8:
+			Data.SetNumUninitialized(RawData.Num() * 3);
+			BGRA8ToRGB8(Data.GetData(), RawData.GetData(), RawData.Num());
+			break;
+		case ETextureFormat::RGBA8:
+			Data.SetNumUninitialized(RawData.Num() * 4);
+			BGRA8ToRGBA8(Data.GetData(), RawData.GetData(), RawData.Num());
+			break;
+		default:
+			ensure(false);
+			return;
+		}
+		UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
+	}
+
+	// small textures packed into shared pages, images drawn from one page merge into one draw command
+	namespace TextureAtlas
+	{
+		constexpr int32 PageSize = 1024;
+		constexpr int32 MaxTextureSize = 128;
+		// edge pixels repeated around every image, bilinear filtering never samples the neighbours
+		constexpr int32 Padding = 1;
+
+		struct FPage
+		{
+			ETextureFormat Format;
+			FImGuiTextureHandle Handle;
+			UTextureRenderTarget2D* Texture;
+			stbrp_context Packer;
+			TArray<stbrp_node> Nodes;
+			TArray<uint8> Data;
+			// padded rects of collected images, reused before the packer places new ones
+			TArray<FIntRect> FreeRects;
+			int32 NumEntries = 0;
+			// the web clients get the whole page once per frame
+			bool bDirty = false;
+		};
+		struct FEntry
+		{
+			// INDEX_NONE when the texture is drawn on its own
+			int32 Page;
+			FGuid Revision;
+			FIntRect Rect;
+			FVector2D UVMin;
+			FVector2D UVMax;
+		};
+		// null slots are released pages, entries keep the page index
+		TArray<TUniquePtr<FPage>> Pages;
+		TMap<TPair<FObjectKey, ETextureFormat>, FEntry> Entries;
+
+		void FlushPages()
+		{
+			for (const TUniquePtr<FPage>& Page : Pages)
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+				if (Page && Page->bDirty)
 				{
-					const TArrayView64<FColor> RawData = Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx] = RawData[Idx].A;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					Page->bDirty = false;
+					UpdateTextureDataToWS(Page->Handle, Page->Format, PageSize, PageSize, Page->Data.GetData());
 				}
-				break;
-			case ETextureFormat::RGB8:
+			}
+		}
+
+		int32 AddPage(ETextureFormat Format)
+		{
+			if (Pages.Num() == 0)
+			{
+				FCoreDelegates::OnEndFrame.AddStatic(&FlushPages);
+			}
+			int32 PageIndex = Pages.IndexOfByPredicate([](const TUniquePtr<FPage>& Page) { return Page.IsValid() == false; });
+			if (PageIndex == INDEX_NONE)
+			{
+				PageIndex = Pages.AddDefaulted();
+			}
+			Pages[PageIndex] = MakeUnique<FPage>();
+			FPage& Page = *Pages[PageIndex];
+			Page.Format = Format;
+			Page.Texture = CreateTexture(Page.Handle, Format, PageSize, PageSize, GetTransientPackage(), MakeUniqueObjectName(GetTransientPackage(), UTextureRenderTarget2D::StaticClass(), TEXT("ImGuiTextureAtlas")));
+			Page.Texture->AddToRoot();
+			Page.Nodes.SetNumUninitialized(PageSize);
+			stbrp_init_target(&Page.Packer, PageSize, PageSize, Page.Nodes.GetData(), Page.Nodes.Num());
+			Page.Data.SetNumZeroed(PageSize * PageSize * GetBytesPerPixel(Format));
+			return PageIndex;
+		}
+
+		// the smallest free rect holding the size, its leftover stays free
+		bool TakeFreeRect(FPage& Page, int32 Width, int32 Height, FIntPoint& OutMin)
+		{
+			int32 BestIndex = INDEX_NONE;
+			for (int32 Idx = 0; Idx < Page.FreeRects.Num(); ++Idx)
+			{
+				const FIntRect& FreeRect = Page.FreeRects[Idx];
+				if (FreeRect.Width() >= Width && FreeRect.Height() >= Height && (BestIndex == INDEX_NONE || FreeRect.Area() < Page.FreeRects[BestIndex].Area()))
 				{
-					const TArrayView64<FColor> RawData = Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 3] = RawData[Idx].R;
-						Data[Idx * 3 + 1] = RawData[Idx].G;
-						Data[Idx * 3 + 2] = RawData[Idx].B;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					BestIndex = Idx;
 				}
-				break;
-			case ETextureFormat::RGBA8:
+			}
+			if (BestIndex == INDEX_NONE)
+			{
+				return false;
+			}
+			const FIntRect FreeRect = Page.FreeRects[BestIndex];
+			Page.FreeRects.RemoveAtSwap(BestIndex);
+			OutMin = FreeRect.Min;
+			if (FreeRect.Width() > Width)
+			{
+				Page.FreeRects.Add({ FreeRect.Min.X + Width, FreeRect.Min.Y, FreeRect.Max.X, FreeRect.Min.Y + Height });
+			}
+			if (FreeRect.Height() > Height)
+			{
+				Page.FreeRects.Add({ FreeRect.Min.X, FreeRect.Min.Y + Height, FreeRect.Max.X, FreeRect.Max.Y });
+			}
+			return true;
+		}
+
+		bool Pack(FPage& Page, int32 Width, int32 Height, FIntPoint& OutMin)
+		{
+			if (TakeFreeRect(Page, Width, Height, OutMin))
+			{
+				return true;
+			}
+			stbrp_rect PackRect{ 0, Width, Height };
+			if (stbrp_pack_rects(&Page.Packer, &PackRect, 1) == 0)
+			{
+				return false;
+			}
+			OutMin = { PackRect.x, PackRect.y };
+			return true;
+		}
+
+		// a page without images is released, its handle goes with the render target once it is collected
+		void ReleaseRect(int32 PageIndex, const FIntRect& Rect)
+		{
+			FPage& Page = *Pages[PageIndex];
+			Page.NumEntries -= 1;
+			if (Page.NumEntries == 0)
+			{
+				Page.Texture->RemoveFromRoot();
+				Pages[PageIndex].Reset();
+				return;
+			}
+			Page.FreeRects.Add({ Rect.Min.X - Padding, Rect.Min.Y - Padding, Rect.Max.X + Padding, Rect.Max.Y + Padding });
+		}
+
+		void CopyToPage(FPage& Page, const FIntRect& Rect, const TexturePayloadCache::FPayload& Payload)
+		{
+			const int32 BytesPerPixel = GetBytesPerPixel(Page.Format);
+			const int32 RowBytes = Payload.Width * BytesPerPixel;
+			const int32 PaddedWidth = Payload.Width + Padding * 2;
+			const int32 PaddedHeight = Payload.Height + Padding * 2;
+			TArray<uint8> Region;
+			Region.SetNumUninitialized(PaddedWidth * PaddedHeight * BytesPerPixel);
+			for (int32 Row = 0; Row < PaddedHeight; ++Row)
+			{
+				const uint8* Src = Payload.Data.GetData() + FMath::Clamp(Row - Padding, 0, Payload.Height - 1) * RowBytes;
+				uint8* Dst = Region.GetData() + Row * PaddedWidth * BytesPerPixel;
+				for (int32 Pad = 0; Pad < Padding; ++Pad)
 				{
-					const TArrayView64<FColor> RawData = Image.Format == ERawImageFormat::BGRA8 ? Image.AsBGRA8() : Image.AsBGRE8();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 4] = RawData[Idx].R;
-						Data[Idx * 4 + 1] = RawData[Idx].G;
-						Data[Idx * 4 + 2] = RawData[Idx].B;
-						Data[Idx * 4 + 3] = RawData[Idx].A;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					FMemory::Memcpy(Dst + Pad * BytesPerPixel, Src, BytesPerPixel);
+					FMemory::Memcpy(Dst + (Padding + Payload.Width + Pad) * BytesPerPixel, Src + RowBytes - BytesPerPixel, BytesPerPixel);
 				}
-				break;
+				FMemory::Memcpy(Dst + Padding * BytesPerPixel, Src, RowBytes);
+				FMemory::Memcpy(Page.Data.GetData() + ((Rect.Min.Y - Padding + Row) * PageSize + Rect.Min.X - Padding) * BytesPerPixel, Dst, PaddedWidth * BytesPerPixel);
 			}
-			break;
-		case ERawImageFormat::RGBA16:
-			switch (TextureFormat)
+			// slate only needs the new region, the page is resent to the web clients at the end of the frame
+			EnqueueTextureUpload(Page.Texture, Page.Format, Rect.Min.X - Padding, Rect.Min.Y - Padding, PaddedWidth, PaddedHeight, MoveTemp(Region));
+			Page.bDirty = true;
+		}
+
+		// null when the texture is drawn on its own
+		const FEntry* FindOrAdd(ETextureFormat TextureFormat, UTexture2D* Texture2D)
+		{
+			const FGuid Revision = TexturePayloadCache::GetRevision(Texture2D);
+			const TPair<FObjectKey, ETextureFormat> Key{ FObjectKey{ Texture2D }, TextureFormat };
+			FEntry* Entry = Entries.Find(Key);
+			if (Entry && Entry->Revision == Revision)
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+				return Entry->Page != INDEX_NONE ? Entry : nullptr;
+			}
+
+			const TexturePayloadCache::FPayload* Payload = Texture2D->GetSizeX() <= MaxTextureSize && Texture2D->GetSizeY() <= MaxTextureSize ? TexturePayloadCache::FindOrConvert(Texture2D, TextureFormat) : nullptr;
+			const bool bFits = Payload && Payload->Width <= MaxTextureSize && Payload->Height <= MaxTextureSize;
+
+			if (Entry && Entry->Page != INDEX_NONE)
+			{
+				// a changed source of the same size and format is written over the old image
+				if (bFits && Pages[Entry->Page]->Format == Payload->Format && Entry->Rect.Size() == FIntPoint{ Payload->Width, Payload->Height })
 				{
-					constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
-					const TArrayView64<uint16> RawData = Image.AsRGBA16();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
-					{
-						Data[Idx] = RawData[Idx * 4 + 3] * RGBA16Scale;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					Entry->Revision = Revision;
+					CopyToPage(*Pages[Entry->Page], Entry->Rect, *Payload);
+					return Entry;
 				}
-				break;
-			case ETextureFormat::RGB8:
+				ReleaseRect(Entry->Page, Entry->Rect);
+				Entry->Page = INDEX_NONE;
+			}
+
+			if (bFits == false)
+			{
+				Entries.Add(Key, { INDEX_NONE, Revision });
+				return nullptr;
+			}
+
+			const int32 PackedWidth = Payload->Width + Padding * 2;
+			const int32 PackedHeight = Payload->Height + Padding * 2;
+			FIntPoint PackedMin;
+			int32 PageIndex = Pages.IndexOfByPredicate([&](const TUniquePtr<FPage>& Page)
+			{
+				return Page && Page->Format == Payload->Format && Pack(*Page, PackedWidth, PackedHeight, PackedMin);
+			});
+			if (PageIndex == INDEX_NONE)
+			{
+				PageIndex = AddPage(Payload->Format);
+				verify(Pack(*Pages[PageIndex], PackedWidth, PackedHeight, PackedMin));
+			}
+
+			const FIntRect Rect{ PackedMin.X + Padding, PackedMin.Y + Padding, PackedMin.X + Padding + Payload->Width, PackedMin.Y + Padding + Payload->Height };
+			Pages[PageIndex]->NumEntries += 1;
+			CopyToPage(*Pages[PageIndex], Rect, *Payload);
+			return &Entries.Add(Key, { PageIndex, Revision, Rect, FVector2D{ Rect.Min } / PageSize, FVector2D{ Rect.Max } / PageSize });
+		}
+	}
+
+	// render targets read back without blocking, converted on the render thread and sent from the game thread
+	namespace RenderTargetStream
+	{
+		constexpr double KeepAliveSeconds = 1.0;
+
+		// shared with the render thread, outlives its stream while a readback is in flight
+		struct FReadback
+		{
+			FReadback()
+				: GPUReadback(TEXT("ImGuiRenderTargetStream"))
+			{}
+
+			FRHIGPUTextureReadback GPUReadback;
+			std::atomic<bool> bInFlight = false;
+			// render thread only, the request of the readback in flight
+			EPixelFormat PixelFormat = PF_Unknown;
+			ETextureFormat Format = ETextureFormat::RGBA8;
+			FIntPoint SrcSize = FIntPoint::ZeroValue;
+			FIntPoint DstSize = FIntPoint::ZeroValue;
+
+			FCriticalSection CompletedLock;
+			TArray<uint8> Completed;
+			FIntPoint CompletedSize = FIntPoint::ZeroValue;
+			bool bHasCompleted = false;
+		};
+		struct FStream
+		{
+			FImGuiTextureHandle Handle;
+			TWeakObjectPtr<UTextureRenderTarget2D> RenderTarget;
+			ETextureFormat Format = ETextureFormat::RGBA8;
+			FRenderTargetStreamSettings Settings;
+			double LastRefreshSeconds = 0.0;
+			double NextReadbackSeconds = 0.0;
+			TSharedRef<FReadback, ESPMode::ThreadSafe> Readback = MakeShared<FReadback, ESPMode::ThreadSafe>();
+		};
+		TMap<uint32, FStream> Streams;
+		FDelegateHandle EndFrameHandle;
+
+		FIntPoint GetStreamSize(int32 Width, int32 Height, int32 MaxSize)
+		{
+			const int32 LongSide = FMath::Max(Width, Height);
+			if (MaxSize <= 0 || LongSide <= MaxSize)
+			{
+				return { Width, Height };
+			}
+			return { FMath::Max(Width * MaxSize / LongSide, 1), FMath::Max(Height * MaxSize / LongSide, 1) };
+		}
+
+		// one row of Width pixels in the stream format, false for pixel formats without a conversion
+		bool ConvertRow(EPixelFormat PixelFormat, const uint8* Src, int32 Width, ETextureFormat TextureFormat, TArray<FColor>& Scratch, uint8* Dst)
+		{
+			using namespace PixelConversion;
+			const int32 DstChannels = TextureFormat == ETextureFormat::RGBA8 ? 4 : TextureFormat == ETextureFormat::RGB8 ? 3 : 1;
+			switch (PixelFormat)
+			{
+			case PF_R8G8B8A8:
+				Scratch.SetNumUninitialized(Width);
+				for (int32 Idx = 0; Idx < Width; ++Idx)
 				{
-					constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
-					const TArrayView64<uint16> RawData = Image.AsRGBA16();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < Image.GetWidth() * Image.GetHeight(); ++Idx)
-					{
-						Data[Idx * 3] = RawData[Idx * 4] * RGBA16Scale;
-						Data[Idx * 3 + 1] = RawData[Idx * 4 + 1] * RGBA16Scale;
-						Data[Idx * 3 + 2] = RawData[Idx * 4 + 2] * RGBA16Scale;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					Scratch[Idx] = FColor{ Src[Idx * 4 + 0], Src[Idx * 4 + 1], Src[Idx * 4 + 2], Src[Idx * 4 + 3] };
 				}
-				break;
-			case ETextureFormat::RGBA8:
+				Src = reinterpret_cast<const uint8*>(Scratch.GetData());
+				[[fallthrough]];
+			case PF_B8G8R8A8:
+				switch (DstChannels)
 				{
-					constexpr float RGBA16Scale = (float)TNumericLimits<uint8>::Max() / TNumericLimits<uint16>::Max();
-					const TArrayView64<uint16> RawData = Image.AsRGBA16();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < Image.GetWidth() * Image.GetHeight(); ++Idx)
-					{
-						Data[Idx * 4] = RawData[Idx * 4] * RGBA16Scale;
-						Data[Idx * 4 + 1] = RawData[Idx * 4 + 1] * RGBA16Scale;
-						Data[Idx * 4 + 2] = RawData[Idx * 4 + 2] * RGBA16Scale;
-						Data[Idx * 4 + 3] = RawData[Idx * 4 + 3] * RGBA16Scale;
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+				case 4:
+					BGRA8ToRGBA8(Dst, reinterpret_cast<const FColor*>(Src), Width);
+					break;
+				case 3:
+					BGRA8ToRGB8(Dst, reinterpret_cast<const FColor*>(Src), Width);
+					break;
+				default:
+					BGRA8ToChannel8(Dst, reinterpret_cast<const FColor*>(Src), Width, 3);
 				}
-				break;
+				return true;
+			case PF_FloatRGBA:
+				RGBA16FToUnorm8(Dst, reinterpret_cast<const FFloat16Color*>(Src), Width, DstChannels);
+				return true;
+			case PF_A32B32G32R32F:
+				RGBA32FToUnorm8(Dst, reinterpret_cast<const FLinearColor*>(Src), Width, DstChannels);
+				return true;
+			case PF_G8:
+			case PF_R8:
+				FMemory::Memcpy(Dst, Src, Width);
+				return true;
+			case PF_R16F:
+				R16FToUnorm8(Dst, reinterpret_cast<const FFloat16*>(Src), Width);
+				return true;
+			case PF_R32_FLOAT:
+				R32FToUnorm8(Dst, reinterpret_cast<const float*>(Src), Width);
+				return true;
+			default:
+				return false;
 			}
-			break;
-		case ERawImageFormat::RGBA16F:
-			switch (TextureFormat)
+		}
+
+		// nearest sampled down to the stream size
+		bool ConvertImage(EPixelFormat PixelFormat, const uint8* Src, int32 SrcPitch, FIntPoint SrcSize, ETextureFormat TextureFormat, FIntPoint DstSize, TArray<uint8>& OutData)
+		{
+			const int32 BytesPerPixel = GetBytesPerPixel(TextureFormat);
+			TArray<FColor> Scratch;
+			TArray<uint8> Row;
+			Row.SetNumUninitialized(SrcSize.X * BytesPerPixel);
+			OutData.SetNumUninitialized(DstSize.X * DstSize.Y * BytesPerPixel);
+			for (int32 Y = 0; Y < DstSize.Y; ++Y)
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+				const uint8* SrcRow = Src + int64(Y * SrcSize.Y / DstSize.Y) * SrcPitch;
+				uint8* DstRow = OutData.GetData() + Y * DstSize.X * BytesPerPixel;
+				if (DstSize.X == SrcSize.X)
 				{
-					const TArrayView64<FFloat16Color> RawData = Image.AsRGBA16F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
+					if (ConvertRow(PixelFormat, SrcRow, SrcSize.X, TextureFormat, Scratch, DstRow) == false)
 					{
-						Data[Idx] = RawData[Idx].A * TNumericLimits<uint8>::Max();
+						return false;
 					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					continue;
 				}
-				break;
-			case ETextureFormat::RGB8:
+				if (ConvertRow(PixelFormat, SrcRow, SrcSize.X, TextureFormat, Scratch, Row.GetData()) == false)
 				{
-					const TArrayView64<FFloat16Color> RawData = Image.AsRGBA16F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 3] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					return false;
 				}
-				break;
-			case ETextureFormat::RGBA8:
+				for (int32 X = 0; X < DstSize.X; ++X)
 				{
-					const TArrayView64<FFloat16Color> RawData = Image.AsRGBA16F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 4] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 3] = RawData[Idx].A * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					FMemory::Memcpy(DstRow + X * BytesPerPixel, Row.GetData() + (X * SrcSize.X / DstSize.X) * BytesPerPixel, BytesPerPixel);
 				}
-				break;
 			}
-			break;
-		case ERawImageFormat::RGBA32F:
-			switch (TextureFormat)
+			return true;
+		}
+
+		// render thread, true once the readback finished or failed
+		bool ResolveReadback(FReadback& Readback)
+		{
+			if (Readback.GPUReadback.IsReady() == false)
+			{
+				return false;
+			}
+			int32 RowPitchInPixels = 0;
+			if (const uint8* Data = static_cast<const uint8*>(Readback.GPUReadback.Lock(RowPitchInPixels)))
 			{
-			case ETextureFormat::Alpha8:
-			case ETextureFormat::Gray8:
+				TArray<uint8> Converted;
+				const int32 SrcPitch = RowPitchInPixels * GPixelFormats[Readback.PixelFormat].BlockBytes;
+				if (ConvertImage(Readback.PixelFormat, Data, SrcPitch, Readback.SrcSize, Readback.Format, Readback.DstSize, Converted))
 				{
-					const TArrayView64<FLinearColor> RawData = Image.AsRGBA32F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-					for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
-					{
-						Data[Idx] = RawData[Idx].A * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					FScopeLock ScopeLock{ &Readback.CompletedLock };
+					Readback.Completed = MoveTemp(Converted);
+					Readback.CompletedSize = Readback.DstSize;
+					Readback.bHasCompleted = true;
 				}
-				break;
-			case ETextureFormat::RGB8:
+				Readback.GPUReadback.Unlock();
+			}
+			return true;
+		}
+
+		void EnqueueReadback(const FStream& Stream, UTextureRenderTarget2D* RT)
+		{
+			const FIntPoint SrcSize{ RT->SizeX, RT->SizeY };
+			const FIntPoint DstSize = GetStreamSize(SrcSize.X, SrcSize.Y, Stream.Settings.MaxSize);
+
+			// nothing reaches the GPU, the pixels come from the CPU stand in right away
+			if (FApp::CanEverRender() == false)
+			{
+				TArray<FColor> Pixels;
+				if (Private::ReadRenderTarget_CPU)
 				{
-					const TArrayView64<FLinearColor> RawData = Image.AsRGBA32F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 3);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
+					if (Private::ReadRenderTarget_CPU(RT, Pixels) == false || Pixels.Num() != SrcSize.X * SrcSize.Y)
 					{
-						Data[Idx * 3] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 3 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
+						return;
 					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
 				}
-				break;
-			case ETextureFormat::RGBA8:
+				else
 				{
-					const TArrayView64<FLinearColor> RawData = Image.AsRGBA32F();
-					TArray<uint8> Data;
-					Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight() * 4);
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx * 4] = RawData[Idx].R * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 1] = RawData[Idx].G * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 2] = RawData[Idx].B * TNumericLimits<uint8>::Max();
-						Data[Idx * 4 + 3] = RawData[Idx].A * TNumericLimits<uint8>::Max();
-					}
-					UpdateTextureDataToWS(Handle, TextureFormat, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+					Pixels.Init(RT->ClearColor.ToFColor(true), SrcSize.X * SrcSize.Y);
 				}
-				break;
-			}
-			break;
-		case ERawImageFormat::G16:
-			{
-				const TArrayView64<uint16> RawData = Image.AsG16();
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-				for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
+				TArray<uint8> Converted;
+				if (ConvertImage(PF_B8G8R8A8, reinterpret_cast<const uint8*>(Pixels.GetData()), SrcSize.X * sizeof(FColor), SrcSize, Stream.Format, DstSize, Converted))
 				{
-					Data[Idx] = RawData[Idx] / (float)TNumericLimits<uint16>::Max() * TNumericLimits<uint8>::Max();
+					FReadback& Readback = *Stream.Readback;
+					FScopeLock ScopeLock{ &Readback.CompletedLock };
+					Readback.Completed = MoveTemp(Converted);
+					Readback.CompletedSize = DstSize;
+					Readback.bHasCompleted = true;
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+				return;
 			}
-			break;
-		case ERawImageFormat::R16F:
+
+			const FTextureResource* Resource = RT->GetResource();
+			if (Resource == nullptr)
 			{
-				const TArrayView64<FFloat16> RawData = Image.AsR16F();
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-				for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
-				{
-					Data[Idx] = RawData[Idx] * TNumericLimits<uint8>::Max();
-				}
-				UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Data.GetData());
+				return;
 			}
-			break;
-		case ERawImageFormat::R32F:
+			Stream.Readback->bInFlight = true;
+			ENQUEUE_RENDER_COMMAND(ImGuiRenderTargetStreamCopy)(
+				[Readback = Stream.Readback, Resource, PixelFormat = RT->GetFormat(), Format = Stream.Format, SrcSize, DstSize](FRHICommandListImmediate& RHICmdList)
+				{
+					Readback->PixelFormat = PixelFormat;
+					Readback->Format = Format;
+					Readback->SrcSize = SrcSize;
+					Readback->DstSize = DstSize;
+					Readback->GPUReadback.EnqueueCopy(RHICmdList, Resource->GetTexture2DRHI());
+				});
+		}
+
+		void Tick()
+		{
+			const double Now = FPlatformTime::Seconds();
+			for (auto It = Streams.CreateIterator(); It; ++It)
 			{
-				const TArrayView64<float> RawData = Image.AsR32F();
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(Image.GetWidth() * Image.GetHeight());
-				for (int32 Idx = 0; Idx < Data.Num(); ++Idx)
+				FStream& Stream = It->Value;
+				UTextureRenderTarget2D* RT = Stream.RenderTarget.Get();
+				if (RT == nullptr || Now - Stream.LastRefreshSeconds > KeepAliveSeconds)
+				{
+					It.RemoveCurrent();
+					continue;
+				}
+
+				FReadback& Readback = *Stream.Readback;
+				{
+					FScopeLock ScopeLock{ &Readback.CompletedLock };
+					if (Readback.bHasCompleted)
+					{
+						Readback.bHasCompleted = false;
+						UpdateTextureDataToWS(Stream.Handle, Stream.Format, Readback.CompletedSize.X, Readback.CompletedSize.Y, Readback.Completed.GetData());
+					}
+				}
+
+				if (Readback.bInFlight)
+				{
+					// polled once a frame, the render thread never waits for the GPU
+					ENQUEUE_RENDER_COMMAND(ImGuiRenderTargetStreamPoll)(
+						[ReadbackRef = Stream.Readback](FRHICommandListImmediate& RHICmdList)
+						{
+							if (ReadbackRef->bInFlight && ResolveReadback(*ReadbackRef))
+							{
+								ReadbackRef->bInFlight = false;
+							}
+						});
+				}
+				else if (Now >= Stream.NextReadbackSeconds)
 				{
-					Data[Idx] = RawData[Idx] * TNumericLimits<uint8>::Max();
+					Stream.NextReadbackSeconds = Now + 1.0 / FMath::Max(Stream.Settings.FramesPerSecond, 0.1f);
+					EnqueueReadback(Stream, RT);
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat == ETextureFormat::Alpha8 ? TextureFormat : ETextureFormat::Gray8, Image.GetWidth(), Image.GetHeight(), Data.GetData());
 			}
-			break;
-		default:
-			ensure(false);
-			return;
 		}
 	}
 
-	void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D)
+	void StreamRenderTarget(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D, const FRenderTargetStreamSettings& Settings)
 	{
-		if (RenderTarget2D == nullptr)
+		if (RenderTarget2D == nullptr || Handle.IsValid() == false || !Private::UpdateTextureData_WS)
 		{
 			return;
 		}
 
-		FTextureRenderTarget2DResource* RTResource = static_cast<FTextureRenderTarget2DResource*>(RenderTarget2D->GameThread_GetRenderTargetResource());
-		if (!ensure(RTResource))
+		using namespace RenderTargetStream;
+		if (EndFrameHandle.IsValid() == false)
 		{
-			return;
+			EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&Tick);
 		}
-		TArray<FColor> RawData;
-		if (!ensure(RTResource->ReadPixels(RawData, {}, FIntRect{ 0, 0, RenderTarget2D->SizeX, RenderTarget2D->SizeY })))
+		// single channel targets stay single channel
+		if (GPixelFormats[RenderTarget2D->GetFormat()].NumComponents == 1 && TextureFormat != ETextureFormat::Alpha8)
 		{
-			return;
+			TextureFormat = ETextureFormat::Gray8;
 		}
 
-		const ETextureRenderTargetFormat Format = RenderTarget2D->RenderTargetFormat;
-		const bool bSingleChannel = Format == RTF_R8 || Format == RTF_R16f || Format == RTF_R32f;
-		if (bSingleChannel && TextureFormat != ETextureFormat::Alpha8)
+		FStream& Stream = Streams.FindOrAdd(Handle);
+		if (Stream.RenderTarget != RenderTarget2D || Stream.Format != TextureFormat)
 		{
-			TextureFormat = ETextureFormat::Gray8;
+			Stream.RenderTarget = RenderTarget2D;
+			Stream.Format = TextureFormat;
+			Stream.NextReadbackSeconds = 0.0;
 		}
+		Stream.Handle = Handle;
+		Stream.Settings = Settings;
+		Stream.LastRefreshSeconds = FPlatformTime::Seconds();
+	}
 
-		switch (TextureFormat)
+	// drops everything kept for garbage collected textures
+	void RemoveStaleTextures()
+	{
+		using namespace TextureIdManager;
+		for (auto It = IdTextureMap.CreateIterator(); It; ++It)
 		{
-		case ETextureFormat::Alpha8:
-		case ETextureFormat::Gray8:
+			if (It->Value.IsStale())
 			{
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(RenderTarget2D->SizeX * RenderTarget2D->SizeY);
-				if (bSingleChannel)
+				HandleIdMap.Remove(It->Value);
+				IdFormatMap.Remove(It->Key);
+				if (Private::RemoveTextureData_WS)
 				{
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx] = RawData[Idx].R;
-					}
-				}
-				else
-				{
-					for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
-					{
-						Data[Idx] = RawData[Idx].A;
-					}
+					Private::RemoveTextureData_WS(It->Key);
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
+				It.RemoveCurrent();
 			}
-			break;
-		case ETextureFormat::RGB8:
+		}
+
+		for (auto It = TexturePayloadCache::Payloads.CreateIterator(); It; ++It)
+		{
+			if (It->Key.Texture.ResolveObjectPtr() == nullptr)
 			{
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(RenderTarget2D->SizeX * RenderTarget2D->SizeY * 3);
-				for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
+				TexturePayloadCache::TotalBytes -= It->Value.Data.Num();
+				It.RemoveCurrent();
+			}
+		}
+		// the rects of collected images are reused, emptied pages are released
+		for (auto It = TextureAtlas::Entries.CreateIterator(); It; ++It)
+		{
+			if (It->Key.Key.ResolveObjectPtr() == nullptr)
+			{
+				if (It->Value.Page != INDEX_NONE)
 				{
-					Data[Idx * 3] = RawData[Idx].R;
-					Data[Idx * 3 + 1] = RawData[Idx].G;
-					Data[Idx * 3 + 2] = RawData[Idx].B;
+					TextureAtlas::ReleaseRect(It->Value.Page, It->Value.Rect);
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
+				It.RemoveCurrent();
 			}
-			break;
-		case ETextureFormat::RGBA8:
+		}
+	}
+
+	bool RestoreTextureData(uint32 ImTextureId)
+	{
+		if (RenderTargetStream::FStream* Stream = RenderTargetStream::Streams.Find(ImTextureId))
+		{
+			Stream->NextReadbackSeconds = 0.0;
+			return true;
+		}
+		for (const TUniquePtr<TextureAtlas::FPage>& Page : TextureAtlas::Pages)
+		{
+			if (Page && Page->Handle == ImTextureId)
+			{
+				Page->bDirty = true;
+				return true;
+			}
+		}
+
+		const ETextureFormat* TextureFormat = TextureIdManager::IdFormatMap.Find(ImTextureId);
+		const UTexture* Texture = FindTexture(ImTextureId);
+		if (TextureFormat == nullptr || Texture == nullptr)
+		{
+			return false;
+		}
+		const FImGuiTextureHandle Handle{ Texture };
+		if (UTexture2D* Texture2D = Cast<UTexture2D>(const_cast<UTexture*>(Texture)))
+		{
+			UpdateTextureData(Handle, *TextureFormat, Texture2D);
+			return true;
+		}
+		if (UTextureRenderTarget2D* RT = Cast<UTextureRenderTarget2D>(const_cast<UTexture*>(Texture)))
+		{
+			UpdateTextureData(Handle, *TextureFormat, RT);
+			return true;
+		}
+		return false;
+	}
+
+	FImGuiTextureHandle FindOrAddTexture(ETextureFormat TextureFormat, UTexture* Texture, FVector2D& InOutUV0, FVector2D& InOutUV1)
+	{
+		// wrapping uvs only work on a texture of its own
+		const FBox2D UnitRect{ FVector2D::ZeroVector, FVector2D::UnitVector };
+		if (CVar_ImGui_TextureAtlas.GetValueOnGameThread() && UnitRect.IsInsideOrOn(InOutUV0) && UnitRect.IsInsideOrOn(InOutUV1))
+		{
+			if (UTexture2D* Texture2D = Cast<UTexture2D>(Texture))
 			{
-				TArray<uint8> Data;
-				Data.SetNumUninitialized(RenderTarget2D->SizeX * RenderTarget2D->SizeY * 4);
-				for (int32 Idx = 0; Idx < RawData.Num(); ++Idx)
+				if (const TextureAtlas::FEntry* Entry = TextureAtlas::FindOrAdd(TextureFormat, Texture2D))
 				{
-					Data[Idx * 4] = RawData[Idx].R;
-					Data[Idx * 4 + 1] = RawData[Idx].G;
-					Data[Idx * 4 + 2] = RawData[Idx].B;
-					Data[Idx * 4 + 3] = RawData[Idx].A;
+					InOutUV0 = Entry->UVMin + InOutUV0 * (Entry->UVMax - Entry->UVMin);
+					InOutUV1 = Entry->UVMin + InOutUV1 * (Entry->UVMax - Entry->UVMin);
+					return TextureAtlas::Pages[Entry->Page]->Handle;
 				}
-				UpdateTextureDataToWS(Handle, TextureFormat, RenderTarget2D->SizeX, RenderTarget2D->SizeY, Data.GetData());
 			}
-			break;
-		default:
-			ensure(false);
 		}
+		return FindOrAddTexture(TextureFormat, Texture);
 	}
 
 	FImGuiTextureHandle FindOrAddTexture(ETextureFormat TextureFormat, UTexture* Texture)
@@ -526,6 +1021,10 @@ FImGuiTextureHandle FImGuiTextureHandle::FindOrCreateHandle(const UTexture* Text
 		HandleIdCounter += 1;
 		Id = HandleIdCounter;
 		IdTextureMap.Add(Id, Texture);
+		if (PostGarbageCollectHandle.IsValid() == false)
+		{
+			PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddStatic(&UnrealImGui::RemoveStaleTextures);
+		}
 	}
 	return FImGuiTextureHandle{ Id };
 }
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "UnrealImGuiTexture.h"
+#include "Misc/App.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/ScopeExit.h"
+#include "Engine/TextureRenderTarget2D.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FUnrealImGuiRenderTargetStreamCPUTest, "ImGui.Texture.RenderTargetStreamCPU", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FUnrealImGuiRenderTargetStreamCPUTest::RunTest(const FString& Parameters)
+{
+	using namespace UnrealImGui;
+
+	// the CPU stand in is only used where nothing reaches the GPU
+	if (FApp::CanEverRender())
+	{
+		AddInfo(TEXT("Skipped, run with -nullrhi to cover the CPU readback"));
+		return true;
+	}
+
+	constexpr int32 SrcWidth = 64;
+	constexpr int32 SrcHeight = 32;
+	constexpr int32 MaxSize = 16;
+	const auto SrcColor = [](int32 X, int32 Y) { return FColor(static_cast<uint8>(X * 4), static_cast<uint8>(Y * 8), 100, 200); };
+
+	UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>(GetTransientPackage());
+	RT->InitCustomFormat(SrcWidth, SrcHeight, PF_B8G8R8A8, false);
+	const FImGuiTextureHandle Handle = FImGuiTextureHandle::MakeUnique();
+
+	struct FUpdate
+	{
+		uint32 ImTextureId;
+		ETextureFormat Format;
+		int32 Width;
+		int32 Height;
+		TArray<uint8> Data;
+	};
+	TArray<FUpdate> Updates;
+
+	Private::FUpdateTextureData_WS PrevUpdateTextureData = MoveTemp(Private::UpdateTextureData_WS);
+	Private::FReadRenderTarget_CPU PrevReadRenderTarget = MoveTemp(Private::ReadRenderTarget_CPU);
+	ON_SCOPE_EXIT
+	{
+		Private::UpdateTextureData_WS = MoveTemp(PrevUpdateTextureData);
+		Private::ReadRenderTarget_CPU = MoveTemp(PrevReadRenderTarget);
+	};
+
+	Private::UpdateTextureData_WS = [&Updates](FImGuiTextureHandle UpdateHandle, ETextureFormat Format, int32 Width, int32 Height, const uint8* Data)
+	{
+		const int32 NumBytes = Width * Height * (Format == ETextureFormat::RGBA8 ? 4 : Format == ETextureFormat::RGB8 ? 3 : 1);
+		Updates.Add({ UpdateHandle, Format, Width, Height, TArray<uint8>{ Data, NumBytes } });
+	};
+	Private::ReadRenderTarget_CPU = [&](UTextureRenderTarget2D* ReadRT, TArray<FColor>& OutPixels)
+	{
+		if (ReadRT != RT)
+		{
+			return false;
+		}
+		OutPixels.SetNumUninitialized(SrcWidth * SrcHeight);
+		for (int32 Y = 0; Y < SrcHeight; ++Y)
+		{
+			for (int32 X = 0; X < SrcWidth; ++X)
+			{
+				OutPixels[Y * SrcWidth + X] = SrcColor(X, Y);
+			}
+		}
+		return true;
+	};
+
+	FRenderTargetStreamSettings Settings;
+	Settings.MaxSize = MaxSize;
+	StreamRenderTarget(Handle, ETextureFormat::RGB8, RT, Settings);
+
+	// the first tick reads the target back, the next one sends it
+	FCoreDelegates::OnEndFrame.Broadcast();
+	FCoreDelegates::OnEndFrame.Broadcast();
+
+	if (TestEqual(TEXT("Number of updates"), Updates.Num(), 1) == false)
+	{
+		return false;
+	}
+	const FUpdate& Update = Updates[0];
+	TestEqual(TEXT("Texture id"), Update.ImTextureId, uint32(Handle));
+	TestTrue(TEXT("Format is RGB8"), Update.Format == ETextureFormat::RGB8);
+	TestEqual(TEXT("Width"), Update.Width, MaxSize);
+	TestEqual(TEXT("Height"), Update.Height, MaxSize * SrcHeight / SrcWidth);
+	for (int32 Y = 0; Y < Update.Height; ++Y)
+	{
+		for (int32 X = 0; X < Update.Width; ++X)
+		{
+			// nearest sampled from the source
+			const FColor Expected = SrcColor(X * SrcWidth / Update.Width, Y * SrcHeight / Update.Height);
+			const uint8* Pixel = Update.Data.GetData() + (Y * Update.Width + X) * 3;
+			if (Pixel[0] != Expected.R || Pixel[1] != Expected.G || Pixel[2] != Expected.B)
+			{
+				AddError(FString::Printf(TEXT("Pixel %d, %d is %d %d %d, expected %s"), X, Y, Pixel[0], Pixel[1], Pixel[2], *Expected.ToString()));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+#endif
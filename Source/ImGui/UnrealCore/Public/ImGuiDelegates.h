@@ -18,4 +18,12 @@ struct IMGUI_API FImGuiDelegates
 	static FOnImGuiLocalPanelEnable OnImGuiLocalPanelEnable;
 	DECLARE_MULTICAST_DELEGATE(FOnImGuiLocalPanelDisable);
 	static FOnImGuiLocalPanelDisable OnImGuiLocalPanelDisable;
+
+	// broadcast by panels whose content changed without any input, so event driven viewers redraw
+	DECLARE_MULTICAST_DELEGATE(FOnImGuiRequestRedraw);
+	static FOnImGuiRequestRedraw OnImGuiRequestRedraw;
+
+	// broadcast on the game thread after glyphs were baked into the default font atlas, its texture may have grown
+	DECLARE_MULTICAST_DELEGATE(FOnImGuiFontAtlasChanged);
+	static FOnImGuiFontAtlasChanged OnImGuiFontAtlasChanged;
 };
@@ -10,4 +10,10 @@ namespace UnrealImGui
 {
 	IMGUI_API ImFontAtlas& GetDefaultFontAtlas();
 	constexpr uint32 FontTextId = 0;
+
+	// the glyphs of the default font atlas store signed distances instead of coverage, renderers resolve them at the drawn scale
+	// a value of FontSdfOnEdge lies on the outline and FontSdfSpread pixels away from it reaches 0 or 255
+	IMGUI_API bool IsSignedDistanceFieldFont();
+	constexpr uint8 FontSdfOnEdge = 128;
+	constexpr int32 FontSdfSpread = 4;
 }
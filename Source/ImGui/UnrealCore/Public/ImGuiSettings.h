@@ -66,6 +66,13 @@ public:
 
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	EImGuiFontGlyphRanges FontGlyphRanges = EImGuiFontGlyphRanges::ChineseFull;
+	// only the default range is built at startup, glyphs of the other ranges are rasterized into the atlas when first drawn
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
+	bool bBakeGlyphsOnDemand = true;
+
+	// font atlas of signed distance fields, text stays sharp at any scale the WS clients draw it
+	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
+	bool bSignedDistanceFieldFont = false;
 
 	UPROPERTY(EditAnywhere, Config, Category = "ImGui WS", meta = (ConfigRestartRequired = true))
 	float ServerTickInterval = 1 / 120.f;
@@ -698,6 +698,11 @@ public:
 	{
 		UnrealImGui::UpdateTextureData(Handle, (UnrealImGui::ETextureFormat)TextureFormat, RenderTarget2D);
 	}
+	UFUNCTION(BlueprintCallable, Category="ImGui|Widgets|Texture", meta = (ImGuiFunction, TextureFormat = RGB8, AdvancedDisplay = 3), BlueprintInternalUseOnly)
+	static void StreamTextureRenderTarget2D(const FImGuiTextureHandle& Handle, EImGuiTextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D, float FramesPerSecond = 10.f, int32 MaxSize = 512)
+	{
+		UnrealImGui::StreamRenderTarget(Handle, (UnrealImGui::ETextureFormat)TextureFormat, RenderTarget2D, { FramesPerSecond, MaxSize });
+	}
 	UFUNCTION(BlueprintCallable, Category="ImGui|Widgets|Texture", meta = (ImGuiFunction, DefaultToSelf = Outer, AdvancedDisplay = 4, TextureFormat = Gray8, Width = 128, Height = 128), BlueprintInternalUseOnly)
 	static UTextureRenderTarget2D* CreatePersistentTexture(UPARAM(Ref)FImGuiTextureHandle& Handle, EImGuiTextureFormat TextureFormat, int32 Width, int32 Height, UObject* Outer, FName Name)
 	{
@@ -725,14 +730,14 @@ public:
 	static void Image(UTexture* Texture, FVector2D ImageSize, EImGuiTextureFormat Format = EImGuiTextureFormat::RGB8, FVector2D UV0 = FVector2D::ZeroVector, FVector2D UV1 = FVector2D::UnitVector, FLinearColor TintColor = FLinearColor::White, FLinearColor BorderColor = FLinearColor::Transparent)
 	{
 		if (!CheckImGuiContextThrowError()) { return; }
-		const FImGuiTextureHandle Handle = UnrealImGui::FindOrAddTexture((UnrealImGui::ETextureFormat)Format, Texture);
+		const FImGuiTextureHandle Handle = UnrealImGui::FindOrAddTexture((UnrealImGui::ETextureFormat)Format, Texture, UV0, UV1);
 		ImGui::Image(Handle, ImVec2{ ImageSize }, ImVec2{ UV0 }, ImVec2{ UV1 }, ImVec4{ TintColor }, ImVec4{ BorderColor });
 	}
 	UFUNCTION(BlueprintCallable, Category="ImGui|Widgets|Images", meta = (ImGuiTrigger, AdvancedDisplay = 3), BlueprintInternalUseOnly)
 	static bool ImageButton(FText Label, UTexture* Texture, FVector2D ImageSize, EImGuiTextureFormat Format = EImGuiTextureFormat::RGB8, FVector2D UV0 = FVector2D::ZeroVector, FVector2D UV1 = FVector2D::UnitVector, FLinearColor TintColor = FLinearColor::White, FLinearColor BorderColor = FLinearColor::Transparent)
 	{
 		if (!CheckImGuiContextThrowError()) { return false; }
-		const FImGuiTextureHandle Handle = UnrealImGui::FindOrAddTexture((UnrealImGui::ETextureFormat)Format, Texture);
+		const FImGuiTextureHandle Handle = UnrealImGui::FindOrAddTexture((UnrealImGui::ETextureFormat)Format, Texture, UV0, UV1);
 		return ImGui::ImageButton(TCHAR_TO_UTF8(*Label.ToString()), Handle, ImVec2{ ImageSize }, ImVec2{ UV0 }, ImVec2{ UV1 }, ImVec4{ TintColor }, ImVec4{ BorderColor });
 	}
 
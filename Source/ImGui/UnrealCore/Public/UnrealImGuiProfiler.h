@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+namespace UnrealImGui
+{
+	// rolling histories of the ImGui pipeline stages, samples can be added from any thread
+	// nothing is collected while the profiler is disabled
+	namespace Profiler
+	{
+		enum class EGroup : uint8
+		{
+			GameThread,
+			Panels,
+			WSThread,
+			// bytes sent per client
+			Clients,
+			Num
+		};
+
+		IMGUI_API bool IsEnabled();
+		IMGUI_API void SetEnabled(bool bEnable);
+
+		// milliseconds for the timing groups, bytes for EGroup::Clients
+		IMGUI_API void AddSample(EGroup Group, FName Track, double Value);
+
+		struct FScope
+		{
+			FScope(EGroup InGroup, const TCHAR* InTrack)
+				: FScope(InGroup, IsEnabled() ? FName{ InTrack } : NAME_None)
+			{}
+			FScope(EGroup InGroup, FName InTrack)
+				: Group(InGroup)
+				, Track(IsEnabled() ? InTrack : NAME_None)
+				, StartSeconds(Track.IsNone() ? 0.0 : FPlatformTime::Seconds())
+			{}
+			~FScope()
+			{
+				if (Track.IsNone() == false)
+				{
+					AddSample(Group, Track, (FPlatformTime::Seconds() - StartSeconds) * 1000.0);
+				}
+			}
+		private:
+			EGroup Group;
+			FName Track;
+			double StartSeconds;
+		};
+
+		// draws the profiler window, the profiler is enabled while it is open
+		IMGUI_API void DrawWindow(bool* bOpen);
+	}
+}
@@ -52,12 +52,34 @@ namespace UnrealImGui
 	IMGUI_API void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTexture2D* Texture2D);
 	IMGUI_API void UpdateTextureData(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D);
 
+	struct FRenderTargetStreamSettings
+	{
+		// readbacks per second, a frame is skipped while the previous readback is in flight
+		float FramesPerSecond = 10.f;
+		// the longer side is scaled down to it, 0 keeps the render target size
+		int32 MaxSize = 512;
+	};
+	// sends a GPU render target to the web clients with non-blocking readbacks, the clients show the last completed one
+	// call it every frame the texture is shown, streams not refreshed for a second stop
+	IMGUI_API void StreamRenderTarget(FImGuiTextureHandle Handle, ETextureFormat TextureFormat, UTextureRenderTarget2D* RenderTarget2D, const FRenderTargetStreamSettings& Settings = {});
+
 	IMGUI_API FImGuiTextureHandle FindOrAddTexture(ETextureFormat TextureFormat, UTexture* Texture);
+	// with ImGui.TextureAtlas small UTexture2D are packed into shared pages, the handle is the page and the uvs are moved into it
+	IMGUI_API FImGuiTextureHandle FindOrAddTexture(ETextureFormat TextureFormat, UTexture* Texture, FVector2D& InOutUV0, FVector2D& InOutUV1);
 	IMGUI_API const UTexture* FindTexture(uint32 ImTextureId);
+	// uploads the texture of the id to the web clients again after it was evicted, false when nothing backs the id
+	IMGUI_API bool RestoreTextureData(uint32 ImTextureId);
 
 	namespace Private
 	{
 		using FUpdateTextureData_WS = TFunction<void(FImGuiTextureHandle, ETextureFormat, int32, int32, const uint8*)>;
 		IMGUI_API extern FUpdateTextureData_WS UpdateTextureData_WS;
+		// called after the texture of the id was garbage collected
+		using FRemoveTextureData_WS = TFunction<void(uint32)>;
+		IMGUI_API extern FRemoveTextureData_WS RemoveTextureData_WS;
+		// stands in for the GPU readback of streamed render targets where nothing is rendered, e.g. NullRHI
+		// unset streams show the clear color of the render target there
+		using FReadRenderTarget_CPU = TFunction<bool(UTextureRenderTarget2D*, TArray<FColor>&)>;
+		IMGUI_API extern FReadRenderTarget_CPU ReadRenderTarget_CPU;
 	}
 }
@@ -234,6 +234,14 @@ namespace ImGui
 		notifications.erase(notifications.begin() + index);
 	}
 
+	/// <summary>
+	/// Whether any toast is still shown or fading
+	/// </summary>
+	bool HasNotifications()
+	{
+		return notifications.empty() == false;
+	}
+
 	/// <summary>
 	/// Render toasts, call at the end of your rendering!
 	/// </summary>
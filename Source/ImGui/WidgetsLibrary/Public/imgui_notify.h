@@ -18,6 +18,7 @@ namespace ImGui
 {
 	IMGUI_API void MergeIconsWithLatestFont(ImFontAtlas& FontAtlas, float font_size, bool FontDataOwnedByAtlas = false);
 	IMGUI_API void RenderNotifications();
+	IMGUI_API bool HasNotifications();
 
 	IMGUI_API void InsertNotification(ImGuiToastType type, const char* format, ...);
 	IMGUI_API void InsertNotification(ImGuiToastType type, float dismiss_seconds, const char* format, ...);
@@ -46,31 +46,153 @@ private:
 };
 }
 
-FImGuiDrawList::FImGuiDrawList(ImDrawList* Source)
+namespace FontAtlasTexture
 {
-	VtxBuffer.swap(Source->VtxBuffer);
-	IdxBuffer.swap(Source->IdxBuffer);
-	CmdBuffer.swap(Source->CmdBuffer);
-	Flags = Source->Flags;
-}
+	UTextureRenderTarget2D* Texture = nullptr;
+	// set when glyphs were baked into the atlas, the texture is uploaded again and follows its size
+	bool bDirty = true;
+
+	const UTextureRenderTarget2D* Get(const ImFontAtlas& FontAtlas)
+	{
+		if (Texture == nullptr)
+		{
+			Texture = NewObject<UTextureRenderTarget2D>((UObject*)GetTransientPackage(), TEXT("ImGuiFontAtlas"));
+			check(Texture);
+			Texture->RenderTargetFormat = RTF_RGBA8;
+			Texture->ClearColor = FLinearColor::Black;
+			Texture->bAutoGenerateMips = false;
+			Texture->LODGroup = TEXTUREGROUP_Pixels2D;
+			Texture->AddToRoot();
+			FImGuiDelegates::OnImGuiFontAtlasChanged.AddLambda([]
+			{
+				bDirty = true;
+			});
+		}
+		if (bDirty == false)
+		{
+			return Texture;
+		}
+		bDirty = false;
+
+		const int32 SizeX = FontAtlas.TexWidth;
+		const int32 SizeY = FontAtlas.TexHeight;
+		if (Texture->SizeX != SizeX || Texture->SizeY != SizeY)
+		{
+			Texture->InitAutoFormat(SizeX, SizeY);
+			Texture->UpdateResourceImmediate(false);
+		}
+
+		ENQUEUE_RENDER_COMMAND(ImGuiFontAtlas)(
+			[TextureDataRaw = TArray<uint8>{ FontAtlas.TexPixelsAlpha8, SizeX * SizeY }, SizeX, SizeY,
+			bSignedDistanceField = UnrealImGui::IsSignedDistanceFieldFont(),
+			RenderTargetPtr = TWeakObjectPtr<UTextureRenderTarget2D>(Texture)]
+			(FRHICommandListImmediate& RHICmdList)
+			{
+				UTextureRenderTarget2D* RT = RenderTargetPtr.Get();
+				if (!RT)
+				{
+					return;
+				}
+				const FTextureResource* RenderTargetResource = RT->GetResource();
+				if (RenderTargetResource == nullptr)
+				{
+					return;
+				}
+
+				// the slate shader samples coverage, distance fields are resolved for glyphs drawn at the atlas size
+				uint8 Alpha[256];
+				for (int32 Value = 0; Value < 256; ++Value)
+				{
+					const float Distance = (Value - UnrealImGui::FontSdfOnEdge) * (float)UnrealImGui::FontSdfSpread / UnrealImGui::FontSdfOnEdge;
+					Alpha[Value] = bSignedDistanceField ? (uint8)FMath::Clamp((Distance + 0.5f) * 255.f, 0.f, 255.f) : (uint8)Value;
+				}
 
-SImGuiPanel::FImGuiDrawData::FImGuiDrawData() {}
+				TArray<uint8> FontAtlasTextureData;
+				FontAtlasTextureData.SetNumUninitialized(TextureDataRaw.Num() * 4);
+				{
+					const uint8* Src = TextureDataRaw.GetData();
+					uint32* Dst = reinterpret_cast<uint32*>(FontAtlasTextureData.GetData());
+					for (int32 Idx = TextureDataRaw.Num(); Idx > 0; --Idx)
+					{
+						*Dst++ = IM_COL32(255, 255, 255, Alpha[*Src++]);
+					}
+				}
 
-SImGuiPanel::FImGuiDrawData::~FImGuiDrawData() {}
+				constexpr uint32 SrcBpp = sizeof(uint32);
+				const uint32 SrcPitch = SizeX * SrcBpp;
+				FRHITexture2D* RHITexture = RenderTargetResource->GetTexture2DRHI();
+				const FUpdateTextureRegion2D Region{ 0, 0, 0, 0, uint32(SizeX), uint32(SizeY) };
+				RHIUpdateTexture2D(
+					RHITexture,
+					0,
+					Region,
+					SrcPitch,
+					FontAtlasTextureData.GetData());
+			});
+
+		return Texture;
+	}
+}
 
-SImGuiPanel::FImGuiDrawData::FImGuiDrawData(const ImDrawData* Source)
+void SImGuiPanel::FImGuiDrawData::Update(const ImDrawData* Source, const FVector2f& InTranslation)
 {
 	bValid = Source->Valid;
+	Translation = InTranslation;
+	NumBatches = 0;
+
+	const FSlateRenderTransform Transform(InTranslation - FVector2f{ Source->DisplayPos });
+	FImGuiBatch* Batch = nullptr;
+	for (const ImDrawList* DrawList : Source->CmdLists)
+	{
+		for (const ImDrawCmd& DrawCmd : DrawList->CmdBuffer)
+		{
+			if (DrawCmd.UserCallback || DrawCmd.ElemCount == 0)
+			{
+				continue;
+			}
 
-	TotalIdxCount = Source->TotalIdxCount;
-	TotalVtxCount = Source->TotalVtxCount;
+			const ImDrawIdx* CmdIndices = DrawList->IdxBuffer.Data + DrawCmd.IdxOffset;
+			uint32 MinIndex = MAX_uint32;
+			uint32 MaxIndex = 0;
+			for (uint32 Idx = 0; Idx < DrawCmd.ElemCount; ++Idx)
+			{
+				MinIndex = FMath::Min<uint32>(MinIndex, CmdIndices[Idx]);
+				MaxIndex = FMath::Max<uint32>(MaxIndex, CmdIndices[Idx]);
+			}
+			const int32 NumVertices = MaxIndex - MinIndex + 1;
+
+			const FSlateRect ClipRect = TransformRect(Transform, FSlateRect(DrawCmd.ClipRect.x, DrawCmd.ClipRect.y, DrawCmd.ClipRect.z, DrawCmd.ClipRect.w));
+			if (Batch == nullptr || Batch->TextureId != DrawCmd.GetTexID() || Batch->ClipRect != ClipRect
+				|| (int64)Batch->Vertices.Num() + NumVertices > TNumericLimits<SlateIndex>::Max())
+			{
+				if (NumBatches == Batches.Num())
+				{
+					Batches.AddDefaulted();
+				}
+				Batch = &Batches[NumBatches++];
+				Batch->TextureId = DrawCmd.GetTexID();
+				Batch->ClipRect = ClipRect;
+				Batch->Vertices.Reset();
+				Batch->Indices.Reset();
+			}
 
-	DrawLists.SetNumUninitialized(Source->CmdListsCount);
-	ConstructItems<FImGuiDrawList>(DrawLists.GetData(), Source->CmdLists.Data, Source->CmdListsCount);
+			const int32 FirstVertex = Batch->Vertices.Num();
+			Batch->Vertices.AddUninitialized(NumVertices);
+			const ImDrawVert* CmdVertices = DrawList->VtxBuffer.Data + DrawCmd.VtxOffset + MinIndex;
+			for (int32 Idx = 0; Idx < NumVertices; ++Idx)
+			{
+				const ImDrawVert& Vtx = CmdVertices[Idx];
+				Batch->Vertices[FirstVertex + Idx] = FSlateVertex::Make<ESlateVertexRounding::Disabled>(Transform, FVector2f{ Vtx.pos }, FVector2f{ Vtx.uv }, FVector2f::UnitVector, ImGui::ConvertColor(Vtx.col));
+			}
 
-	DisplayPos = FVector2f{ Source->DisplayPos };
-	DisplaySize = FVector2f{ Source->DisplaySize };
-	FrameBufferScale = FVector2f{ Source->FramebufferScale };
+			const int32 FirstIndex = Batch->Indices.Num();
+			Batch->Indices.AddUninitialized(DrawCmd.ElemCount);
+			for (uint32 Idx = 0; Idx < DrawCmd.ElemCount; ++Idx)
+			{
+				Batch->Indices[FirstIndex + Idx] = CmdIndices[Idx] - MinIndex + FirstVertex;
+			}
+		}
+	}
 }
 
 void SImGuiPanel::Construct(const FArguments& Args)
@@ -145,8 +267,7 @@ void SImGuiPanel::Tick(const FGeometry& AllottedGeometry, const double InCurrent
 
 	ImGui::Render();
 
-	const ImDrawData* Data = ImGui::GetDrawData();
-	DrawData = FImGuiDrawData{ Data };
+	DrawData.Update(ImGui::GetDrawData(), FVector2f{ AllottedGeometry.GetAccumulatedRenderTransform().GetTranslation() });
 
 	ImGui::EndFrame();
 }
@@ -158,139 +279,71 @@ int32 SImGuiPanel::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeom
 		return LayerId;
 	}
 
-	const FSlateRenderTransform Transform(AllottedGeometry.GetAccumulatedRenderTransform().GetTranslation() - FVector2d(DrawData.DisplayPos));
+	// a panel painted elsewhere than it ticked draws offset copies of the vertices
+	const FVector2f Offset = FVector2f{ AllottedGeometry.GetAccumulatedRenderTransform().GetTranslation() } - DrawData.Translation;
+	TArray<FSlateVertex> OffsetVertices;
 
 	FSlateBrush TextureBrush;
-	for (const FImGuiDrawList& DrawList : DrawData.DrawLists)
+	auto SetTexture = [&TextureBrush](const UTexture* Texture)
 	{
-		TArray<FSlateVertex> Vertices;
-		Vertices.SetNumUninitialized(DrawList.VtxBuffer.Size);
-		for (int32 BufferIdx = 0; BufferIdx < Vertices.Num(); ++BufferIdx)
-		{
-			const ImDrawVert& Vtx = DrawList.VtxBuffer.Data[BufferIdx];
-			Vertices[BufferIdx] = FSlateVertex::Make<ESlateVertexRounding::Disabled>(Transform, FVector2f{ Vtx.pos }, FVector2f{ Vtx.uv }, FVector2f::UnitVector, ImGui::ConvertColor(Vtx.col));
-		}
-
-		TArray<SlateIndex> Indices;
-		Indices.SetNumUninitialized(DrawList.IdxBuffer.Size);
-		for (int32 BufferIdx = 0; BufferIdx < Indices.Num(); ++BufferIdx)
-		{
-			Indices[BufferIdx] = DrawList.IdxBuffer.Data[BufferIdx];
-		}
-
-		for (const ImDrawCmd& DrawCmd : DrawList.CmdBuffer)
+		if (TextureBrush.GetResourceObject() != Texture)
 		{
-			TArray VerticesSlice(Vertices.GetData() + DrawCmd.VtxOffset, Vertices.Num() - DrawCmd.VtxOffset);
-			TArray IndicesSlice(Indices.GetData() + DrawCmd.IdxOffset, DrawCmd.ElemCount);
-
-			auto SetTexture = [&TextureBrush](const UTexture* Texture)
+			TextureBrush.SetResourceObject(const_cast<UTexture*>(Texture));
+			if (IsValid(Texture))
 			{
-				if (TextureBrush.GetResourceObject() != Texture)
+				if (const UTexture2D* Texture2D = Cast<UTexture2D>(Texture))
 				{
-					TextureBrush.SetResourceObject(const_cast<UTexture*>(Texture));
-					if (IsValid(Texture))
-					{
-						if (const UTexture2D* Texture2D = Cast<UTexture2D>(Texture))
-						{
-							TextureBrush.ImageSize.X = Texture2D->GetSizeX();
-							TextureBrush.ImageSize.Y = Texture2D->GetSizeY();
-						}
-						else if (const UTextureRenderTarget2D* RT = Cast<UTextureRenderTarget2D>(Texture))
-						{
-							TextureBrush.ImageSize.X = RT->SizeX;
-							TextureBrush.ImageSize.Y = RT->SizeY;
-						}
-						else
-						{
-							ensure(false);
-						}
-						TextureBrush.ImageType = ESlateBrushImageType::FullColor;
-						TextureBrush.DrawAs = ESlateBrushDrawType::Image;
-					}
-					else
-					{
-						TextureBrush.ImageSize.X = 0;
-						TextureBrush.ImageSize.Y = 0;
-						TextureBrush.ImageType = ESlateBrushImageType::NoImage;
-						TextureBrush.DrawAs = ESlateBrushDrawType::NoDrawType;
-					}
+					TextureBrush.ImageSize.X = Texture2D->GetSizeX();
+					TextureBrush.ImageSize.Y = Texture2D->GetSizeY();
 				}
-			};
-			if (DrawCmd.GetTexID() == UnrealImGui::FontTextId)
-			{
-				static const UTextureRenderTarget2D* FontAtlasTexture = [this]
+				else if (const UTextureRenderTarget2D* RT = Cast<UTextureRenderTarget2D>(Texture))
 				{
-					uint8* TextureDataRaw;
-					int32 SizeX, SizeY, BytesPerPixel;
-					Context->IO.Fonts->GetTexDataAsAlpha8(&TextureDataRaw, &SizeX, &SizeY, &BytesPerPixel);
-
-					UTextureRenderTarget2D* RT = NewObject<UTextureRenderTarget2D>((UObject*)GetTransientPackage(), TEXT("ImGuiFontAtlas"));
-					check(RT);
-					RT->RenderTargetFormat = RTF_RGBA8;
-					RT->ClearColor = FLinearColor::Black;
-					RT->bAutoGenerateMips = false;
-					RT->InitAutoFormat(SizeX, SizeY);
-					RT->LODGroup = TEXTUREGROUP_Pixels2D;
-					RT->UpdateResourceImmediate(false);
-
-					RT->AddToRoot();
-
-					ENQUEUE_RENDER_COMMAND(ImGuiFontAtlas)(
-						[TextureDataRaw = TArray<uint8>{ TextureDataRaw, SizeX * SizeY * BytesPerPixel },
-						RenderTargetPtr = TWeakObjectPtr<UTextureRenderTarget2D>(RT)]
-						(FRHICommandListImmediate& RHICmdList)
-						{
-							UTextureRenderTarget2D* RT = RenderTargetPtr.Get();
-							if (!RT)
-							{
-								return;
-							}
-							const FTextureResource* RenderTargetResource = RT->GetResource();
-							if (RenderTargetResource == nullptr)
-							{
-								return;
-							}
-
-							TArray<uint8> FontAtlasTextureData;
-							FontAtlasTextureData.SetNumUninitialized(TextureDataRaw.Num() * 4);
-							{
-								const uint8* Src = TextureDataRaw.GetData();
-								uint32* Dst = reinterpret_cast<uint32*>(FontAtlasTextureData.GetData());
-								for (int32 Idx = RT->SizeX * RT->SizeY; Idx > 0; --Idx)
-								{
-									*Dst++ = IM_COL32(255, 255, 255, *Src++);
-								}
-							}
-
-							constexpr uint32 SrcBpp = sizeof(uint32);
-							const uint32 SrcPitch = RT->SizeX * SrcBpp;
-							FRHITexture2D* Texture = RenderTargetResource->GetTexture2DRHI();
-							const FUpdateTextureRegion2D Region{ 0, 0, 0, 0, uint32(RT->SizeX), uint32(RT->SizeY) };
-							RHIUpdateTexture2D(
-								Texture,
-								0,
-								Region,
-								SrcPitch,
-								FontAtlasTextureData.GetData());
-						});
-
-					return RT;
-				}();
-				SetTexture(FontAtlasTexture);
+					TextureBrush.ImageSize.X = RT->SizeX;
+					TextureBrush.ImageSize.Y = RT->SizeY;
+				}
+				else
+				{
+					ensure(false);
+				}
+				TextureBrush.ImageType = ESlateBrushImageType::FullColor;
+				TextureBrush.DrawAs = ESlateBrushDrawType::Image;
 			}
 			else
 			{
-				const UTexture* Texture = UnrealImGui::FindTexture(DrawCmd.GetTexID());
-				SetTexture(Texture);
+				TextureBrush.ImageSize.X = 0;
+				TextureBrush.ImageSize.Y = 0;
+				TextureBrush.ImageType = ESlateBrushImageType::NoImage;
+				TextureBrush.DrawAs = ESlateBrushDrawType::NoDrawType;
 			}
+		}
+	};
+	for (int32 BatchIdx = 0; BatchIdx < DrawData.NumBatches; ++BatchIdx)
+	{
+		const FImGuiBatch& Batch = DrawData.Batches[BatchIdx];
+		if (Batch.TextureId == UnrealImGui::FontTextId)
+		{
+			SetTexture(FontAtlasTexture::Get(*Context->IO.Fonts));
+		}
+		else
+		{
+			const UTexture* Texture = UnrealImGui::FindTexture(Batch.TextureId);
+			SetTexture(Texture);
+		}
 
-			FSlateRect ClipRect(DrawCmd.ClipRect.x, DrawCmd.ClipRect.y, DrawCmd.ClipRect.z, DrawCmd.ClipRect.w);
-			ClipRect = TransformRect(Transform, ClipRect);
-
-			OutDrawElements.PushClip(FSlateClippingZone(ClipRect));
-			FSlateDrawElement::MakeCustomVerts(OutDrawElements, LayerId, TextureBrush.GetRenderingResource(), VerticesSlice, IndicesSlice, nullptr, 0, 0);
-			OutDrawElements.PopClip();
+		const TArray<FSlateVertex>* Vertices = &Batch.Vertices;
+		if (Offset.IsNearlyZero() == false)
+		{
+			OffsetVertices = Batch.Vertices;
+			for (FSlateVertex& Vertex : OffsetVertices)
+			{
+				Vertex.Position += Offset;
+			}
+			Vertices = &OffsetVertices;
 		}
+
+		OutDrawElements.PushClip(FSlateClippingZone(Batch.ClipRect.OffsetBy(Offset)));
+		FSlateDrawElement::MakeCustomVerts(OutDrawElements, LayerId, TextureBrush.GetRenderingResource(), *Vertices, Batch.Indices, nullptr, 0, 0);
+		OutDrawElements.PopClip();
 	}
 
 	return LayerId;
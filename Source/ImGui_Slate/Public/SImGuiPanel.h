@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "imgui.h"
 #include "GenericPlatform/ITextInputMethodSystem.h"
+#include "Rendering/RenderingCommon.h"
 #include "Widgets/SLeafWidget.h"
 #include "Widgets/Input/IVirtualKeyboardEntry.h"
 
@@ -12,17 +13,6 @@ struct ImPlotContext;
 struct ImGuiContext;
 struct ImDrawData;
 
-struct FImGuiDrawList
-{
-	FImGuiDrawList() = default;
-	explicit FImGuiDrawList(ImDrawList* Source);
-
-	ImVector<ImDrawVert> VtxBuffer;
-	ImVector<ImDrawIdx> IdxBuffer;
-	ImVector<ImDrawCmd> CmdBuffer;
-	ImDrawListFlags Flags = ImDrawListFlags_None;
-};
-
 class IMGUI_SLATE_API SImGuiPanel : public SLeafWidget, public IVirtualKeyboardEntry, public ITextInputMethodContext
 {
 	using Super = SLeafWidget;
@@ -88,22 +78,25 @@ private:
 	FOnImGuiTick OnImGuiTick;
 	TAttribute<FVector2D> DesiredSize;
 
+	// consecutive draw commands with the same texture and clip rect, holding only the vertices they index
+	struct FImGuiBatch
+	{
+		ImTextureID TextureId = 0;
+		FSlateRect ClipRect;
+		TArray<FSlateVertex> Vertices;
+		TArray<SlateIndex> Indices;
+	};
+	// slate vertices of the last imgui frame, converted once per tick and drawn by every paint
+	// the batches are kept between frames so their buffers are reused
 	struct IMGUI_SLATE_API FImGuiDrawData
 	{
-		FImGuiDrawData();
-		~FImGuiDrawData();
-		explicit FImGuiDrawData(const ImDrawData* Source);
+		void Update(const ImDrawData* Source, const FVector2f& InTranslation);
 
 		bool bValid = false;
-
-		int32 TotalIdxCount = 0;
-		int32 TotalVtxCount = 0;
-
-		TArray<FImGuiDrawList> DrawLists;
-
-		FVector2f DisplayPos = FVector2f::ZeroVector;
-		FVector2f DisplaySize = FVector2f::ZeroVector;
-		FVector2f FrameBufferScale = FVector2f::ZeroVector;
+		// paint translation the vertices and clip rects were converted with
+		FVector2f Translation = FVector2f::ZeroVector;
+		int32 NumBatches = 0;
+		TArray<FImGuiBatch> Batches;
 	};
 	FImGuiDrawData DrawData;
 	ImGuiContext* Context = nullptr;
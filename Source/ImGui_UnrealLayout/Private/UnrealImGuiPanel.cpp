@@ -6,6 +6,7 @@
 #include "imgui.h"
 #include "UnrealImGuiLayout.h"
 #include "UnrealImGuiPanelBuilder.h"
+#include "UnrealImGuiProfiler.h"
 
 UUnrealImGuiPanelBase::UUnrealImGuiPanelBase()
 	: ImGuiWindowFlags{ ImGuiWindowFlags_None }
@@ -66,6 +67,7 @@ void UUnrealImGuiPanelBase::DrawWindow(UUnrealImGuiLayoutBase* Layout, UObject*
 	const FString WindowName = GetLayoutPanelName(Layout->GetName());
 	if (ImGui::Begin(TCHAR_TO_UTF8(*WindowName), &IsOpen, ImGuiWindowFlags))
 	{
+		UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::Panels, GetClass()->GetFName() };
 		Draw(Owner, Builder, DeltaSeconds);
 	}
 	ImGui::End();
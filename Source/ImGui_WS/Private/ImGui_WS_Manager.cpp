@@ -17,12 +17,14 @@
 #include "imgui_internal.h"
 #include "imgui_notify.h"
 #include "implot.h"
+#include "UnrealImGuiProfiler.h"
 #include "UnrealImGuiStat.h"
 #include "UnrealImGuiString.h"
 #include "UnrealImGuiTexture.h"
 #include "UnrealImGui_Log.h"
 #include "WebKeyCodeToImGui.h"
 #include "Containers/TripleBuffer.h"
+#include "Hash/xxhash.h"
 #include "Engine/Engine.h"
 #include "Framework/Application/SlateApplication.h"
 #include "Framework/Docking/TabManager.h"
@@ -30,9 +32,12 @@
 #include "HAL/PlatformFileManager.h"
 #include "HAL/Thread.h"
 #include "Interfaces/IPluginManager.h"
+#include "Misc/CoreDelegates.h"
 #include "Misc/FileHelper.h"
 #include "Misc/ScopeExit.h"
 #include "Record/imgui-ws-record.h"
+#include "Record/ImGuiWS_RecordReader.h"
+#include "Record/ImGuiWS_RecordWriter.h"
 #include "Record/ImGuiWS_Replay.h"
 #include "UObject/Package.h"
 
@@ -138,6 +143,63 @@ TAutoConsoleVariable<FString> CVar_RecordSaveDirPathString
 		}
 	})
 };
+TAutoConsoleVariable<int32> CVar_ImGui_WS_DrawListEncoding
+{
+	TEXT("ImGui.WS.DrawListEncoding"),
+	0,
+	TEXT("ImGui-WS Draw List Encoding\n")
+	TEXT("0: Tessellated, send the vertex and index buffers\n")
+	TEXT("1: Semantic, send recognized primitives and let the browser tessellate them\n")
+	TEXT("2: Adaptive, pick the smaller encoding per draw list, see ImGui.WS.AdaptiveEncodingBudget")
+};
+TAutoConsoleVariable<int32> CVar_ImGui_WS_AdaptiveEncodingBudget
+{
+	TEXT("ImGui.WS.AdaptiveEncodingBudget"),
+	2000,
+	TEXT("ImGui-WS Adaptive Draw List Encoding CPU Budget Per Frame In Microseconds, lists over budget are sent tessellated")
+};
+TAutoConsoleVariable<int32> CVar_ImGui_WS_TextureBudgetMB
+{
+	TEXT("ImGui.WS.TextureBudgetMB"),
+	256,
+	TEXT("ImGui-WS Texture Memory Budget In MB, textures drawn least recently are freed on the server and the clients\n")
+	TEXT("and sent again once drawn, 0 keeps all, textures of garbage collected objects are always freed")
+};
+TAutoConsoleVariable<int32> CVar_ImGui_WS_EventDrivenRedraw
+{
+	TEXT("ImGui.WS.EventDrivenRedraw"),
+	0,
+	TEXT("ImGui-WS Event Driven Redraw\n")
+	TEXT("0: Rebuild ImGui every tick while a client is connected\n")
+	TEXT("1: Rebuild only on input, active widgets, notifications, redraw requests or after ImGui.WS.EventDrivenMaxInterval")
+};
+TAutoConsoleVariable<float> CVar_ImGui_WS_EventDrivenMaxInterval
+{
+	TEXT("ImGui.WS.EventDrivenMaxInterval"),
+	0.5f,
+	TEXT("ImGui-WS Event Driven Redraw Max Seconds Between Two Rebuilds, keeps live panels updating")
+};
+TAutoConsoleVariable<int32> CVar_ImGui_WS_MultiSession
+{
+	TEXT("ImGui.WS.MultiSession"),
+	0,
+	TEXT("ImGui-WS Multi Session\n")
+	TEXT("0: All clients share one ImGui frame, one client has control\n")
+	TEXT("1: Every client gets its own ImGui context with own windows, docking and display size")
+};
+TAutoConsoleVariable<float> CVar_ImGui_WS_BlackBoxSeconds
+{
+	TEXT("ImGui.WS.BlackBoxSeconds"),
+	30.f,
+	TEXT("ImGui-WS Black Box Record Seconds, the last served frames are kept in memory\n")
+	TEXT("and saved to ImGui.WS.RecordDirPath on ensure, crash or ImGui.WS.DumpBlackBox, 0 disables")
+};
+TAutoConsoleVariable<int32> CVar_ImGui_WS_BlackBoxBudgetMB
+{
+	TEXT("ImGui.WS.BlackBoxBudgetMB"),
+	32,
+	TEXT("ImGui-WS Black Box Record Memory Budget In MB, older frames are dropped first")
+};
 FAutoConsoleCommand StartImGuiRecord
 {
 	TEXT("ImGui.WS.StartRecord"),
@@ -164,6 +226,83 @@ FAutoConsoleCommand EndImGuiRecord
 		}
 	})
 };
+FAutoConsoleCommand DumpImGuiBlackBox
+{
+	TEXT("ImGui.WS.DumpBlackBox"),
+	TEXT("Save The ImGui-WS Black Box Record To ImGui.WS.RecordDirPath"),
+	FConsoleCommandDelegate::CreateLambda([]
+	{
+		UImGui_WS_Manager* Manager = UImGui_WS_Manager::GetChecked();
+		if (Manager->IsEnable())
+		{
+			Manager->DumpBlackBox();
+		}
+	})
+};
+FAutoConsoleCommand ConvertImGuiRecord
+{
+	TEXT("ImGui.WS.ConvertRecord"),
+	TEXT("Convert An ImGui-WS Record To The Compressed Format, Args: SourceFilePath [TargetFilePath]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() == 0)
+		{
+			UE_LOG(LogImGui, Warning, TEXT("ImGui.WS.ConvertRecord requires the source file path"));
+			return;
+		}
+		const FString& SourcePath = Args[0];
+		const FString TargetPath = Args.Num() > 1 ? Args[1] : FPaths::GetPath(SourcePath) / FPaths::GetBaseFilename(SourcePath) + TEXT("_v2.imgrcd");
+		ImGuiWS_Record::FImGuiWS_RecordReader Reader;
+		if (Reader.Open(SourcePath) == false)
+		{
+			return;
+		}
+		// the whole record may be queued, nothing must be dropped
+		ImGuiWS_Record::FImGuiWS_RecordWriter Writer{ TargetPath, TNumericLimits<int64>::Max() };
+		ImGuiWS_Record::FrameInput Input;
+		std::vector<ImGuiWS_Record::InputEvent> InputEvents;
+		TMap<uint32, uint64> TextureBindings;
+		TSet<uint64> TextureHashes;
+		for (int32 Idx = 0; Idx < Reader.NumFrames() && Writer.IsValid(); ++Idx)
+		{
+			std::vector<char> SerializedInput;
+			if (Reader.GetFrameInput(Idx, Input, InputEvents))
+			{
+				ImGuiWS_Record::serializeFrameInput(Input, InputEvents.data(), SerializedInput);
+			}
+			const TConstArrayView<char> Frame = Reader.DecodeFrame(Idx);
+			if (Frame.Num() == 0)
+			{
+				continue;
+			}
+			TArray<ImGuiWS_Record::FImGuiWS_RecordWriter::FTexture> Textures;
+			for (const auto& [TextureId, Hash] : Reader.GetTextureBindings())
+			{
+				if (TextureBindings.FindRef(TextureId) == Hash)
+				{
+					continue;
+				}
+				// the writer only needs the pixels of contents it hasn't stored yet
+				ImGuiWS_Record::TextureHeader Header{};
+				TArray<uint8> Pixels;
+				if (TextureHashes.Contains(Hash) == false && Reader.GetTexture(Hash, Header, Pixels) == false)
+				{
+					continue;
+				}
+				Textures.Add({ TextureId, Hash, Header.type, Header.width, Header.height, MoveTemp(Pixels) });
+				TextureBindings.Add(TextureId, Hash);
+				TextureHashes.Add(Hash);
+			}
+			Writer.AddSerializedFrame(std::vector<char>{ Frame.GetData(), Frame.GetData() + Frame.Num() }, Reader.GetFrameTime(Idx), MoveTemp(SerializedInput), MoveTemp(Textures));
+		}
+		Writer.RequestClose();
+		while (Writer.IsValid() && Writer.IsClosed() == false)
+		{
+			FPlatformProcess::Sleep(0.01f);
+		}
+		UE_LOG(LogImGui, Log, TEXT("Converted %d frames, %lld bytes to %lld bytes, saved to %s"), Writer.NumFrames(), Reader.TotalBytes(), Writer.TotalBytes(), *TargetPath);
+	})
+};
 
 #if PLATFORM_WINDOWS
 #include <corecrt_io.h>
@@ -183,16 +322,30 @@ public:
 	ImPlotContext* PlotContext;
 
 	FCriticalSection RecordCriticalSection;
-	TSharedPtr<ImGuiWS_Record::Session, ESPMode::ThreadSafe> RecordSession;
-	TUniquePtr<ImGuiWS_Record::FImGuiWS_Replay> RecordReplay;
-
-	struct EServerEventType
+	TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe> RecordWriter;
+	// writers finishing the queued frames and the index after StopRecord
+	TArray<TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe>> ClosingRecordWriters;
+	// ring writer keeping the last served frames, saved on ensure, crash or ImGui.WS.DumpBlackBox
+	TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe> BlackBoxWriter;
+	// an ensure firing every frame would otherwise fill the disk
+	static constexpr double BlackBoxDumpInterval = 30.0;
+	double LastBlackBoxDumpSeconds = -1.0;
+	FDelegateHandle EnsureHandle;
+	FDelegateHandle SystemErrorHandle;
+	// ws thread only, texture revisions and contents already handed to a writer
+	struct FRecordedTextures
 	{
-		enum Type : int32
-		{
-			SetClipboardText
-		};
+		const ImGuiWS_Record::FImGuiWS_RecordWriter* Writer = nullptr;
+		TMap<ImGuiWS::FTextureId, int32> Revisions;
+		TSet<uint64> Hashes;
 	};
+	FRecordedTextures RecordedTextures;
+	FRecordedTextures BlackBoxTextures;
+	// content hash of the texture revision, computed once for all writers
+	TMap<ImGuiWS::FTextureId, TPair<int32, uint64>> RecordedTextureHashes;
+	TUniquePtr<ImGuiWS_Record::FImGuiWS_Replay> RecordReplay;
+
+	using EServerEventType = ImGuiWS::EServerEventType;
 
 	explicit FImpl(UImGui_WS_Manager& Manager)
 		: Manager(Manager)
@@ -211,34 +364,8 @@ public:
 			ImGui::SetCurrentContext(PrevContext);
 		};
 		ImGuiIO& IO = ImGui::GetIO();
-
-		IO.MouseDrawCursor = false;
-		IO.SetClipboardTextFn = [](void* user_data, const char* text)
-		{
-			const UImGui_WS_Manager* Manager = UImGui_WS_Manager::GetChecked();
-			const int32 Len = FCStringAnsi::Strlen(text);
-			TArray<uint8> Payload;
-			Payload.SetNumUninitialized(Len + 1);
-			FMemory::Memcpy(Payload.GetData(), text, Len + 1);
-			Manager->Impl->ImGuiWS.AddServerEvent(Manager->Impl->State.CurControlId, EServerEventType::SetClipboardText, MoveTemp(Payload));
-		};
-
-		// Enable Docking
-		IO.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-
-		ImGui::StyleColorsDark();
-		ImGui::GetStyle().AntiAliasedFill = false;
-		ImGui::GetStyle().AntiAliasedLines = false;
-		ImGui::GetStyle().WindowRounding = 0.0f;
-		ImGui::GetStyle().ScrollbarRounding = 0.0f;
-
-		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-		const FString IniDirectory = FPaths::ProjectSavedDir() / TEXT(UE_PLUGIN_NAME);
-		// Make sure that directory is created.
-		PlatformFile.CreateDirectory(*IniDirectory);
-		static const UnrealImGui::FUTF8String IniFilePath = IniDirectory / TEXT("Imgui_WS.ini");
-		IO.IniFilename = IniFilePath.GetData();
-	    IO.DisplaySize = ImVec2(0, 0);
+		SetupContext(IO);
+		IO.IniFilename = GetIniFilePath().GetData();
 
 		PlotContext = ImPlot::CreateContext();
 
@@ -277,12 +404,13 @@ public:
 		}, 0, TPri_Lowest };
 
 		// prepare font texture
+		UpdateFontAtlas();
+		// the texture keeps its size while glyphs are baked into it, clients then receive only the changed bytes
+		FontAtlasChangedHandle = FImGuiDelegates::OnImGuiFontAtlasChanged.AddLambda([this]
 		{
-			unsigned char* Pixels;
-			int32 Width, Height;
-			IO.Fonts->GetTexDataAsAlpha8(&Pixels, &Width, &Height);
-			ImGuiWS.SetTexture(0, ImGuiWS::FTexture::Type::Alpha8, Width, Height, Pixels);
-		}
+			UpdateFontAtlas();
+			bRedrawRequested = true;
+		});
 
 		using namespace UnrealImGui;
 		Private::UpdateTextureData_WS = [this](FImGuiTextureHandle Handle, ETextureFormat TextureFormat, int32 Width, int32 Height, const uint8* Data)
@@ -291,18 +419,46 @@ public:
 			static_assert((int32_t)ImGuiWS::FTexture::Type::Gray8 == (uint8)ETextureFormat::Gray8);
 			static_assert((int32_t)ImGuiWS::FTexture::Type::RGB24 == (uint8)ETextureFormat::RGB8);
 			static_assert((int32_t)ImGuiWS::FTexture::Type::RGBA32 == (uint8)ETextureFormat::RGBA8);
-			ImGuiWS.SetTexture(Handle, ImGuiWS::FTexture::Type{ static_cast<uint8>(TextureFormat) }, Width, Height, Data);
+			// textures backed by an asset or render target can be restored after an eviction
+			const bool bEvictable = FindTexture(Handle) != nullptr;
+			ImGuiWS.SetTexture(Handle, ImGuiWS::FTexture::Type{ static_cast<uint8>(TextureFormat) }, Width, Height, Data, bEvictable);
+		};
+		Private::RemoveTextureData_WS = [this](uint32 ImTextureId)
+		{
+			ImGuiWS.RemoveTexture(ImTextureId);
 		};
 
+		RequestRedrawHandle = FImGuiDelegates::OnImGuiRequestRedraw.AddLambda([this]
+		{
+			bRedrawRequested = true;
+		});
+
+		EnsureHandle = FCoreDelegates::OnHandleSystemEnsure.AddLambda([this]
+		{
+			DumpBlackBox(TEXT("Ensure"), false, true);
+		});
+		SystemErrorHandle = FCoreDelegates::OnHandleSystemError.AddLambda([this]
+		{
+			// the writer thread may never run again
+			DumpBlackBox(TEXT("Crash"), true, false);
+		});
+
 		FImGuiDelegates::OnImGui_WS_Enable.Broadcast();
 	}
 	~FImpl() override
 	{
 		FImGuiDelegates::OnImGui_WS_Disable.Broadcast();
+		FImGuiDelegates::OnImGuiRequestRedraw.Remove(RequestRedrawHandle);
+		FImGuiDelegates::OnImGuiFontAtlasChanged.Remove(FontAtlasChangedHandle);
+		FCoreDelegates::OnHandleSystemEnsure.Remove(EnsureHandle);
+		FCoreDelegates::OnHandleSystemError.Remove(SystemErrorHandle);
+		UnrealImGui::Profiler::SetEnabled(false);
+		Sessions.Empty();
 		FImGuiDelegates::OnImGuiContextDestroyed.Broadcast(Context);
 		ImGui::DestroyContext(Context);
 		ImPlot::DestroyContext(PlotContext);
 		UnrealImGui::Private::UpdateTextureData_WS.Reset();
+		UnrealImGui::Private::RemoveTextureData_WS.Reset();
 		bRequestedExit = true;
 		if (WS_Thread.IsJoinable())
 		{
@@ -310,6 +466,46 @@ public:
 		}
 	}
 
+	static const UnrealImGui::FUTF8String& GetIniFilePath()
+	{
+		static const UnrealImGui::FUTF8String IniFilePath = []
+		{
+			IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+			const FString IniDirectory = FPaths::ProjectSavedDir() / TEXT(UE_PLUGIN_NAME);
+			// Make sure that directory is created.
+			PlatformFile.CreateDirectory(*IniDirectory);
+			return UnrealImGui::FUTF8String{ IniDirectory / TEXT("Imgui_WS.ini") };
+		}();
+		return IniFilePath;
+	}
+
+	// shared by the main context and the session contexts, IO.ClipboardUserData is the session or null
+	static void SetupContext(ImGuiIO& IO)
+	{
+		IO.MouseDrawCursor = false;
+		IO.SetClipboardTextFn = [](void* user_data, const char* text)
+		{
+			const UImGui_WS_Manager* Manager = UImGui_WS_Manager::GetChecked();
+			const int32 Len = FCStringAnsi::Strlen(text);
+			TArray<uint8> Payload;
+			Payload.SetNumUninitialized(Len + 1);
+			FMemory::Memcpy(Payload.GetData(), text, Len + 1);
+			const int32 ClientId = user_data ? static_cast<const FSession*>(user_data)->ClientId : Manager->Impl->State.CurControlId;
+			Manager->Impl->ImGuiWS.AddServerEvent(ClientId, EServerEventType::SetClipboardText, MoveTemp(Payload));
+		};
+
+		// Enable Docking
+		IO.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+
+		ImGui::StyleColorsDark();
+		ImGui::GetStyle().AntiAliasedFill = false;
+		ImGui::GetStyle().AntiAliasedLines = false;
+		ImGui::GetStyle().WindowRounding = 0.0f;
+		ImGui::GetStyle().ScrollbarRounding = 0.0f;
+
+	    IO.DisplaySize = ImVec2(0, 0);
+	}
+
 	struct FVSync
 	{
 		FVSync(double RateFps = 60.0) : tStep_us(1000000.0/RateFps) {}
@@ -351,10 +547,11 @@ public:
 		bool bIsIdControlChanged = false;
 		TMap<int32, ClientData> Clients;
 
+		using FEvents = TArray<ImGuiWS::FEvent, TInlineAllocator<16>>;
 		// client input
-		TArray<ImGuiWS::FEvent, TInlineAllocator<16>> PendingEvents;
+		FEvents PendingEvents;
 		// recover key down state
-		TArray<ImGuiWS::FEvent, TInlineAllocator<16>> KeyDownEvents;
+		FEvents KeyDownEvents;
 
 		void Handle(const ImGuiWS::FEvent& Event)
 		{
@@ -411,6 +608,27 @@ public:
 		    	bIsIdControlChanged = true;
 		    }
 
+			if (bIsIdControlChanged)
+			{
+				ImGui::GetIO().ClearInputKeys();
+				KeyDownEvents.Empty();
+				bIsIdControlChanged = false;
+			}
+		    if (CurControlId > 0)
+			{
+		    	ApplyInputEvents(PendingEvents, KeyDownEvents);
+		    	PendingEvents.Empty();
+		    }
+		}
+
+		static bool IsInputEvent(ImGuiWS::FEvent::EType Type)
+		{
+			return Type != ImGuiWS::FEvent::Connected && Type != ImGuiWS::FEvent::Disconnected && Type != ImGuiWS::FEvent::TakeControl;
+		}
+
+		// feeds the events of one client to the current context
+		static void ApplyInputEvents(const FEvents& Events, FEvents& KeyDownEvents)
+		{
 			ImGuiIO& IO = ImGui::GetIO();
 			auto AddKeyEvent = [&IO](ImGuiKey Key, bool bDown)
 			{
@@ -453,141 +671,388 @@ public:
 				}
 				return WebMouseButton;
 			};
-			if (bIsIdControlChanged)
-			{
-				IO.ClearInputKeys();
-				KeyDownEvents.Empty();
-				bIsIdControlChanged = false;
-			}
-		    if (CurControlId > 0)
-			{
-		    	for (const ImGuiWS::FEvent& Event : PendingEvents)
-		    	{
-		    		switch (Event.Type)
-		    		{
-		    		case ImGuiWS::FEvent::MouseMove:
-		    			{
-				            IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::MouseDown:
-		    			{
-		    				IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
-		    				IO.AddMouseButtonEvent(ConvertWebMouseButtonToImGui(Event.MouseBtn), true);
-		    				KeyDownEvents.Add(Event);
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::MouseUp:
-		    			{
-		    				IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
-		    				IO.AddMouseButtonEvent(ConvertWebMouseButtonToImGui(Event.MouseBtn), false);
-		    				KeyDownEvents.RemoveAll([&Event](const ImGuiWS::FEvent& E) { return E.Type == Event.Type && E.MouseBtn == Event.MouseBtn; } );
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::MouseWheel:
-		    			{
-		    				IO.AddMouseWheelEvent(Event.WheelX, Event.WheelY);
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::KeyPress:
-		    			{
-		    				IO.AddInputCharacter(Event.Key);
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::KeyDown:
-		    			{
-		    				const ImGuiKey Key = ToImGuiKey(EWebKeyCode(Event.Key));
-		    				AddKeyEvent(Key, true);
-		    				KeyDownEvents.Add(Event);
-		    			}
-		            	break;
-		            case ImGuiWS::FEvent::KeyUp:
-			            {
-		            		const ImGuiKey Key = ToImGuiKey(EWebKeyCode(Event.Key));
-				            AddKeyEvent(Key, false);
-		    				KeyDownEvents.RemoveAll([&Event](const ImGuiWS::FEvent& E) { return E.Type == Event.Type && E.MouseBtn == Event.MouseBtn; } );
-			            }
-		            	break;
-		    		case ImGuiWS::FEvent::Resize:
-		    			{
-		    				IO.DisplaySize = { (float)Event.ClientWidth, (float)Event.ClientHeight };
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::PasteClipboard:
-		    			{
-		    				ImGui::SetClipboardText(Event.ClipboardText.c_str());
-		    			}
-		    			break;
-		    		case ImGuiWS::FEvent::InputText:
-		    			{
-		    				IO.AddInputCharactersUTF8(Event.InputtedText.c_str());
-		    			}
-		    			break;
-		            default:
-		            	ensureMsgf(false, TEXT("Unhandle input event %d"), Event.Type);
+	    	for (const ImGuiWS::FEvent& Event : Events)
+	    	{
+	    		switch (Event.Type)
+	    		{
+	    		case ImGuiWS::FEvent::MouseMove:
+	    			{
+			            IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::MouseDown:
+	    			{
+	    				IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
+	    				IO.AddMouseButtonEvent(ConvertWebMouseButtonToImGui(Event.MouseBtn), true);
+	    				KeyDownEvents.Add(Event);
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::MouseUp:
+	    			{
+	    				IO.AddMousePosEvent(Event.MouseX, Event.MouseY);
+	    				IO.AddMouseButtonEvent(ConvertWebMouseButtonToImGui(Event.MouseBtn), false);
+	    				KeyDownEvents.RemoveAll([&Event](const ImGuiWS::FEvent& E) { return E.Type == Event.Type && E.MouseBtn == Event.MouseBtn; } );
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::MouseWheel:
+	    			{
+	    				IO.AddMouseWheelEvent(Event.WheelX, Event.WheelY);
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::KeyPress:
+	    			{
+	    				IO.AddInputCharacter(Event.Key);
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::KeyDown:
+	    			{
+	    				const ImGuiKey Key = ToImGuiKey(EWebKeyCode(Event.Key));
+	    				AddKeyEvent(Key, true);
+	    				KeyDownEvents.Add(Event);
+	    			}
+	            	break;
+	            case ImGuiWS::FEvent::KeyUp:
+		            {
+	            		const ImGuiKey Key = ToImGuiKey(EWebKeyCode(Event.Key));
+			            AddKeyEvent(Key, false);
+	    				KeyDownEvents.RemoveAll([&Event](const ImGuiWS::FEvent& E) { return E.Type == Event.Type && E.MouseBtn == Event.MouseBtn; } );
 		            }
-		    	}
-		    	PendingEvents.Empty();
-		    }
+	            	break;
+	    		case ImGuiWS::FEvent::Resize:
+	    			{
+	    				IO.DisplaySize = { (float)Event.ClientWidth, (float)Event.ClientHeight };
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::PasteClipboard:
+	    			{
+	    				ImGui::SetClipboardText(Event.ClipboardText.c_str());
+	    			}
+	    			break;
+	    		case ImGuiWS::FEvent::InputText:
+	    			{
+	    				IO.AddInputCharactersUTF8(Event.InputtedText.c_str());
+	    			}
+	    			break;
+	            default:
+	            	ensureMsgf(false, TEXT("Unhandle input event %d"), Event.Type);
+	            }
+	    	}
 		}
 	};
 
 	FVSync VSync;
 	FState State;
+	// shared by all sessions, the profiler collects while it is shown
+	bool bShowProfiler = false;
+
+	// own ImGui context of one client in the multi session mode, draws the same panels as the main context
+	struct FSession : FNoncopyable
+	{
+		int32 ClientId = INDEX_NONE;
+		ImGuiContext* Context = nullptr;
+		ImPlotContext* PlotContext = nullptr;
+		FVSync VSync;
+		int32 DrawContextIndex = 0;
+		bool bShowImGuiDemo = false;
+		bool bShowPlotDemo = false;
+		FState::FEvents PendingEvents;
+		FState::FEvents KeyDownEvents;
+
+		~FSession()
+		{
+			FImGuiDelegates::OnImGuiContextDestroyed.Broadcast(Context);
+			ImGui::DestroyContext(Context);
+			ImPlot::DestroyContext(PlotContext);
+		}
+	};
+	TMap<int32, TUniquePtr<FSession>> Sessions;
+
+	FSession* FindOrAddSession(int32 ClientId)
+	{
+		if (TUniquePtr<FSession>* ExistSession = Sessions.Find(ClientId))
+		{
+			return ExistSession->Get();
+		}
+		if (State.Clients.Contains(ClientId) == false)
+		{
+			return nullptr;
+		}
+
+		TUniquePtr<FSession> Session = MakeUnique<FSession>();
+		Session->ClientId = ClientId;
+		Session->DrawContextIndex = Manager.DrawContextIndex;
+
+		ImGuiContext* PrevContext = ImGui::GetCurrentContext();
+		Session->Context = ImGui::CreateContext(&UnrealImGui::GetDefaultFontAtlas());
+		ImGui::SetCurrentContext(Session->Context);
+		ON_SCOPE_EXIT
+		{
+			ImGui::SetCurrentContext(PrevContext);
+		};
+		ImGuiIO& IO = ImGui::GetIO();
+		SetupContext(IO);
+		IO.ClipboardUserData = Session.Get();
+		// start from the saved layout, but only the main context writes it back
+		IO.IniFilename = nullptr;
+		ImGui::LoadIniSettingsFromDisk(GetIniFilePath().GetData());
+
+		Session->PlotContext = ImPlot::CreateContext();
+
+		return Sessions.Add(ClientId, MoveTemp(Session)).Get();
+	}
+
+	void SyncSessions(bool bMultiSession)
+	{
+		for (auto It = Sessions.CreateIterator(); It; ++It)
+		{
+			if (bMultiSession == false || State.Clients.Contains(It.Key()) == false)
+			{
+				It.RemoveCurrent();
+			}
+		}
+		if (bMultiSession)
+		{
+			for (const auto& [ClientId, Client] : State.Clients)
+			{
+				FindOrAddSession(ClientId);
+			}
+		}
+	}
 
 	bool IsTickableWhenPaused() const { return true; }
 	bool IsTickableInEditor() const { return true; }
 	UWorld* GetTickableGameObjectWorld() const { return GWorld; }
 	TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(UImGui_WS_Manager_FDrawer, STATGROUP_Tickables); }
 
+	// snapshot of a frame for the ws thread, the draw lists are pooled and keep their capacity across frames
 	struct FImGuiData : FNoncopyable
 	{
+		int32 ClientId = INDEX_NONE;
 		ImDrawData CopiedDrawData;
-		const ImGuiWS::FDrawInfo DrawInfo;
+		ImGuiWS::FDrawInfo DrawInfo;
+		double CaptureSeconds = 0.0;
+		// input applied in the frame, only collected while recording
+		TArray<ImGuiWS_Record::InputEvent> InputEvents;
 
-		FImGuiData(const ImDrawData* DrawData, ImGuiWS_Record::FImGuiWS_Replay* Replay, const ImGuiWS::FDrawInfo&& DrawInfo)
-			: CopiedDrawData{ *DrawData }
-			, DrawInfo{ DrawInfo }
+		~FImGuiData()
 		{
-			ImGuiWS_Record::FImGuiWS_Replay::FDrawData ReplayDrawData;
-			if (Replay && Replay->GetDrawData(ReplayDrawData))
+			for (ImDrawList* DrawList : DrawListPool)
 			{
-				CopiedDrawData.CmdListsCount = ReplayDrawData->CmdListsCount + DrawData->CmdListsCount;
-				CopiedDrawData.CmdLists.resize(CopiedDrawData.CmdListsCount);
-				for (int32 Idx = 0; Idx < ReplayDrawData->CmdListsCount; ++Idx)
-				{
-					CopiedDrawData.CmdLists[Idx] = ReplayDrawData->CmdLists[Idx]->CloneOutput();
-				}
-				for (int32 Idx = 0; Idx < DrawData->CmdListsCount; ++Idx)
-				{
-					CopiedDrawData.CmdLists[ReplayDrawData->CmdListsCount + Idx] = DrawData->CmdLists[Idx]->CloneOutput();
-				}
+				IM_DELETE(DrawList);
 			}
-			else
+		}
+
+		void CaptureInput(const FState::FEvents& Events, bool bRecording)
+		{
+			using namespace ImGuiWS_Record;
+			InputEvents.Reset();
+			if (bRecording == false)
+			{
+				return;
+			}
+			for (const ImGuiWS::FEvent& Event : Events)
 			{
-				CopiedDrawData.CmdLists.resize(DrawData->CmdListsCount);
-				for (int32 Idx = 0; Idx < DrawData->CmdListsCount; ++Idx)
+				switch (Event.Type)
 				{
-					CopiedDrawData.CmdLists[Idx] = DrawData->CmdLists[Idx]->CloneOutput();
+				case ImGuiWS::FEvent::MouseDown:
+					InputEvents.Add({ (int32)InputType::MouseDown, Event.MouseBtn, Event.MouseX, Event.MouseY });
+					break;
+				case ImGuiWS::FEvent::MouseUp:
+					InputEvents.Add({ (int32)InputType::MouseUp, Event.MouseBtn, Event.MouseX, Event.MouseY });
+					break;
+				case ImGuiWS::FEvent::MouseWheel:
+					InputEvents.Add({ (int32)InputType::MouseWheel, 0, Event.WheelX, Event.WheelY });
+					break;
+				case ImGuiWS::FEvent::KeyDown:
+					InputEvents.Add({ (int32)InputType::KeyDown, Event.Key });
+					break;
+				case ImGuiWS::FEvent::KeyUp:
+					InputEvents.Add({ (int32)InputType::KeyUp, Event.Key });
+					break;
+				case ImGuiWS::FEvent::KeyPress:
+					InputEvents.Add({ (int32)InputType::Char, Event.Key });
+					break;
+				case ImGuiWS::FEvent::InputText:
+				case ImGuiWS::FEvent::PasteClipboard:
+					InputEvents.Add({ (int32)InputType::Text });
+					break;
+				case ImGuiWS::FEvent::Resize:
+					InputEvents.Add({ (int32)InputType::Resize, 0, (float)Event.ClientWidth, (float)Event.ClientHeight });
+					break;
+				default:
+					// the mouse position is stored once per frame
+					break;
 				}
 			}
 		}
-		~FImGuiData()
+
+		void CopyFrom(const ImDrawData* DrawData, ImGuiWS_Record::FImGuiWS_Replay* Replay, const ImGuiWS::FDrawInfo& InDrawInfo)
 		{
+			DrawInfo = InDrawInfo;
+			CaptureSeconds = FPlatformTime::Seconds();
+
+			CopiedDrawData.Valid = DrawData->Valid;
+			CopiedDrawData.DisplayPos = DrawData->DisplayPos;
+			CopiedDrawData.DisplaySize = DrawData->DisplaySize;
+			CopiedDrawData.FramebufferScale = DrawData->FramebufferScale;
+			CopiedDrawData.OwnerViewport = DrawData->OwnerViewport;
+			CopiedDrawData.CmdListsCount = 0;
+			CopiedDrawData.TotalVtxCount = 0;
+			CopiedDrawData.TotalIdxCount = 0;
+			// keeps the capacity
+			CopiedDrawData.CmdLists.resize(0);
+
+			// replayed lists are decoded straight into the pool, one copy out of the record
+			if (Replay)
+			{
+				Replay->GetDrawLists([this]() -> ImDrawList& { return AddDrawList(); });
+			}
+			for (int32 Idx = 0; Idx < DrawData->CmdListsCount; ++Idx)
+			{
+				CopyDrawList(DrawData->CmdLists[Idx]);
+			}
 			for (int32 Idx = 0; Idx < CopiedDrawData.CmdListsCount; ++Idx)
 			{
-				IM_DELETE(CopiedDrawData.CmdLists[Idx]);
+				CopiedDrawData.TotalVtxCount += CopiedDrawData.CmdLists[Idx]->VtxBuffer.Size;
+				CopiedDrawData.TotalIdxCount += CopiedDrawData.CmdLists[Idx]->IdxBuffer.Size;
+			}
+		}
+	private:
+		TArray<ImDrawList*> DrawListPool;
+
+		template<typename T>
+		static void CopyBuffer(ImVector<T>& Dst, const ImVector<T>& Src)
+		{
+			// ImVector::operator= frees the old buffer, resize only grows it
+			Dst.resize(Src.Size);
+			if (Src.Size > 0)
+			{
+				FMemory::Memcpy(Dst.Data, Src.Data, Src.Size * sizeof(T));
 			}
 		}
+
+		ImDrawList& AddDrawList()
+		{
+			if (DrawListPool.Num() <= CopiedDrawData.CmdListsCount)
+			{
+				DrawListPool.Add(IM_NEW(ImDrawList)(nullptr));
+			}
+			ImDrawList* DrawList = DrawListPool[CopiedDrawData.CmdListsCount];
+			CopiedDrawData.CmdLists.push_back(DrawList);
+			CopiedDrawData.CmdListsCount += 1;
+			return *DrawList;
+		}
+
+		void CopyDrawList(const ImDrawList* Src)
+		{
+			ImDrawList& Dst = AddDrawList();
+			CopyBuffer(Dst.CmdBuffer, Src->CmdBuffer);
+			CopyBuffer(Dst.IdxBuffer, Src->IdxBuffer);
+			CopyBuffer(Dst.VtxBuffer, Src->VtxBuffer);
+			Dst.Flags = Src->Flags;
+		}
 	};
-	TTripleBuffer<TSharedPtr<FImGuiData>> ImGuiDataTripleBuffer;
+	// the main frame, or one frame per session when sessions are drawn
+	struct FImGuiFrame : FNoncopyable
+	{
+		FImGuiData Main;
+		TArray<TUniquePtr<FImGuiData>> Sessions;
+		int32 NumSessions = 0;
+
+		FImGuiData& AddSession()
+		{
+			if (Sessions.Num() <= NumSessions)
+			{
+				Sessions.Add(MakeUnique<FImGuiData>());
+			}
+			return *Sessions[NumSessions++];
+		}
+	};
+	TTripleBuffer<FImGuiFrame> ImGuiDataTripleBuffer;
+
+	// event driven redraw, frames rebuilt after the last trigger so the layout settles
+	static constexpr int32 RedrawSettleFrames = 3;
+	std::atomic_bool bRedrawRequested{ false };
+	int32 RedrawFramesLeft = 0;
+	double LastRedrawSeconds = 0.0;
+	FDelegateHandle RequestRedrawHandle;
+	FDelegateHandle FontAtlasChangedHandle;
+
+	void UpdateFontAtlas()
+	{
+		ImFontAtlas* FontAtlas = Context->IO.Fonts;
+		unsigned char* Pixels;
+		int32 Width, Height;
+		FontAtlas->GetTexDataAsAlpha8(&Pixels, &Width, &Height);
+		ImGuiWS.SetTexture(UnrealImGui::FontTextId, ImGuiWS::FTexture::Type::Alpha8, Width, Height, Pixels);
+		ImGuiWS.SetFontAtlas(FontAtlas, UnrealImGui::IsSignedDistanceFieldFont() ? UnrealImGui::FontSdfSpread : 0);
+	}
+
+	bool ShouldSkipFrame()
+	{
+		if (CVar_ImGui_WS_EventDrivenRedraw.GetValueOnGameThread() == 0)
+		{
+			return false;
+		}
+
+		const double CurSeconds = FPlatformTime::Seconds();
+		const bool bTriggered = ImGuiWS.TakeEvents().IsEmpty() == false
+			|| bRedrawRequested.exchange(false)
+			|| RecordReplay.IsValid()
+			|| CurSeconds - LastRedrawSeconds >= CVar_ImGui_WS_EventDrivenMaxInterval.GetValueOnGameThread();
+		if (bTriggered)
+		{
+			RedrawFramesLeft = RedrawSettleFrames;
+		}
+		else if (RedrawFramesLeft > 0)
+		{
+			RedrawFramesLeft -= 1;
+		}
+		else
+		{
+			// the ws thread keeps serving the last draw data
+			return true;
+		}
+		LastRedrawSeconds = CurSeconds;
+		return false;
+	}
+
+	// widgets that change without new input: dragging, text caret, pending tooltips, toasts
+	void KeepRedrawingIfBusy()
+	{
+		const ImGuiContext& G = *ImGui::GetCurrentContext();
+		const bool bBusy = G.ActiveId != 0
+			|| G.IO.WantTextInput
+			|| (G.HoveredId != 0 && G.HoveredIdTimer < G.Style.HoverDelayNormal + G.Style.HoverStationaryDelay)
+			|| G.NavWindowingTarget != nullptr
+			|| ImGui::HasNotifications();
+		if (bBusy)
+		{
+			RedrawFramesLeft = FMath::Max(RedrawFramesLeft, RedrawSettleFrames);
+		}
+	}
 
 	void Tick(float DeltaTime) override
 	{
-		if (ImGuiWS.NumConnected() == 0 && RecordSession.IsValid() == false)
+		for (int32 Idx = ClosingRecordWriters.Num() - 1; Idx >= 0; --Idx)
+		{
+			if (ClosingRecordWriters[Idx]->IsClosed())
+			{
+				ImGui::InsertNotification(ImGuiToastType_Success, "Save Record To:\n%s", TCHAR_TO_UTF8(*ClosingRecordWriters[Idx]->GetFilePath()));
+				ClosingRecordWriters.RemoveAtSwap(Idx);
+			}
+		}
+
+		if (ImGuiWS.NumConnected() == 0 && RecordWriter.IsValid() == false)
 		{
 	        return;
 	    }
+		UpdateBlackBox();
+
+		if (ShouldSkipFrame())
+		{
+			return;
+		}
 
 		DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Tick"), STAT_ImGuiWS_Tick, STATGROUP_ImGui);
 
@@ -601,7 +1066,9 @@ public:
 	    ImGui::SetCurrentContext(Context);
 		ImPlot::SetCurrentContext(PlotContext);
 
-	    ImGui::NewFrame();
+		const bool bMultiSession = CVar_ImGui_WS_MultiSession.GetValueOnGameThread() != 0;
+		// a replay is drawn by the main context for every client
+		const bool bDrawSessions = bMultiSession && RecordReplay.IsValid() == false;
 
 	    // websocket event handling
 		auto& Events = ImGuiWS.TakeEvents();
@@ -609,261 +1076,535 @@ public:
 		{
 			ImGuiWS::FEvent Event;
 			Events.Dequeue(Event);
-	        State.Handle(Event);
+			if (bDrawSessions && FState::IsInputEvent(Event.Type))
+			{
+				if (FSession* Session = FindOrAddSession(Event.ClientId))
+				{
+					Session->PendingEvents.Add(MoveTemp(Event));
+				}
+			}
+			else
+			{
+		        State.Handle(Event);
+			}
 		}
-	    State.Update();
+		SyncSessions(bMultiSession);
 
-	    ImGuiIO& IO = ImGui::GetIO();
-	    IO.DeltaTime = VSync.Delta_S();
+		auto& RestoreRequests = ImGuiWS.TakeRestoreRequests();
+		while (RestoreRequests.IsEmpty() == false)
+		{
+			ImGuiWS::FTextureId TextureId;
+			RestoreRequests.Dequeue(TextureId);
+			UnrealImGui::RestoreTextureData(TextureId);
+		}
+
+		FImGuiFrame& Frame = ImGuiDataTripleBuffer.GetWriteBuffer();
+		Frame.NumSessions = 0;
 
 		bool CloseRecord = false;
-		if (RecordReplay.IsValid())
+		if (bDrawSessions == false || Sessions.Num() == 0)
 		{
-			RecordReplay->Draw(DeltaTime, CloseRecord);
+			{
+				UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::GameThread, TEXT("NewFrame") };
+				ImGui::NewFrame();
+			}
+			Frame.Main.CaptureInput(State.PendingEvents, RecordWriter.IsValid() || BlackBoxWriter.IsValid());
+		    State.Update();
+
+		    ImGuiIO& IO = ImGui::GetIO();
+		    IO.DeltaTime = VSync.Delta_S();
+
+			if (RecordReplay.IsValid())
+			{
+				RecordReplay->Draw(DeltaTime, CloseRecord);
+			}
+			else
+			{
+				DrawFrame(DeltaTime, Manager.DrawContextIndex, State.bShowImGuiDemo, State.bShowPlotDemo);
+			}
+
+		    // generate ImDrawData
+			{
+				UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::GameThread, TEXT("Render") };
+				ImGui::Render();
+			}
+			KeepRedrawingIfBusy();
+
+			{
+				// store ImDrawData for asynchronous dispatching to WS clients
+				DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Generate_ImGuiData"), STAT_ImGuiWS_Generate_ImGuiData, STATGROUP_ImGui);
+				UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::GameThread, TEXT("Snapshot") };
+				const auto CurControlIp = State.Clients.FindRef(State.CurControlId).Ip;
+				Frame.Main.CopyFrom(ImGui::GetDrawData(), RecordReplay.Get(), MakeDrawInfo(State.CurControlId, CurControlIp));
+			}
+
+		    ImGui::EndFrame();
 		}
 		else
 		{
-			ContextManager.DrawViewport(Manager.DrawContextIndex, DeltaTime);
-
-			if (ImGui::BeginMainMenuBar())
+			// ImGui keeps the current context in a global, so the sessions are built one after another
+			for (const auto& [ClientId, Session] : Sessions)
 			{
-				if (ImGui::BeginMenu("ImGui_WS"))
+				ImGui::SetCurrentContext(Session->Context);
+				ImPlot::SetCurrentContext(Session->PlotContext);
+
 				{
-					ImGui::Checkbox("ImGui Demo", &State.bShowImGuiDemo);
-					ImGui::Checkbox("ImPlot Demo", &State.bShowPlotDemo);
+					UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::GameThread, TEXT("NewFrame") };
+					ImGui::NewFrame();
+				}
+				FImGuiData& SessionData = Frame.AddSession();
+				SessionData.CaptureInput(Session->PendingEvents, RecordWriter.IsValid() || BlackBoxWriter.IsValid());
+				FState::ApplyInputEvents(Session->PendingEvents, Session->KeyDownEvents);
+				Session->PendingEvents.Empty();
+				ImGui::GetIO().DeltaTime = Session->VSync.Delta_S();
+
+				DrawFrame(DeltaTime, Session->DrawContextIndex, Session->bShowImGuiDemo, Session->bShowPlotDemo);
+
+				{
+					UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::GameThread, TEXT("Render") };
+					ImGui::Render();
+				}
+				KeepRedrawingIfBusy();
+
+				{
+					DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Generate_ImGuiData"), STAT_ImGuiWS_Generate_ImGuiData, STATGROUP_ImGui);
+					UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::GameThread, TEXT("Snapshot") };
+					// every client controls its own session
+					SessionData.ClientId = ClientId;
+					SessionData.CopyFrom(ImGui::GetDrawData(), nullptr, MakeDrawInfo(ClientId, State.Clients.FindRef(ClientId).Ip));
+				}
+
+				ImGui::EndFrame();
+			}
+		}
+		ImGuiDataTripleBuffer.SwapWriteBuffers();
+
+		if (CloseRecord)
+		{
+			RecordReplay.Reset();
+		}
+	}
+
+	// draw info of the current context
+	static ImGuiWS::FDrawInfo MakeDrawInfo(int32 ControlId, uint32 ControlIp)
+	{
+		const ImGuiIO& IO = ImGui::GetIO();
+		return ImGuiWS::FDrawInfo{
+			ImGui::GetMouseCursor(),
+			ControlId,
+			ControlIp,
+			FVector2f{ ImGui::GetMousePos() },
+			FVector2f{ IO.DisplaySize },
+			IO.WantTextInput,
+			IO.WantTextInput ? FVector2f{ ImGui::GetCurrentContext()->PlatformImeData.InputPos } : FVector2f::ZeroVector
+		};
+	}
 
-					ImGui::Separator();
-					if (RecordSession.IsValid() == false)
+	void DrawFrame(float DeltaTime, int32& DrawContextIndex, bool& bShowImGuiDemo, bool& bShowPlotDemo)
+	{
+		ContextManager.DrawViewport(DrawContextIndex, DeltaTime);
+
+		if (ImGui::BeginMainMenuBar())
+		{
+			if (ImGui::BeginMenu("ImGui_WS"))
+			{
+				ImGui::Checkbox("ImGui Demo", &bShowImGuiDemo);
+				ImGui::Checkbox("ImPlot Demo", &bShowPlotDemo);
+				ImGui::Checkbox("Pipeline Profiler", &bShowProfiler);
+
+				ImGui::Separator();
+				if (RecordWriter.IsValid() == false)
+				{
+					if (ImGui::Button("Start Record"))
 					{
-						if (ImGui::Button("Start Record"))
+						ImGui::OpenPopup("RecordSettings");
+					}
+					if (ImGui::BeginPopupModal("RecordSettings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+					{
+						static UnrealImGui::FUTF8String SaveFilePath = GRecordSaveDirPathString;
+						ImGui::Text("Save Path:");
+						ImGui::SameLine();
+						ImGui::SetNextItemWidth(600.f);
+						ImGui::InputText("##RecordSavePath", GRecordSaveDirPathString);
+
+						ImGui::SameLine();
+						if (ImGui::ArrowButton("SaveRecordFile", ImGuiDir_Down))
 						{
-							ImGui::OpenPopup("RecordSettings");
+							ImGui::OpenPopup("Select Save Record Directory");
 						}
-						if (ImGui::BeginPopupModal("RecordSettings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
-						{
-							static UnrealImGui::FUTF8String SaveFilePath = GRecordSaveDirPathString;
-							ImGui::Text("Save Path:");
-							ImGui::SameLine();
-							ImGui::SetNextItemWidth(600.f);
-							ImGui::InputText("##RecordSavePath", GRecordSaveDirPathString);
-
-							ImGui::SameLine();
-							if (ImGui::ArrowButton("SaveRecordFile", ImGuiDir_Down))
-							{
-								ImGui::OpenPopup("Select Save Record Directory");
-							}
-							static ImGui::FFileDialogState FileDialogState;
-							ImGui::ShowFileDialog("Select Save Record Directory", FileDialogState, SaveFilePath, nullptr, ImGui::FileDialogType::SelectFolder);
+						static ImGui::FFileDialogState FileDialogState;
+						ImGui::ShowFileDialog("Select Save Record Directory", FileDialogState, SaveFilePath, nullptr, ImGui::FileDialogType::SelectFolder);
 
-							ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 110.f);
-							if (ImGui::Button("Start"))
+						ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 110.f);
+						if (ImGui::Button("Start"))
+						{
+							if (FPaths::DirectoryExists(GRecordSaveDirPathString.ToString()))
 							{
-								if (FPaths::DirectoryExists(GRecordSaveDirPathString.ToString()))
-								{
-									StartRecord();
-									ImGui::InsertNotification(ImGuiToastType_Info, "Start Record ImGui");
-									ImGui::CloseCurrentPopup();
-								}
-								else
-								{
-									ImGui::InsertNotification(ImGuiToastType_Error, "Input Directory Not Exist");
-								}
+								StartRecord();
+								ImGui::InsertNotification(ImGuiToastType_Info, "Start Record ImGui");
+								ImGui::CloseCurrentPopup();
 							}
-							ImGui::SameLine();
-							if (ImGui::Button("Cancel"))
+							else
 							{
-								ImGui::CloseCurrentPopup();
+								ImGui::InsertNotification(ImGuiToastType_Error, "Input Directory Not Exist");
 							}
-
-							ImGui::EndPopup();
 						}
-
-						if (ImGui::Button("Load Record"))
+						ImGui::SameLine();
+						if (ImGui::Button("Cancel"))
 						{
-							ImGui::OpenPopup("ReplaySettings");
+							ImGui::CloseCurrentPopup();
 						}
-						if (ImGui::BeginPopupModal("ReplaySettings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+
+						ImGui::EndPopup();
+					}
+
+					if (ImGui::Button("Load Record"))
+					{
+						ImGui::OpenPopup("ReplaySettings");
+					}
+					if (ImGui::BeginPopupModal("ReplaySettings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+					{
+						static UnrealImGui::FUTF8String LoadFilePath = GRecordSaveDirPathString;
+						ImGui::Text("File Path:");
+						ImGui::SameLine();
+						ImGui::SetNextItemWidth(600.f);
+						ImGui::InputText("##RecordFilePath", LoadFilePath);
+
+						ImGui::SameLine();
+						if (ImGui::ArrowButton("OpenRecordFile", ImGuiDir_Down))
 						{
-							static UnrealImGui::FUTF8String LoadFilePath = GRecordSaveDirPathString;
-							ImGui::Text("File Path:");
-							ImGui::SameLine();
-							ImGui::SetNextItemWidth(600.f);
-							ImGui::InputText("##RecordFilePath", LoadFilePath);
-
-							ImGui::SameLine();
-							if (ImGui::ArrowButton("OpenRecordFile", ImGuiDir_Down))
-							{
-								ImGui::OpenPopup("Load Replay File");
-							}
-							static ImGui::FFileDialogState FileDialogState;
-							ImGui::ShowFileDialog("Load Replay File", FileDialogState, LoadFilePath, ".imgrcd", ImGui::FileDialogType::OpenFile);
+							ImGui::OpenPopup("Load Replay File");
+						}
+						static ImGui::FFileDialogState FileDialogState;
+						ImGui::ShowFileDialog("Load Replay File", FileDialogState, LoadFilePath, ".imgrcd", ImGui::FileDialogType::OpenFile);
 
-							ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100.f);
-							if (ImGui::Button("Load"))
+						ImGui::SetCursorPosX(ImGui::GetWindowWidth() - 100.f);
+						if (ImGui::Button("Load"))
+						{
+							if (FPaths::FileExists(LoadFilePath.ToString()))
 							{
-								if (FPaths::FileExists(LoadFilePath.ToString()))
-								{
-									RecordReplay = MakeUnique<ImGuiWS_Record::FImGuiWS_Replay>(*LoadFilePath);
-									ImGui::CloseCurrentPopup();
-								}
-								else
+								RecordReplay = MakeUnique<ImGuiWS_Record::FImGuiWS_Replay>(LoadFilePath.ToString(), ImGuiWS);
+								if (RecordReplay->IsValid() == false)
 								{
-									ImGui::InsertNotification(ImGuiToastType_Error, "File Not Exist");
+									RecordReplay.Reset();
+									ImGui::InsertNotification(ImGuiToastType_Error, "Invalid Record File");
 								}
+								ImGui::CloseCurrentPopup();
 							}
-							ImGui::SameLine();
-							if (ImGui::Button("Cancel"))
+							else
 							{
-								ImGui::CloseCurrentPopup();
+								ImGui::InsertNotification(ImGuiToastType_Error, "File Not Exist");
 							}
-
-							ImGui::EndPopup();
 						}
-					}
-					else
-					{
-						if (ImGui::Button("End Record"))
+						ImGui::SameLine();
+						if (ImGui::Button("Cancel"))
 						{
-							StopRecord();
+							ImGui::CloseCurrentPopup();
 						}
+
+						ImGui::EndPopup();
 					}
-					ImGui::EndMenu();
 				}
-
-				// imgui-ws info
+				else
 				{
-					const ImVec2 WindowSize = ImGui::GetWindowSize();
-					constexpr float StopRecordButtonWidth = 140.f;
-					float TotalInfoWidth = 140.f;
-					if (RecordSession.IsValid())
+					if (ImGui::Button("End Record"))
 					{
-						TotalInfoWidth += StopRecordButtonWidth;
+						StopRecord();
 					}
-					ImGui::Indent(WindowSize.x - TotalInfoWidth);
+				}
+				ImGui::EndMenu();
+			}
 
-					if (RecordSession.IsValid())
+			// imgui-ws info
+			{
+				const ImVec2 WindowSize = ImGui::GetWindowSize();
+				constexpr float StopRecordButtonWidth = 140.f;
+				float TotalInfoWidth = 140.f;
+				if (RecordWriter.IsValid())
+				{
+					TotalInfoWidth += StopRecordButtonWidth;
+				}
+				ImGui::Indent(WindowSize.x - TotalInfoWidth);
+
+				if (RecordWriter.IsValid())
+				{
+					const ImGuiStyle& Style = ImGui::GetStyle();
+					if (ImGui::Button(TCHAR_TO_UTF8(*FString::Printf(TEXT("Recording (%.0f MB)###StopRecordButton"), RecordWriter->TotalBytes() / 1024.f / 1024.f)), { StopRecordButtonWidth - Style.FramePadding.x * 2.f, 0.f }))
 					{
-						const ImGuiStyle& Style = ImGui::GetStyle();
-						if (ImGui::Button(TCHAR_TO_UTF8(*FString::Printf(TEXT("Recording (%.0f MB)###StopRecordButton"), RecordSession->totalSize_bytes() / 1024.f / 1024.f)), { StopRecordButtonWidth - Style.FramePadding.x * 2.f, 0.f }))
-						{
-							StopRecord();
-						}
-						if (RecordSession.IsValid() && ImGui::BeginItemTooltip())
-						{
-							ImGui::Text("Stop Current Record");
-							ImGui::Text("Record Info:");
-							ImGui::Text("	Frame: %d", RecordSession->nFrames());
-							ImGui::Text("	Size: %.2f MB", RecordSession->totalSize_bytes() / 1024.f / 1024.f);
-							ImGui::EndTooltip();
-						}
+						StopRecord();
 					}
+					if (RecordWriter.IsValid() && ImGui::BeginItemTooltip())
+					{
+						ImGui::Text("Stop Current Record");
+						ImGui::Text("Record Info:");
+						ImGui::Text("	Path: %s", TCHAR_TO_UTF8(*RecordWriter->GetFilePath()));
+						ImGui::Text("	Frame: %d", RecordWriter->NumFrames());
+						ImGui::Text("	Dropped Frame: %d", RecordWriter->NumDroppedFrames());
+						ImGui::Text("	Size: %.2f MB", RecordWriter->TotalBytes() / 1024.f / 1024.f);
+						ImGui::EndTooltip();
+					}
+				}
 
+				{
+					ImGui::Text("Connections: %d", ImGuiWS.NumConnected());
+					if (ImGui::BeginItemTooltip())
 					{
-						ImGui::Text("Connections: %d", ImGuiWS.NumConnected());
-						if (ImGui::BeginItemTooltip())
+						ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+						ImGui::Separator();
+						ImGui::Text(" Id   Ip address");
+						for (auto & [ cid, client ] : State.Clients)
 						{
-							ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
-							ImGui::Separator();
-							ImGui::Text(" Id   Ip address");
-							for (auto & [ cid, client ] : State.Clients)
+							ImGui::Text("%3d : %s", cid, client.IpString.c_str());
+							if (cid == State.CurControlId)
 							{
-								ImGui::Text("%3d : %s", cid, client.IpString.c_str());
-								if (cid == State.CurControlId)
+								ImGui::SameLine();
+								const float ControlledSeconds = ImGui::GetTime() - client.ControlStartTime;
+								if (ControlledSeconds < 60.f)
+								{
+									ImGui::TextDisabled(" [has controlled %.0f seconds]", ControlledSeconds);
+								}
+								else
 								{
-									ImGui::SameLine();
-									const float ControlledSeconds = ImGui::GetTime() - client.ControlStartTime;
-									if (ControlledSeconds < 60.f)
-									{
-										ImGui::TextDisabled(" [has controlled %.0f seconds]", ControlledSeconds);
-									}
-									else
-									{
-										ImGui::TextDisabled(" [has controlled %.1f minutes]", ControlledSeconds / 60.f);
-									}
+									ImGui::TextDisabled(" [has controlled %.1f minutes]", ControlledSeconds / 60.f);
 								}
 							}
-							ImGui::EndTooltip();
 						}
+						ImGui::EndTooltip();
 					}
 				}
-				ImGui::EndMainMenuBar();
-			}
-			// demo
-			if (State.bShowImGuiDemo)
-			{
-				ImGui::ShowDemoWindow(&State.bShowImGuiDemo);
-			}
-			if (State.bShowPlotDemo)
-			{
-				ImPlot::ShowDemoWindow(&State.bShowPlotDemo);
 			}
+			ImGui::EndMainMenuBar();
 		}
-
-	    // generate ImDrawData
-	    ImGui::Render();
-
+		// demo
+		if (bShowImGuiDemo)
 		{
-			// store ImDrawData for asynchronous dispatching to WS clients
-			DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Generate_ImGuiData"), STAT_ImGuiWS_Generate_ImGuiData, STATGROUP_ImGui);
-			const ImDrawData* DrawData = ImGui::GetDrawData();
-			const auto CurControlIp = State.Clients.FindRef(State.CurControlId).Ip;
-			ImGuiDataTripleBuffer.WriteAndSwap(MakeShared<FImGuiData>(DrawData, RecordReplay.Get(),
-				ImGuiWS::FDrawInfo{
-					ImGui::GetMouseCursor(),
-					State.CurControlId,
-					CurControlIp,
-					FVector2f{ ImGui::GetMousePos() },
-					FVector2f{ IO.DisplaySize },
-					IO.WantTextInput,
-					IO.WantTextInput ? FVector2f{ ImGui::GetCurrentContext()->PlatformImeData.InputPos } : FVector2f::ZeroVector
-				}));
+			ImGui::ShowDemoWindow(&bShowImGuiDemo);
 		}
-
-	    ImGui::EndFrame();
-
-		if (CloseRecord)
+		if (bShowPlotDemo)
 		{
-			RecordReplay.Reset();
+			ImPlot::ShowDemoWindow(&bShowPlotDemo);
 		}
+		UnrealImGui::Profiler::DrawWindow(&bShowProfiler);
 	}
 	void WS_ThreadUpdate()
 	{
 		if (ImGuiDataTripleBuffer.IsDirty())
 		{
-			const TSharedPtr<FImGuiData> ImGuiData = ImGuiDataTripleBuffer.SwapAndRead();
+			ImGuiDataTripleBuffer.SwapReadBuffers();
+			const FImGuiFrame& Frame = ImGuiDataTripleBuffer.Read();
 			{
 				DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_SetDrawData"), STAT_ImGuiWS_SetDrawData, STATGROUP_ImGui);
-				ImGuiWS.SetDrawData(&ImGuiData->CopiedDrawData);
-				ImGuiWS.SetDrawInfo(ImGuiData->DrawInfo);
+				UnrealImGui::Profiler::FScope ProfilerScope{ UnrealImGui::Profiler::EGroup::WSThread, TEXT("Encode") };
+				const int32 DrawListEncoding = CVar_ImGui_WS_DrawListEncoding.GetValueOnAnyThread();
+				ImGuiWS.SetDrawListEncoding(DrawListEncoding >= 0 && DrawListEncoding <= 2 ? ImGuiWS::EDrawListEncoding{ DrawListEncoding } : ImGuiWS::EDrawListEncoding::Tessellated);
+				ImGuiWS.SetAdaptiveEncodingBudget(FMath::Max(CVar_ImGui_WS_AdaptiveEncodingBudget.GetValueOnAnyThread(), 0));
+				ImGuiWS.SetTextureBudget(FMath::Max(CVar_ImGui_WS_TextureBudgetMB.GetValueOnAnyThread(), 0) * int64(1024 * 1024));
+
+				TArray<ImGuiWS::FSessionDrawData, TInlineAllocator<8>> SessionsDrawData;
+				for (int32 Idx = 0; Idx < Frame.NumSessions; ++Idx)
+				{
+					const FImGuiData& SessionData = *Frame.Sessions[Idx];
+					SessionsDrawData.Add({ SessionData.ClientId, &SessionData.CopiedDrawData, SessionData.DrawInfo });
+				}
+				ImGuiWS.SetSessionsDrawData(SessionsDrawData);
+				if (Frame.NumSessions == 0)
+				{
+					ImGuiWS.SetDrawData(&Frame.Main.CopiedDrawData);
+					ImGuiWS.SetDrawInfo(Frame.Main.DrawInfo);
+				}
 			}
 
-			if (const auto RecordSessionKeeper = RecordSession)
+			// with sessions the recording follows the first one
+			const FImGuiData& ImGuiData = Frame.NumSessions > 0 ? *Frame.Sessions[0] : Frame.Main;
+
+			TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe> RecordWriterKeeper;
+			TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe> BlackBoxKeeper;
 			{
-				DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Record_AddFrame"), STAT_ImGuiWS_Record_AddFrame, STATGROUP_ImGui);
 				FScopeLock ScopeLock{ &RecordCriticalSection };
-				RecordSessionKeeper->addFrame(&ImGuiData->CopiedDrawData);
+				RecordWriterKeeper = RecordWriter;
+				BlackBoxKeeper = BlackBoxWriter;
+			}
+			if (RecordWriterKeeper || BlackBoxKeeper)
+			{
+				DECLARE_SCOPE_CYCLE_COUNTER(TEXT("ImGuiWS_Record_AddFrame"), STAT_ImGuiWS_Record_AddFrame, STATGROUP_ImGui);
+				// only serializes here, compression and writing happen on the writer threads
+				ImGuiWS_Record::FrameInput Input;
+				Input.mouseX = ImGuiData.DrawInfo.MousePos.X;
+				Input.mouseY = ImGuiData.DrawInfo.MousePos.Y;
+				Input.viewportWidth = ImGuiData.DrawInfo.ViewportSize.X;
+				Input.viewportHeight = ImGuiData.DrawInfo.ViewportSize.Y;
+				Input.mouseCursor = ImGuiData.DrawInfo.MouseCursor;
+				Input.controlId = ImGuiData.DrawInfo.ControlId;
+				Input.nEvents = ImGuiData.InputEvents.Num();
+				std::vector<char> SerializedInput;
+				ImGuiWS_Record::serializeFrameInput(Input, ImGuiData.InputEvents.GetData(), SerializedInput);
+				std::vector<char> SerializedFrame;
+				ImGuiWS_Record::serializeDrawData(&ImGuiData.CopiedDrawData, SerializedFrame);
+
+				if (RecordWriterKeeper && BlackBoxKeeper)
+				{
+					WS_AddRecordFrame(*RecordWriterKeeper, RecordedTextures, ImGuiData.CopiedDrawData, CopyTemp(SerializedFrame), CopyTemp(SerializedInput), ImGuiData.CaptureSeconds);
+				}
+				else if (RecordWriterKeeper)
+				{
+					WS_AddRecordFrame(*RecordWriterKeeper, RecordedTextures, ImGuiData.CopiedDrawData, MoveTemp(SerializedFrame), MoveTemp(SerializedInput), ImGuiData.CaptureSeconds);
+				}
+				if (BlackBoxKeeper)
+				{
+					WS_AddRecordFrame(*BlackBoxKeeper, BlackBoxTextures, ImGuiData.CopiedDrawData, MoveTemp(SerializedFrame), MoveTemp(SerializedInput), ImGuiData.CaptureSeconds);
+				}
 			}
 		}
 		ImGuiWS.Tick();
 	}
 
-	void StartRecord()
+	void WS_AddRecordFrame(ImGuiWS_Record::FImGuiWS_RecordWriter& Writer, FRecordedTextures& Recorded, const ImDrawData& DrawData, std::vector<char>&& SerializedFrame, std::vector<char>&& SerializedInput, double CaptureSeconds)
 	{
-		// TODO：stream save
-		RecordSession = MakeShared<ImGuiWS_Record::Session>();
+		if (Recorded.Writer != &Writer)
+		{
+			Recorded.Writer = &Writer;
+			Recorded.Revisions.Reset();
+			Recorded.Hashes.Reset();
+		}
+		TArray<uint64> MissingHashes;
+		Writer.ConsumeMissingTextures(MissingHashes);
+		if (MissingHashes.Num() > 0)
+		{
+			for (auto It = Recorded.Revisions.CreateIterator(); It; ++It)
+			{
+				const TPair<int32, uint64>* RevisionHash = RecordedTextureHashes.Find(It->Key);
+				if (RevisionHash == nullptr || MissingHashes.Contains(RevisionHash->Value))
+				{
+					It.RemoveCurrent();
+				}
+			}
+			for (const uint64 Hash : MissingHashes)
+			{
+				Recorded.Hashes.Remove(Hash);
+			}
+		}
+		// only the textures this frame draws are captured
+		TSet<ImGuiWS::FTextureId, DefaultKeyFuncs<ImGuiWS::FTextureId>, TInlineSetAllocator<16>> UsedTextureIds;
+		for (const ImDrawList* DrawList : DrawData.CmdLists)
+		{
+			for (const ImDrawCmd& DrawCmd : DrawList->CmdBuffer)
+			{
+				UsedTextureIds.Add(DrawCmd.GetTexID());
+			}
+		}
+
+		// only changed textures are hashed, pixels are only copied for contents the record doesn't have yet
+		TArray<ImGuiWS_Record::FImGuiWS_RecordWriter::FTexture> Textures;
+		TArray<TTuple<ImGuiWS::FTextureId, int32, uint64>, TInlineAllocator<4>> TextureRevisions;
+		ImGuiWS.ForEachTexture([&](ImGuiWS::FTextureId TextureId, const ImGuiWS::FTexture& Texture)
+		{
+			if (UsedTextureIds.Contains(TextureId) == false || Recorded.Revisions.FindRef(TextureId) == Texture.Revision)
+			{
+				return;
+			}
+			const TConstArrayView<uint8> Pixels = Texture.GetPixels();
+			TPair<int32, uint64>* RevisionHash = RecordedTextureHashes.Find(TextureId);
+			if (RevisionHash == nullptr || RevisionHash->Key != Texture.Revision)
+			{
+				FXxHash64Builder HashBuilder;
+				HashBuilder.Update(&Texture.TextureType, sizeof(Texture.TextureType));
+				HashBuilder.Update(&Texture.Width, sizeof(Texture.Width));
+				HashBuilder.Update(&Texture.Height, sizeof(Texture.Height));
+				HashBuilder.Update(Pixels.GetData(), Pixels.Num());
+				RevisionHash = &RecordedTextureHashes.Add(TextureId, { Texture.Revision, HashBuilder.Finalize().Hash });
+			}
+			const uint64 Hash = RevisionHash->Value;
+
+			ImGuiWS_Record::FImGuiWS_RecordWriter::FTexture& RecordTexture = Textures.AddDefaulted_GetRef();
+			RecordTexture.Id = TextureId;
+			RecordTexture.Hash = Hash;
+			RecordTexture.Type = static_cast<int32>(Texture.TextureType);
+			RecordTexture.Width = Texture.Width;
+			RecordTexture.Height = Texture.Height;
+			if (Recorded.Hashes.Contains(Hash) == false)
+			{
+				RecordTexture.Pixels = Pixels;
+			}
+			TextureRevisions.Add({ TextureId, Texture.Revision, Hash });
+		});
+
+		// a dropped frame hands the same textures over again with the next one
+		// pixels the writer left out come back through ConsumeMissingTextures
+		if (Writer.AddSerializedFrame(MoveTemp(SerializedFrame), CaptureSeconds, MoveTemp(SerializedInput), MoveTemp(Textures)))
+		{
+			for (const auto& [TextureId, Revision, Hash] : TextureRevisions)
+			{
+				Recorded.Revisions.Add(TextureId, Revision);
+				Recorded.Hashes.Add(Hash);
+			}
+		}
 	}
-	void StopRecord()
+
+	void UpdateBlackBox()
 	{
-		check(RecordSession.IsValid());
-		const FString SaveDirPath = GRecordSaveDirPathString.ToString();
+		const double Seconds = CVar_ImGui_WS_BlackBoxSeconds.GetValueOnGameThread();
+		const int64 MaxBytes = static_cast<int64>(CVar_ImGui_WS_BlackBoxBudgetMB.GetValueOnGameThread()) * 1024 * 1024;
+		const bool bEnable = Seconds > 0.0 && MaxBytes > 0;
+		if (BlackBoxWriter.IsValid() == bEnable && (bEnable == false || (BlackBoxWriter->GetRingOptions().Seconds == Seconds && BlackBoxWriter->GetRingOptions().MaxBytes == MaxBytes)))
+		{
+			return;
+		}
+		TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe> Writer;
+		if (bEnable)
+		{
+			Writer = MakeShared<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe>(ImGuiWS_Record::FImGuiWS_RecordWriter::FRingOptions{ Seconds, MaxBytes });
+		}
 		FScopeLock ScopeLock{ &RecordCriticalSection };
-		const FString SavePath = FString::Printf(TEXT("%s/%s.imgrcd"), *SaveDirPath, *FDateTime::Now().ToString());
-		if (RecordSession->save(TCHAR_TO_UTF8(*SavePath)))
+		BlackBoxWriter = MoveTemp(Writer);
+	}
+
+	// any thread, Reason ends up in the file name
+	// async dumps are written by the ring writer thread, the caller only waits for the snapshot
+	bool DumpBlackBox(const TCHAR* Reason, bool bForce, bool bAsync)
+	{
+		TSharedPtr<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe> Writer;
+		{
+			FScopeLock ScopeLock{ &RecordCriticalSection };
+			const double CurSeconds = FPlatformTime::Seconds();
+			if (BlackBoxWriter.IsValid() == false || (bForce == false && LastBlackBoxDumpSeconds >= 0.0 && CurSeconds - LastBlackBoxDumpSeconds < BlackBoxDumpInterval))
+			{
+				return false;
+			}
+			LastBlackBoxDumpSeconds = CurSeconds;
+			Writer = BlackBoxWriter;
+		}
+		const FString DumpPath = FString::Printf(TEXT("%s/BlackBox_%s_%s.imgrcd"), *GRecordSaveDirPathString.ToString(), Reason, *FDateTime::Now().ToString());
+		if (bAsync)
+		{
+			return Writer->DumpRingAsync(DumpPath);
+		}
+		if (Writer->DumpRing(DumpPath) == false)
 		{
-			RecordSession.Reset();
+			return false;
+		}
+		UE_LOG(LogImGui, Warning, TEXT("ImGui-WS black box record saved to %s"), *DumpPath);
+		return true;
+	}
 
-			ImGui::InsertNotification(ImGuiToastType_Success, "Save Record To:\n%s", TCHAR_TO_UTF8(*SavePath));
+	void StartRecord()
+	{
+		const FString SaveDirPath = GRecordSaveDirPathString.ToString();
+		const FString SavePath = FString::Printf(TEXT("%s/%s.imgrcd"), *SaveDirPath, *FDateTime::Now().ToString());
+		auto Writer = MakeShared<ImGuiWS_Record::FImGuiWS_RecordWriter, ESPMode::ThreadSafe>(SavePath);
+		if (Writer->IsValid() == false)
+		{
+			ImGui::InsertNotification(ImGuiToastType_Error, "Can't Create Record File:\n%s", TCHAR_TO_UTF8(*SavePath));
+			return;
 		}
+		FScopeLock ScopeLock{ &RecordCriticalSection };
+		RecordWriter = MoveTemp(Writer);
+	}
+	void StopRecord()
+	{
+		check(RecordWriter.IsValid());
+		FScopeLock ScopeLock{ &RecordCriticalSection };
+		RecordWriter->RequestClose();
+		ClosingRecordWriters.Add(MoveTemp(RecordWriter));
 	}
 };
 
@@ -944,7 +1685,7 @@ int32 UImGui_WS_Manager::GetConnectionCount() const
 
 bool UImGui_WS_Manager::IsRecording() const
 {
-	if (Impl && Impl->RecordSession)
+	if (Impl && Impl->RecordWriter)
 	{
 		return true;
 	}
@@ -953,7 +1694,7 @@ bool UImGui_WS_Manager::IsRecording() const
 
 void UImGui_WS_Manager::StartRecord()
 {
-	if (Impl && Impl->RecordSession.IsValid() == false)
+	if (Impl && Impl->RecordWriter.IsValid() == false)
 	{
 		Impl->StartRecord();
 	}
@@ -961,12 +1702,17 @@ void UImGui_WS_Manager::StartRecord()
 
 void UImGui_WS_Manager::StopRecord()
 {
-	if (Impl && Impl->RecordSession.IsValid())
+	if (Impl && Impl->RecordWriter.IsValid())
 	{
 		Impl->StopRecord();
 	}
 }
 
+bool UImGui_WS_Manager::DumpBlackBox()
+{
+	return Impl && Impl->DumpBlackBox(TEXT("Manual"), true, true);
+}
+
 void UImGui_WS_Manager::Initialize(FSubsystemCollectionBase& Collection)
 {
 	Super::Initialize(Collection);
@@ -0,0 +1,418 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImGuiWS_RecordReader.h"
+
+#include "UnrealImGui_Log.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+
+namespace ImGuiWS_Record
+{
+FImGuiWS_RecordReader::FImGuiWS_RecordReader() = default;
+FImGuiWS_RecordReader::~FImGuiWS_RecordReader() = default;
+
+bool FImGuiWS_RecordReader::Open(const FString& FilePath)
+{
+	Frames.Reset();
+	TextureOffsets.Reset();
+	TextureBindings.Reset();
+	DecodedFrameIndex = INDEX_NONE;
+	MappedRegion.Reset();
+	MappedFile.Reset();
+	FileData.Empty();
+	FileView = nullptr;
+	FileSize = 0;
+
+	MappedFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*FilePath));
+	if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+	if (MappedRegion.IsValid())
+	{
+		FileView = MappedRegion->GetMappedPtr();
+		FileSize = MappedRegion->GetMappedSize();
+	}
+	else if (FFileHelper::LoadFileToArray(FileData, *FilePath))
+	{
+		FileView = FileData.GetData();
+		FileSize = FileData.Num();
+	}
+	else
+	{
+		UE_LOG(LogImGui, Error, TEXT("Failed to load record file %s"), *FilePath);
+		return false;
+	}
+
+	// all versions share the header length
+	const int64 HeaderSize = FCStringAnsi::Strlen(kHeaderV1_0);
+	if (FileSize < HeaderSize)
+	{
+		return false;
+	}
+	const char* Header = reinterpret_cast<const char*>(FileView);
+	bLegacy = FCStringAnsi::Strncmp(Header, kHeaderV1_0, HeaderSize) == 0;
+	if (bLegacy)
+	{
+		return ParseV1_0(HeaderSize);
+	}
+	if (FCStringAnsi::Strncmp(Header, kHeaderV1_1, HeaderSize) == 0 || FCStringAnsi::Strncmp(Header, kHeaderV2, HeaderSize) == 0)
+	{
+		if (ParseIndex() == false && ParseRecords(HeaderSize) == false)
+		{
+			return false;
+		}
+		if (GetDuration() <= 0.0)
+		{
+			SetDefaultFrameTimes();
+		}
+		return true;
+	}
+	UE_LOG(LogImGui, Error, TEXT("%s isn't a record file"), *FilePath);
+	return false;
+}
+
+bool FImGuiWS_RecordReader::ParseV1_0(int64 Offset)
+{
+	// only hops over the size prefixes
+	uint32 NumFrames = 0;
+	if (Offset + sizeof(NumFrames) > FileSize)
+	{
+		return false;
+	}
+	FMemory::Memcpy(&NumFrames, FileView + Offset, sizeof(NumFrames));
+	Offset += sizeof(NumFrames);
+
+	Frames.Reserve(NumFrames);
+	for (uint32 Idx = 0; Idx < NumFrames && Offset + sizeof(uint32) <= FileSize; ++Idx)
+	{
+		uint32 Size = 0;
+		FMemory::Memcpy(&Size, FileView + Offset, sizeof(Size));
+		if (Offset + sizeof(Size) + Size > FileSize)
+		{
+			break;
+		}
+		Frames.Add({ Offset, Frames.Num(), 0.0 });
+		Offset += sizeof(Size) + Size;
+	}
+	SetDefaultFrameTimes();
+	return Frames.Num() > 0;
+}
+
+bool FImGuiWS_RecordReader::ParseIndex()
+{
+	Trailer FileTrailer;
+	if (FileSize < static_cast<int64>(sizeof(FileTrailer)))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&FileTrailer, FileView + FileSize - sizeof(FileTrailer), sizeof(FileTrailer));
+	if (FileTrailer.magic != kTrailerMagic || FileTrailer.indexOffset + sizeof(RecordHeader) + 2 * sizeof(uint32) > static_cast<uint64>(FileSize))
+	{
+		return false;
+	}
+
+	RecordHeader Header;
+	const uint8* Data = FileView + FileTrailer.indexOffset;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	Data += sizeof(Header);
+	uint32 NumFrames = 0;
+	uint32 EntrySize = 0;
+	FMemory::Memcpy(&NumFrames, Data, sizeof(NumFrames));
+	FMemory::Memcpy(&EntrySize, Data + sizeof(NumFrames), sizeof(EntrySize));
+	Data += sizeof(NumFrames) + sizeof(EntrySize);
+	if (Header.type != static_cast<uint32>(RecordType::Index) || EntrySize < sizeof(uint64) || Data + static_cast<uint64>(NumFrames) * EntrySize > FileView + FileSize)
+	{
+		return false;
+	}
+
+	// older writers have smaller entries, the missing fields keep their defaults
+	Frames.SetNumUninitialized(NumFrames);
+	for (uint32 Idx = 0; Idx < NumFrames; ++Idx)
+	{
+		IndexEntry Entry;
+		Entry.keyframe = Idx;
+		FMemory::Memcpy(&Entry, Data + static_cast<uint64>(Idx) * EntrySize, FMath::Min<uint32>(EntrySize, sizeof(Entry)));
+		if (Entry.offset >= FileTrailer.indexOffset || Entry.keyframe > Idx)
+		{
+			Frames.Reset();
+			return false;
+		}
+		Frames[Idx] = { static_cast<int64>(Entry.offset), static_cast<int32>(Entry.keyframe), Entry.time };
+	}
+
+	// records without textures end after the frame entries
+	const uint8* IndexEnd = FileView + FileTrailer.indexOffset + sizeof(Header) + Header.size;
+	Data += static_cast<uint64>(NumFrames) * EntrySize;
+	uint32 NumTextures = 0;
+	if (Data + sizeof(NumTextures) + sizeof(EntrySize) <= IndexEnd)
+	{
+		FMemory::Memcpy(&NumTextures, Data, sizeof(NumTextures));
+		FMemory::Memcpy(&EntrySize, Data + sizeof(NumTextures), sizeof(EntrySize));
+		Data += sizeof(NumTextures) + sizeof(EntrySize);
+		if (EntrySize < sizeof(TextureIndexEntry) || Data + static_cast<uint64>(NumTextures) * EntrySize > IndexEnd)
+		{
+			NumTextures = 0;
+		}
+	}
+	for (uint32 Idx = 0; Idx < NumTextures; ++Idx)
+	{
+		TextureIndexEntry Entry;
+		FMemory::Memcpy(&Entry, Data + static_cast<uint64>(Idx) * EntrySize, sizeof(Entry));
+		TextureOffsets.Add(Entry.hash, Entry.offset);
+	}
+	return Frames.Num() > 0;
+}
+
+bool FImGuiWS_RecordReader::ParseRecords(int64 Offset)
+{
+	// no trailer when the recording was cut off, hop over the record headers instead
+	// a partial last record is dropped, the complete ones are kept
+	int32 Keyframe = INDEX_NONE;
+	int64 GroupOffset = INDEX_NONE;
+	double Time = 0.0;
+	while (Offset + sizeof(RecordHeader) <= FileSize)
+	{
+		RecordHeader Header;
+		FMemory::Memcpy(&Header, FileView + Offset, sizeof(Header));
+		if (Header.type == static_cast<uint32>(RecordType::Index) || Offset + sizeof(Header) + Header.size > FileSize)
+		{
+			break;
+		}
+		if (GroupOffset == INDEX_NONE)
+		{
+			GroupOffset = Offset;
+		}
+
+		switch (static_cast<RecordType>(Header.type))
+		{
+		case RecordType::Frame:
+		case RecordType::Keyframe:
+			Keyframe = Frames.Num();
+			Frames.Add({ GroupOffset, Keyframe, Time });
+			GroupOffset = INDEX_NONE;
+			break;
+		case RecordType::Delta:
+			if (Keyframe == INDEX_NONE)
+			{
+				return false;
+			}
+			Frames.Add({ GroupOffset, Keyframe, Time });
+			GroupOffset = INDEX_NONE;
+			break;
+		case RecordType::FrameTime:
+			if (Header.size == sizeof(Time))
+			{
+				FMemory::Memcpy(&Time, FileView + Offset + sizeof(Header), sizeof(Time));
+			}
+			break;
+		case RecordType::Texture:
+			if (Header.size >= sizeof(TextureHeader))
+			{
+				uint64 Hash;
+				FMemory::Memcpy(&Hash, FileView + Offset + sizeof(Header), sizeof(Hash));
+				TextureOffsets.Add(Hash, Offset);
+			}
+			break;
+		default:
+			// unknown records are skipped, newer writers can add side channels
+			break;
+		}
+		Offset += sizeof(Header) + Header.size;
+	}
+	return Frames.Num() > 0;
+}
+
+void FImGuiWS_RecordReader::SetDefaultFrameTimes()
+{
+	for (int32 Idx = 0; Idx < Frames.Num(); ++Idx)
+	{
+		Frames[Idx].Time = Idx / 60.0;
+	}
+}
+
+int32 FImGuiWS_RecordReader::FindFrame(double Time) const
+{
+	const int32 Idx = Algo::UpperBoundBy(Frames, Time, &FFrame::Time) - 1;
+	return FMath::Clamp(Idx, 0, Frames.Num() - 1);
+}
+
+bool FImGuiWS_RecordReader::ForEachRecord(int32 FrameIndex, TFunctionRef<void(RecordType Type, const uint8* Data, uint32 Size)> Func) const
+{
+	int64 Offset = Frames[FrameIndex].Offset;
+	if (bLegacy)
+	{
+		uint32 Size = 0;
+		FMemory::Memcpy(&Size, FileView + Offset, sizeof(Size));
+		Func(RecordType::Frame, FileView + Offset + sizeof(Size), Size);
+		return true;
+	}
+
+	while (Offset + sizeof(RecordHeader) <= FileSize)
+	{
+		RecordHeader Header;
+		FMemory::Memcpy(&Header, FileView + Offset, sizeof(Header));
+		Offset += sizeof(Header);
+		if (Offset + Header.size > FileSize)
+		{
+			return false;
+		}
+		const RecordType Type = static_cast<RecordType>(Header.type);
+		Func(Type, FileView + Offset, Header.size);
+		if (Type == RecordType::Frame || Type == RecordType::Keyframe || Type == RecordType::Delta)
+		{
+			return true;
+		}
+		Offset += Header.size;
+	}
+	return false;
+}
+
+bool FImGuiWS_RecordReader::DecodePayload(const uint8* Data, uint32 Size, std::vector<char>& OutFrame) const
+{
+	uint32 RawSize = 0;
+	if (Size < sizeof(RawSize))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&RawSize, Data, sizeof(RawSize));
+	const uint32 CompressedSize = Size - sizeof(RawSize);
+	OutFrame.resize(RawSize);
+	if (CompressedSize == RawSize)
+	{
+		FMemory::Memcpy(OutFrame.data(), Data + sizeof(RawSize), RawSize);
+		return true;
+	}
+	return FCompression::UncompressMemory(NAME_LZ4, OutFrame.data(), RawSize, Data + sizeof(RawSize), CompressedSize);
+}
+
+TConstArrayView<char> FImGuiWS_RecordReader::DecodeFrame(int32 FrameIndex)
+{
+	if (Frames.IsValidIndex(FrameIndex) == false)
+	{
+		return {};
+	}
+	if (FrameIndex == DecodedFrameIndex)
+	{
+		return DecodedView;
+	}
+
+	int32 StartIndex = Frames[FrameIndex].Keyframe;
+	if (DecodedFrameIndex >= StartIndex && DecodedFrameIndex < FrameIndex)
+	{
+		StartIndex = DecodedFrameIndex + 1;
+	}
+	else
+	{
+		// the keyframe group binds all textures again
+		TextureBindings.Reset();
+	}
+	for (int32 Idx = StartIndex; Idx <= FrameIndex; ++Idx)
+	{
+		bool bDecoded = false;
+		const bool bFound = ForEachRecord(Idx, [this, &bDecoded](RecordType Type, const uint8* Data, uint32 Size)
+		{
+			switch (Type)
+			{
+			case RecordType::Frame:
+				// stored uncompressed, read straight from the file
+				DecodedView = { reinterpret_cast<const char*>(Data), static_cast<int32>(Size) };
+				bDecoded = true;
+				break;
+			case RecordType::Keyframe:
+				bDecoded = DecodePayload(Data, Size, DecodedFrame);
+				DecodedView = { DecodedFrame.data(), static_cast<int32>(DecodedFrame.size()) };
+				break;
+			case RecordType::Delta:
+				if (DecodedView.GetData() != DecodedFrame.data())
+				{
+					DecodedFrame.assign(DecodedView.GetData(), DecodedView.GetData() + DecodedView.Num());
+				}
+				bDecoded = DecodePayload(Data, Size, DeltaFrame);
+				xorFrame(DeltaFrame, DecodedFrame);
+				Swap(DecodedFrame, DeltaFrame);
+				DecodedView = { DecodedFrame.data(), static_cast<int32>(DecodedFrame.size()) };
+				break;
+			case RecordType::TextureBind:
+				if (Size == sizeof(TextureBinding))
+				{
+					TextureBinding Binding;
+					FMemory::Memcpy(&Binding, Data, sizeof(Binding));
+					TextureBindings.Add(Binding.id, Binding.hash);
+				}
+				break;
+			default: ;
+			}
+		});
+		if (bFound == false || bDecoded == false)
+		{
+			UE_LOG(LogImGui, Error, TEXT("Failed to decode record frame %d"), Idx);
+			DecodedFrameIndex = INDEX_NONE;
+			DecodedView = {};
+			return {};
+		}
+		DecodedFrameIndex = Idx;
+	}
+	return DecodedView;
+}
+
+bool FImGuiWS_RecordReader::GetFrameInput(int32 FrameIndex, FrameInput& OutInput, std::vector<InputEvent>& OutEvents) const
+{
+	if (Frames.IsValidIndex(FrameIndex) == false)
+	{
+		return false;
+	}
+	bool bFound = false;
+	ForEachRecord(FrameIndex, [&](RecordType Type, const uint8* Data, uint32 Size)
+	{
+		if (Type == RecordType::FrameInput)
+		{
+			bFound = unserializeFrameInput(OutInput, OutEvents, reinterpret_cast<const char*>(Data), Size);
+		}
+	});
+	return bFound;
+}
+
+bool FImGuiWS_RecordReader::GetTexture(uint64 Hash, TextureHeader& OutHeader, TArray<uint8>& OutPixels) const
+{
+	const int64* Offset = TextureOffsets.Find(Hash);
+	if (Offset == nullptr || *Offset + sizeof(RecordHeader) + sizeof(TextureHeader) > FileSize)
+	{
+		return false;
+	}
+	RecordHeader Header;
+	FMemory::Memcpy(&Header, FileView + *Offset, sizeof(Header));
+	if (Header.type != static_cast<uint32>(RecordType::Texture) || Header.size < sizeof(TextureHeader) || *Offset + sizeof(Header) + Header.size > FileSize)
+	{
+		return false;
+	}
+	const uint8* Data = FileView + *Offset + sizeof(Header);
+	FMemory::Memcpy(&OutHeader, Data, sizeof(OutHeader));
+	const uint32 CompressedSize = Header.size - sizeof(OutHeader);
+	OutPixels.SetNumUninitialized(OutHeader.rawSize);
+	if (CompressedSize == OutHeader.rawSize)
+	{
+		FMemory::Memcpy(OutPixels.GetData(), Data + sizeof(OutHeader), CompressedSize);
+		return true;
+	}
+	return FCompression::UncompressMemory(NAME_LZ4, OutPixels.GetData(), OutHeader.rawSize, Data + sizeof(OutHeader), CompressedSize);
+}
+
+bool FImGuiWS_RecordReader::GetFrame(int32 FrameIndex, ImDrawData& OutHeader, TArray<DrawListView>& OutLists)
+{
+	OutLists.Reset();
+	const TConstArrayView<char> Frame = DecodeFrame(FrameIndex);
+	if (Frame.Num() == 0)
+	{
+		return false;
+	}
+	return viewDrawData(&OutHeader, Frame.GetData(), Frame.Num(), [&OutLists](const DrawListView& View)
+	{
+		OutLists.Add(View);
+	});
+}
+}
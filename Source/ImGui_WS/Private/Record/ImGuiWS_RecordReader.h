@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "imgui-ws-record.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+namespace ImGuiWS_Record
+{
+// reads v1.0, v1.1 and v2 .imgrcd files, frames are decoded on request
+// the file is memory mapped and only the frame offsets are kept, large records open without loading them
+class FImGuiWS_RecordReader
+{
+public:
+	FImGuiWS_RecordReader();
+	~FImGuiWS_RecordReader();
+
+	bool Open(const FString& FilePath);
+
+	int32 NumFrames() const { return Frames.Num(); }
+	int64 TotalBytes() const { return FileSize; }
+
+	// seconds since the first frame, records without timestamps are played at 60 fps
+	double GetFrameTime(int32 FrameIndex) const { return Frames[FrameIndex].Time; }
+	double GetDuration() const { return Frames.Num() > 0 ? Frames.Last().Time : 0.0; }
+	// the last frame captured at or before Time
+	int32 FindFrame(double Time) const;
+
+	// serialized frame, decoding starts at the keyframe unless the frame follows the last decoded one
+	// uncompressed frames point into the mapped file, the view is valid until the next decode, empty on failure
+	TConstArrayView<char> DecodeFrame(int32 FrameIndex);
+	// the header fields of the frame and views of its lists, nothing is copied
+	bool GetFrame(int32 FrameIndex, ImDrawData& OutHeader, TArray<DrawListView>& OutLists);
+	// false when the frame has no recorded input
+	bool GetFrameInput(int32 FrameIndex, FrameInput& OutInput, std::vector<InputEvent>& OutEvents) const;
+
+	// texture id to content hash as of the last decoded frame, empty for records without textures
+	const TMap<uint32, uint64>& GetTextureBindings() const { return TextureBindings; }
+	bool GetTexture(uint64 Hash, TextureHeader& OutHeader, TArray<uint8>& OutPixels) const;
+private:
+	bool ParseV1_0(int64 Offset);
+	bool ParseIndex();
+	bool ParseRecords(int64 Offset);
+	bool DecodePayload(const uint8* Data, uint32 Size, std::vector<char>& OutFrame) const;
+	// visits the side channel records of the frame group and finally the frame record
+	bool ForEachRecord(int32 FrameIndex, TFunctionRef<void(RecordType Type, const uint8* Data, uint32 Size)> Func) const;
+	void SetDefaultFrameTimes();
+
+	struct FFrame
+	{
+		// the first record of the frame group, the frame size for v1.0
+		int64 Offset;
+		int32 Keyframe;
+		double Time;
+	};
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// used where the platform can't map files
+	TArray64<uint8> FileData;
+	const uint8* FileView = nullptr;
+	int64 FileSize = 0;
+	bool bLegacy = false;
+	TArray<FFrame> Frames;
+
+	TMap<uint64, int64> TextureOffsets;
+	TMap<uint32, uint64> TextureBindings;
+
+	int32 DecodedFrameIndex = INDEX_NONE;
+	TConstArrayView<char> DecodedView;
+	std::vector<char> DecodedFrame;
+	std::vector<char> DeltaFrame;
+};
+}
@@ -0,0 +1,484 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImGuiWS_RecordWriter.h"
+
+#include "UnrealImGui_Log.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Compression.h"
+#include "Misc/ScopeExit.h"
+
+namespace ImGuiWS_Record
+{
+FImGuiWS_RecordWriter::FImGuiWS_RecordWriter(const FString& FilePath, int64 MaxQueuedBytes)
+	: FilePath(FilePath)
+	, MaxQueuedBytes(MaxQueuedBytes)
+{
+	FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*FilePath));
+	if (FileHandle.IsValid() == false)
+	{
+		UE_LOG(LogImGui, Error, TEXT("Failed to open record file %s"), *FilePath);
+		return;
+	}
+	FileHandle->Write(reinterpret_cast<const uint8*>(kHeaderV2), FCStringAnsi::Strlen(kHeaderV2));
+	WrittenBytes = FileHandle->Tell();
+
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("ImGuiWS_RecordWriter"), 0, TPri_BelowNormal);
+}
+
+FImGuiWS_RecordWriter::FImGuiWS_RecordWriter(const FRingOptions& RingOptions, int64 MaxQueuedBytes)
+	: MaxQueuedBytes(MaxQueuedBytes)
+	, bRing(true)
+	, RingOptions(RingOptions)
+	, RingOutput(&GroupData)
+{
+	WakeUpEvent = FPlatformProcess::GetSynchEventFromPool();
+	Thread = FRunnableThread::Create(this, TEXT("ImGuiWS_RecordRing"), 0, TPri_BelowNormal);
+}
+
+FImGuiWS_RecordWriter::~FImGuiWS_RecordWriter()
+{
+	if (Thread)
+	{
+		RequestClose();
+		Thread->WaitForCompletion();
+		delete Thread;
+	}
+	if (WakeUpEvent)
+	{
+		FPlatformProcess::ReturnSynchEventToPool(WakeUpEvent);
+	}
+}
+
+bool FImGuiWS_RecordWriter::AddFrame(const ImDrawData* DrawData, double CaptureSeconds, std::vector<char>&& Input, TArray<FTexture>&& Textures)
+{
+	if (IsValid() == false || bCloseRequested)
+	{
+		return false;
+	}
+
+	std::vector<char> Frame;
+	serializeDrawData(DrawData, Frame);
+	return AddSerializedFrame(MoveTemp(Frame), CaptureSeconds, MoveTemp(Input), MoveTemp(Textures));
+}
+
+bool FImGuiWS_RecordWriter::AddSerializedFrame(std::vector<char>&& Frame, double CaptureSeconds, std::vector<char>&& Input, TArray<FTexture>&& Textures)
+{
+	// counted before the close check, a close requested after it waits for this frame
+	NumAddingFrames += 1;
+	ON_SCOPE_EXIT { NumAddingFrames -= 1; };
+	if (IsValid() == false || bCloseRequested)
+	{
+		return false;
+	}
+
+	// texture pixels don't count against the frames, large contents would otherwise drop every frame handing them over
+	const int64 FrameSize = Frame.size() + Input.size();
+	if (FrameSize > MaxQueuedBytes - QueuedBytes)
+	{
+		NumDropped += 1;
+		UE_LOG(LogImGui, Verbose, TEXT("Record writer can't keep up, frame dropped"));
+		return false;
+	}
+	// pixels over their own budget are left out, the frame keeps the previous content until they come again
+	// a content larger than the whole budget still goes alone, it would be handed over forever otherwise
+	int64 TextureSize = 0;
+	for (FTexture& Texture : Textures)
+	{
+		const int64 PendingTextureBytes = QueuedTextureBytes + TextureSize;
+		if (PendingTextureBytes > 0 && Texture.Pixels.Num() > MaxQueuedBytes - PendingTextureBytes)
+		{
+			UE_LOG(LogImGui, Verbose, TEXT("Record writer can't keep up, texture %u handed over again later"), Texture.Id);
+			Texture.Pixels.Empty();
+			AddMissingTexture(Texture.Hash);
+		}
+		TextureSize += Texture.Pixels.Num();
+	}
+
+	if (FirstCaptureSeconds < 0.0)
+	{
+		FirstCaptureSeconds = CaptureSeconds;
+	}
+	QueuedBytes += FrameSize;
+	QueuedTextureBytes += TextureSize;
+	NumAddedFrames += 1;
+	Queue.Enqueue({ MoveTemp(Frame), CaptureSeconds - FirstCaptureSeconds, MoveTemp(Input), MoveTemp(Textures), FrameSize, TextureSize });
+	WakeUpEvent->Trigger();
+	return true;
+}
+
+void FImGuiWS_RecordWriter::RequestClose()
+{
+	if (bCloseRequested.exchange(true) == false && WakeUpEvent)
+	{
+		WakeUpEvent->Trigger();
+	}
+}
+
+uint32 FImGuiWS_RecordWriter::Run()
+{
+	while (true)
+	{
+		// read before draining, frames queued before the request are still written
+		const bool bClosing = bCloseRequested;
+		if (bClosing)
+		{
+			// a frame that passed the close check may not be queued yet
+			while (NumAddingFrames > 0)
+			{
+				FPlatformProcess::YieldThread();
+			}
+		}
+
+		FQueuedFrame Frame;
+		while (Queue.Dequeue(Frame))
+		{
+			WriteFrame(Frame);
+			QueuedBytes -= Frame.Size;
+			QueuedTextureBytes -= Frame.TextureSize;
+		}
+		TPair<FString, FRingSnapshot> DumpRequest;
+		while (DumpRequests.Dequeue(DumpRequest))
+		{
+			if (WriteRingSnapshot(DumpRequest.Value, DumpRequest.Key))
+			{
+				UE_LOG(LogImGui, Warning, TEXT("ImGui-WS black box record saved to %s"), *DumpRequest.Key);
+			}
+		}
+		// complete records survive a crash
+		if (FileHandle)
+		{
+			FileHandle->Flush();
+		}
+
+		if (bClosing)
+		{
+			break;
+		}
+		WakeUpEvent->Wait(100);
+	}
+
+	if (FileHandle)
+	{
+		WriteIndex(*FileHandle, Index, TextureOffsets);
+		WrittenBytes = FileHandle->Tell();
+		FileHandle.Reset();
+	}
+	bClosed = true;
+	return 0;
+}
+
+void FImGuiWS_RecordWriter::WriteFrame(FQueuedFrame& QueuedFrame)
+{
+	std::vector<char>& Frame = QueuedFrame.Data;
+	const int32 FrameIndex = NumWrittenFrames++;
+	const bool bKeyframe = FrameIndex % KeyframeInterval == 0;
+	const uint32 Keyframe = FrameIndex - FrameIndex % KeyframeInterval;
+	if (bRing)
+	{
+		GroupData.Reset();
+		GroupTextures.Reset();
+	}
+	else
+	{
+		Index.Add({ static_cast<uint64>(Tell()), Keyframe, 0, QueuedFrame.Time });
+	}
+	WriteRecord(RecordType::FrameTime, &QueuedFrame.Time, sizeof(QueuedFrame.Time));
+	if (QueuedFrame.Input.empty() == false)
+	{
+		WriteRecord(RecordType::FrameInput, QueuedFrame.Input.data(), QueuedFrame.Input.size());
+	}
+	WriteTextures(QueuedFrame.Textures, bKeyframe);
+
+	// unchanged bytes become zeros, xor again afterwards to keep the plain frame for the next delta
+	if (bKeyframe == false)
+	{
+		xorFrame(Frame, PrevFrame);
+	}
+
+	const uint32 RawSize = Frame.size();
+	WriteCompressedRecord(bKeyframe ? RecordType::Keyframe : RecordType::Delta, &RawSize, sizeof(RawSize), Frame.data(), RawSize);
+
+	if (bKeyframe == false)
+	{
+		xorFrame(Frame, PrevFrame);
+	}
+	Swap(PrevFrame, Frame);
+
+	if (bRing)
+	{
+		AddRingFrame(QueuedFrame.Time, bKeyframe);
+	}
+}
+
+void FImGuiWS_RecordWriter::WriteTextures(TArray<FTexture>& Textures, bool bKeyframe)
+{
+	for (FTexture& Texture : Textures)
+	{
+		WriteTextureContent(Texture);
+		// a content never stored can't be bound, the previous content stays until the pixels come again
+		if (TextureOffsets.Contains(Texture.Hash) == false)
+		{
+			AddMissingTexture(Texture.Hash);
+		}
+		else
+		{
+			TextureBindings.Add(Texture.Id, Texture.Hash);
+			GroupTextures.Add(Texture.Hash);
+			if (bKeyframe == false)
+			{
+				const TextureBinding Binding{ Texture.Id, 0, Texture.Hash };
+				WriteRecord(RecordType::TextureBind, &Binding, sizeof(Binding));
+			}
+		}
+	}
+	if (bKeyframe)
+	{
+		for (const auto& [Id, Hash] : TextureBindings)
+		{
+			GroupTextures.Add(Hash);
+			const TextureBinding Binding{ Id, 0, Hash };
+			WriteRecord(RecordType::TextureBind, &Binding, sizeof(Binding));
+		}
+	}
+}
+
+void FImGuiWS_RecordWriter::WriteTextureContent(FTexture& Texture)
+{
+	if (Texture.Pixels.Num() == 0 || TextureOffsets.Contains(Texture.Hash))
+	{
+		return;
+	}
+	// ring writers keep the record aside, dumps only write the contents their frames bind
+	TArray<uint8> RingRecord;
+	if (bRing)
+	{
+		RingOutput = &RingRecord;
+	}
+	TextureOffsets.Add(Texture.Hash, Tell());
+	const TextureHeader Header{ Texture.Hash, Texture.Type, Texture.Width, Texture.Height, static_cast<uint32>(Texture.Pixels.Num()) };
+	WriteCompressedRecord(RecordType::Texture, &Header, sizeof(Header), Texture.Pixels.GetData(), Header.rawSize);
+	if (bRing)
+	{
+		RingOutput = &GroupData;
+		FScopeLock ScopeLock{ &RingLock };
+		RingTextureBytes += RingRecord.Num();
+		RingTextures.Add(Texture.Hash, { MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(MoveTemp(RingRecord)), 0 });
+	}
+}
+
+void FImGuiWS_RecordWriter::WriteCompressedRecord(RecordType Type, const void* Prefix, uint32 PrefixSize, const void* Data, uint32 RawSize)
+{
+	Payload.SetNumUninitialized(PrefixSize + FCompression::CompressMemoryBound(NAME_LZ4, RawSize));
+	FMemory::Memcpy(Payload.GetData(), Prefix, PrefixSize);
+	int32 CompressedSize = Payload.Num() - PrefixSize;
+	if (FCompression::CompressMemory(NAME_LZ4, Payload.GetData() + PrefixSize, CompressedSize, Data, RawSize) == false || CompressedSize >= static_cast<int32>(RawSize))
+	{
+		// stored as is, readers detect it by the equal sizes
+		CompressedSize = RawSize;
+		FMemory::Memcpy(Payload.GetData() + PrefixSize, Data, RawSize);
+	}
+	WriteRecord(Type, Payload.GetData(), PrefixSize + CompressedSize);
+}
+
+void FImGuiWS_RecordWriter::WriteRecord(RecordType Type, const void* Data, uint32 Size)
+{
+	const RecordHeader Header{ static_cast<uint32_t>(Type), Size };
+	Write(&Header, sizeof(Header));
+	Write(Data, Size);
+}
+
+void FImGuiWS_RecordWriter::Write(const void* Data, int64 Size)
+{
+	if (RingOutput)
+	{
+		RingOutput->Append(static_cast<const uint8*>(Data), Size);
+		return;
+	}
+	FileHandle->Write(static_cast<const uint8*>(Data), Size);
+	WrittenBytes += Size;
+}
+
+int64 FImGuiWS_RecordWriter::Tell() const
+{
+	return RingOutput ? RingOutput->Num() : FileHandle->Tell();
+}
+
+void FImGuiWS_RecordWriter::WriteIndex(IFileHandle& File, const TArray<IndexEntry>& Index, const TMap<uint64, uint64>& TextureOffsets)
+{
+	std::vector<char> Data;
+	serialize(static_cast<uint32_t>(Index.Num()), Data);
+	serialize(static_cast<uint32_t>(sizeof(IndexEntry)), Data);
+	for (const IndexEntry& Entry : Index)
+	{
+		serialize(Entry, Data);
+	}
+	serialize(static_cast<uint32_t>(TextureOffsets.Num()), Data);
+	serialize(static_cast<uint32_t>(sizeof(TextureIndexEntry)), Data);
+	for (const auto& [Hash, Offset] : TextureOffsets)
+	{
+		serialize(TextureIndexEntry{ Hash, Offset }, Data);
+	}
+
+	const Trailer FileTrailer{ static_cast<uint64_t>(File.Tell()), kTrailerMagic };
+	const RecordHeader Header{ static_cast<uint32_t>(RecordType::Index), static_cast<uint32_t>(Data.size()) };
+	File.Write(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+	File.Write(reinterpret_cast<const uint8*>(Data.data()), Data.size());
+	File.Write(reinterpret_cast<const uint8*>(&FileTrailer), sizeof(FileTrailer));
+	File.Flush();
+}
+
+void FImGuiWS_RecordWriter::AddRingFrame(double Time, bool bKeyframe)
+{
+	FScopeLock ScopeLock{ &RingLock };
+	if (bKeyframe || Segments.Num() == 0)
+	{
+		Segments.AddDefaulted();
+	}
+	FRingSegment& Segment = Segments.Last();
+	Segment.Frames.Add({ static_cast<uint64>(Segment.Data->Num()), 0, 0, Time });
+	Segment.Data->Append(GroupData);
+	RingBytes += GroupData.Num();
+	for (const uint64 Hash : GroupTextures)
+	{
+		bool bAlreadyInSegment = false;
+		Segment.Textures.Add(Hash, &bAlreadyInSegment);
+		if (bAlreadyInSegment == false)
+		{
+			RingTextures.FindChecked(Hash).NumSegments += 1;
+		}
+	}
+
+	// the oldest group goes once the newer ones still cover the window, the current group always stays
+	// it binds every content still bound, so the freed textures are never needed by the kept frames
+	while (Segments.Num() > 1 && (RingBytes + RingTextureBytes > RingOptions.MaxBytes || Time - Segments[1].Frames[0].time >= RingOptions.Seconds))
+	{
+		RemoveRingSegment();
+	}
+	WrittenBytes = RingBytes + RingTextureBytes;
+}
+
+void FImGuiWS_RecordWriter::RemoveRingSegment()
+{
+	const FRingSegment& Segment = Segments[0];
+	RingBytes -= Segment.Data->Num();
+	for (const uint64 Hash : Segment.Textures)
+	{
+		FRingTexture& RingTexture = RingTextures.FindChecked(Hash);
+		RingTexture.NumSegments -= 1;
+		if (RingTexture.NumSegments == 0)
+		{
+			RingTextureBytes -= RingTexture.Record->Num();
+			RingTextures.Remove(Hash);
+			TextureOffsets.Remove(Hash);
+			AddMissingTexture(Hash);
+		}
+	}
+	Segments.RemoveAt(0);
+}
+
+void FImGuiWS_RecordWriter::AddMissingTexture(uint64 Hash)
+{
+	FScopeLock ScopeLock{ &MissingTexturesLock };
+	MissingTextures.AddUnique(Hash);
+}
+
+void FImGuiWS_RecordWriter::ConsumeMissingTextures(TArray<uint64>& OutHashes)
+{
+	FScopeLock ScopeLock{ &MissingTexturesLock };
+	OutHashes = MoveTemp(MissingTextures);
+	MissingTextures.Reset();
+}
+
+bool FImGuiWS_RecordWriter::TakeRingSnapshot(FRingSnapshot& OutSnapshot) const
+{
+	FScopeLock ScopeLock{ &RingLock };
+	if (bRing == false || Segments.Num() == 0)
+	{
+		return false;
+	}
+	TSet<uint64> SnapshotTextures;
+	for (int32 Idx = 0; Idx < Segments.Num(); ++Idx)
+	{
+		const FRingSegment& Segment = Segments[Idx];
+		// the last segment still grows on the writer thread
+		const bool bLast = Idx == Segments.Num() - 1;
+		OutSnapshot.Segments.Add({ bLast ? MakeShared<TArray<uint8>, ESPMode::ThreadSafe>(*Segment.Data) : Segment.Data, Segment.Frames });
+		for (const uint64 Hash : Segment.Textures)
+		{
+			bool bAlreadyInSnapshot = false;
+			SnapshotTextures.Add(Hash, &bAlreadyInSnapshot);
+			if (bAlreadyInSnapshot == false)
+			{
+				OutSnapshot.Textures.Add({ Hash, RingTextures.FindChecked(Hash).Record });
+			}
+		}
+	}
+	return true;
+}
+
+bool FImGuiWS_RecordWriter::DumpRing(const FString& DumpPath) const
+{
+	FRingSnapshot Snapshot;
+	return TakeRingSnapshot(Snapshot) && WriteRingSnapshot(Snapshot, DumpPath);
+}
+
+bool FImGuiWS_RecordWriter::DumpRingAsync(const FString& DumpPath)
+{
+	NumAddingFrames += 1;
+	ON_SCOPE_EXIT { NumAddingFrames -= 1; };
+	FRingSnapshot Snapshot;
+	if (IsValid() == false || bCloseRequested || TakeRingSnapshot(Snapshot) == false)
+	{
+		return false;
+	}
+	DumpRequests.Enqueue({ DumpPath, MoveTemp(Snapshot) });
+	WakeUpEvent->Trigger();
+	return true;
+}
+
+bool FImGuiWS_RecordWriter::WriteRingSnapshot(const FRingSnapshot& Snapshot, const FString& DumpPath)
+{
+	const TUniquePtr<IFileHandle> File{ FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*DumpPath) };
+	if (File.IsValid() == false)
+	{
+		UE_LOG(LogImGui, Error, TEXT("Failed to open record file %s"), *DumpPath);
+		return false;
+	}
+	File->Write(reinterpret_cast<const uint8*>(kHeaderV2), FCStringAnsi::Strlen(kHeaderV2));
+
+	// the textures come first, any frame group may bind them
+	TMap<uint64, uint64> DumpedTextures;
+	for (const auto& [Hash, Record] : Snapshot.Textures)
+	{
+		DumpedTextures.Add(Hash, File->Tell());
+		File->Write(Record->GetData(), Record->Num());
+	}
+
+	TArray<IndexEntry> DumpedIndex;
+	const double FirstTime = Snapshot.Segments[0].Frames[0].time;
+	for (const FRingSnapshot::FSegment& Segment : Snapshot.Segments)
+	{
+		const TArray<uint8>& Data = *Segment.Data;
+		const uint64 Base = File->Tell();
+		const uint32 Keyframe = DumpedIndex.Num();
+		// every frame starts with its FrameTime record, the times are rebased like the index in place of copying the segment
+		int64 Written = 0;
+		for (const IndexEntry& Entry : Segment.Frames)
+		{
+			const double Time = Entry.time - FirstTime;
+			DumpedIndex.Add({ Base + Entry.offset, Keyframe, 0, Time });
+			const int64 TimeOffset = Entry.offset + sizeof(RecordHeader);
+			File->Write(Data.GetData() + Written, TimeOffset - Written);
+			File->Write(reinterpret_cast<const uint8*>(&Time), sizeof(Time));
+			Written = TimeOffset + sizeof(Time);
+		}
+		File->Write(Data.GetData() + Written, Data.Num() - Written);
+	}
+	WriteIndex(*File, DumpedIndex, DumpedTextures);
+	return true;
+}
+}
@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+#include "imgui-ws-record.h"
+#include "Containers/Queue.h"
+#include "HAL/Runnable.h"
+
+class FRunnableThread;
+class IFileHandle;
+
+namespace ImGuiWS_Record
+{
+// streams frames to a v2 .imgrcd file from a background thread, every KeyframeInterval frame is a keyframe
+// frames are dropped instead of blocking the caller when more than MaxQueuedBytes wait for the disk
+// texture pixels have a MaxQueuedBytes budget of their own, pixels over it are reported missing instead of queued
+// a ring writer keeps the last frames in memory instead and writes them out on DumpRing
+class FImGuiWS_RecordWriter final : FRunnable
+{
+public:
+	static constexpr int32 KeyframeInterval = 60;
+
+	// whole keyframe groups are dropped once the newer ones cover Seconds or the frames and textures exceed MaxBytes
+	// texture contents are deduplicated and freed with the last group binding them
+	struct FRingOptions
+	{
+		double Seconds = 30.0;
+		int64 MaxBytes = 32 * 1024 * 1024;
+	};
+
+	explicit FImGuiWS_RecordWriter(const FString& FilePath, int64 MaxQueuedBytes = 64 * 1024 * 1024);
+	explicit FImGuiWS_RecordWriter(const FRingOptions& RingOptions, int64 MaxQueuedBytes = 64 * 1024 * 1024);
+	~FImGuiWS_RecordWriter() override;
+
+	bool IsValid() const { return Thread != nullptr; }
+	// empty for ring writers
+	const FString& GetFilePath() const { return FilePath; }
+	bool IsRing() const { return bRing; }
+	const FRingOptions& GetRingOptions() const { return RingOptions; }
+
+	// texture changed since the previous frame, Pixels is only needed the first time a content hash is added
+	struct FTexture
+	{
+		uint32 Id;
+		uint64 Hash;
+		int32 Type;
+		int32 Width;
+		int32 Height;
+		TArray<uint8> Pixels;
+	};
+
+	// serializes on the calling thread, returns false when the frame was dropped
+	// CaptureSeconds is any clock, the record stores the time since the first frame
+	// Input is a serialized FrameInput stored as side channel, empty when there is none
+	bool AddFrame(const ImDrawData* DrawData, double CaptureSeconds, std::vector<char>&& Input = {}, TArray<FTexture>&& Textures = {});
+	bool AddSerializedFrame(std::vector<char>&& Frame, double CaptureSeconds, std::vector<char>&& Input = {}, TArray<FTexture>&& Textures = {});
+
+	// the queued frames, the index and the trailer are written in the background
+	void RequestClose();
+	bool IsClosed() const { return bClosed; }
+
+	int32 NumFrames() const { return NumAddedFrames; }
+	int32 NumDroppedFrames() const { return NumDropped; }
+	int64 TotalBytes() const { return WrittenBytes + QueuedBytes + QueuedTextureBytes; }
+
+	// contents freed by a ring writer or bound before they were ever stored, since the last call
+	// the caller hands their pixels over again the next time a frame uses them
+	void ConsumeMissingTextures(TArray<uint64>& OutHashes);
+
+	// writes the frames a ring writer holds to a v2 file, starting at a keyframe
+	// safe to call from any thread including crash handlers, the ring is only locked while its buffers are shared
+	bool DumpRing(const FString& DumpPath) const;
+	// same snapshot, the file is written by the writer thread, false when there is nothing to dump
+	bool DumpRingAsync(const FString& DumpPath);
+private:
+	uint32 Run() override;
+
+	struct FQueuedFrame
+	{
+		std::vector<char> Data;
+		double Time;
+		std::vector<char> Input;
+		TArray<FTexture> Textures;
+		int64 Size;
+		int64 TextureSize;
+	};
+	void WriteFrame(FQueuedFrame& QueuedFrame);
+	void WriteTextures(TArray<FTexture>& Textures, bool bKeyframe);
+	void AddMissingTexture(uint64 Hash);
+	void WriteTextureContent(FTexture& Texture);
+	// Prefix is written as is, it ends with the raw size readers need to decompress
+	void WriteCompressedRecord(RecordType Type, const void* Prefix, uint32 PrefixSize, const void* Data, uint32 RawSize);
+	void WriteRecord(RecordType Type, const void* Data, uint32 Size);
+	void Write(const void* Data, int64 Size);
+	int64 Tell() const;
+	static void WriteIndex(IFileHandle& File, const TArray<IndexEntry>& Index, const TMap<uint64, uint64>& TextureOffsets);
+	void AddRingFrame(double Time, bool bKeyframe);
+	void RemoveRingSegment();
+
+	FString FilePath;
+	int64 MaxQueuedBytes;
+	TUniquePtr<IFileHandle> FileHandle;
+	FRunnableThread* Thread = nullptr;
+	FEvent* WakeUpEvent = nullptr;
+
+	TQueue<FQueuedFrame, EQueueMode::Spsc> Queue;
+	double FirstCaptureSeconds = -1.0;
+	std::atomic<int64> QueuedBytes{ 0 };
+	std::atomic<int64> QueuedTextureBytes{ 0 };
+	std::atomic<int64> WrittenBytes{ 0 };
+	std::atomic<int32> NumAddedFrames{ 0 };
+	std::atomic<int32> NumDropped{ 0 };
+	std::atomic<bool> bCloseRequested{ false };
+	// AddSerializedFrame and DumpRingAsync calls past the close check, the writer waits for them before the last drain
+	std::atomic<int32> NumAddingFrames{ 0 };
+	std::atomic<bool> bClosed{ false };
+
+	// only touched by the writer thread
+	int32 NumWrittenFrames = 0;
+	TArray<IndexEntry> Index;
+	std::vector<char> PrevFrame;
+	TArray<uint8> Payload;
+	TMap<uint32, uint64> TextureBindings;
+	TMap<uint64, uint64> TextureOffsets;
+
+	// ring mode, a frame group is built in GroupData and moved into the segments under RingLock
+	// only the last segment grows, the others and the texture records are shared with dumps as they are
+	using FSharedBytes = TSharedRef<TArray<uint8>, ESPMode::ThreadSafe>;
+	struct FRingSegment
+	{
+		FSharedBytes Data = MakeShared<TArray<uint8>, ESPMode::ThreadSafe>();
+		// offsets are relative to Data
+		TArray<IndexEntry> Frames;
+		TSet<uint64> Textures;
+	};
+	bool bRing = false;
+	FRingOptions RingOptions;
+	TArray<uint8>* RingOutput = nullptr;
+	TArray<uint8> GroupData;
+	TSet<uint64> GroupTextures;
+	mutable FCriticalSection RingLock;
+	TArray<FRingSegment> Segments;
+	// complete Texture records by content hash, counted by the segments binding them
+	struct FRingTexture
+	{
+		FSharedBytes Record;
+		int32 NumSegments = 0;
+	};
+	TMap<uint64, FRingTexture> RingTextures;
+	int64 RingBytes = 0;
+	int64 RingTextureBytes = 0;
+	// apart from RingLock, the ws thread never waits for a ring dump
+	FCriticalSection MissingTexturesLock;
+	TArray<uint64> MissingTextures;
+
+	struct FRingSnapshot
+	{
+		struct FSegment
+		{
+			FSharedBytes Data;
+			TArray<IndexEntry> Frames;
+		};
+		TArray<FSegment> Segments;
+		TArray<TPair<uint64, FSharedBytes>> Textures;
+	};
+	bool TakeRingSnapshot(FRingSnapshot& OutSnapshot) const;
+	static bool WriteRingSnapshot(const FRingSnapshot& Snapshot, const FString& DumpPath);
+	TQueue<TPair<FString, FRingSnapshot>, EQueueMode::Mpsc> DumpRequests;
+};
+}
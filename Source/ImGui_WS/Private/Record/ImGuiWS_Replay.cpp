@@ -5,20 +5,64 @@
 
 #include "font_awesome_5.h"
 #include "imgui.h"
+#include "imgui-ws.h"
+#include "imgui_internal.h"
+#include "UnrealImGuiTexture.h"
 
 namespace ImGuiWS_Record
 {
-FImGuiWS_Replay::FImGuiWS_Replay(const char* FilePath)
+namespace
 {
-	LoadedSession.load(FilePath);
+	constexpr float PlaySpeeds[] = { 0.25f, 0.5f, 1.f, 2.f, 4.f, 8.f };
+	constexpr const char* PlaySpeedNames[] = { "0.25x", "0.5x", "1x", "2x", "4x", "8x" };
+	constexpr double ClickFadeSeconds = 0.5;
+}
+
+FImGuiWS_Replay::FImGuiWS_Replay(const FString& FilePath, ImGuiWS& InImGuiWS)
+	: WS(InImGuiWS)
+{
+	Reader.Open(FilePath);
+}
+
+FImGuiWS_Replay::~FImGuiWS_Replay()
+{
+	for (const auto& [Hash, TextureId] : RegisteredTextures)
+	{
+		WS.RemoveTexture(TextureId);
+	}
+}
+
+uint32 FImGuiWS_Replay::FindOrRegisterTexture(uint32 RecordedId, uint64 Hash)
+{
+	if (const uint32* TextureId = RegisteredTextures.Find(Hash))
+	{
+		return *TextureId;
+	}
+	TextureHeader Header;
+	TArray<uint8> Pixels;
+	if (Reader.GetTexture(Hash, Header, Pixels) == false)
+	{
+		return RecordedId;
+	}
+	const uint32 TextureId = FImGuiTextureHandle::MakeUnique();
+	WS.SetTexture(TextureId, ImGuiWS::FTexture::Type{ Header.type }, Header.width, Header.height, Pixels.GetData());
+	RegisteredTextures.Add(Hash, TextureId);
+	return TextureId;
 }
 
 void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 {
 	if (PlayState == EPlayState::Play)
 	{
-		FrameIndex = (FrameIndex + 1) % LoadedSession.nFrames();
+		// follows the recorded clock, frames in between are never turned into draw data
+		PlayTime += DeltaTime * PlaySpeeds[PlaySpeedIndex];
+		if (PlayTime > Reader.GetDuration())
+		{
+			PlayTime = 0.0;
+		}
+		FrameIndex = Reader.FindFrame(PlayTime);
 	}
+	DrawInputOverlay();
 	
 	const ImVec2 MousePos = ImGui::GetMousePos();
 	
@@ -67,9 +111,37 @@ void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 	default: ;
 	}
 	ImGui::SameLine();
+	if (ImGui::Button(ICON_FA_STEP_BACKWARD) && FrameIndex > 0)
+	{
+		PlayState = EPlayState::Pause;
+		FrameIndex -= 1;
+		PlayTime = Reader.GetFrameTime(FrameIndex);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button(ICON_FA_STEP_FORWARD) && FrameIndex < Reader.NumFrames() - 1)
+	{
+		PlayState = EPlayState::Pause;
+		FrameIndex += 1;
+		PlayTime = Reader.GetFrameTime(FrameIndex);
+	}
+	ImGui::SameLine();
+	ImGui::SetNextItemWidth(70.f);
+	ImGui::Combo("##PlaySpeed", &PlaySpeedIndex, PlaySpeedNames, UE_ARRAY_COUNT(PlaySpeedNames));
+	ImGui::SameLine();
+	ImGui::Checkbox("Fit", &bFitViewport);
+	ImGui::SameLine();
+	ImGui::Checkbox("Input", &bShowInput);
+	ImGui::SameLine();
 
-	ImGui::SetNextItemWidth(-30.f);
-	ImGui::SliderInt("##PlayPosition", &FrameIndex, 0, LoadedSession.nFrames() - 1);
+	ImGui::SetNextItemWidth(-200.f);
+	float PlayPosition = PlayTime;
+	if (ImGui::SliderFloat("##PlayPosition", &PlayPosition, 0.f, Reader.GetDuration(), "%.2f s"))
+	{
+		PlayTime = PlayPosition;
+		FrameIndex = Reader.FindFrame(PlayTime);
+	}
+	ImGui::SameLine();
+	ImGui::Text("Frame %d / %d", FrameIndex + 1, Reader.NumFrames());
 
 	ImGui::End();
 
@@ -77,8 +149,117 @@ void FImGuiWS_Replay::Draw(float DeltaTime, bool& CloseReplay)
 	ImGui::PopStyleColor();
 }
 
-bool FImGuiWS_Replay::GetDrawData(FDrawData& DrawData)
+void FImGuiWS_Replay::DrawInputOverlay()
 {
-	return LoadedSession.getFrame(FrameIndex, &DrawData.drawData, DrawData.drawLists, ImGui::GetDrawListSharedData());
+	FrameInput Input;
+	std::vector<InputEvent> Events;
+	if (FrameIndex != OverlayFrameIndex)
+	{
+		// clicks of the frames skipped since the last draw are kept, a jump only shows the current frame
+		const bool bContinuous = OverlayFrameIndex != INDEX_NONE && FrameIndex > OverlayFrameIndex && FrameIndex - OverlayFrameIndex <= 60;
+		for (int32 Idx = bContinuous ? OverlayFrameIndex + 1 : FrameIndex; Idx <= FrameIndex; ++Idx)
+		{
+			if (Reader.GetFrameInput(Idx, Input, Events) == false)
+			{
+				continue;
+			}
+			for (const InputEvent& Event : Events)
+			{
+				if (Event.type == static_cast<int32>(InputType::MouseDown))
+				{
+					Clicks.Add({ { Event.x, Event.y }, Event.code, Reader.GetFrameTime(Idx) });
+				}
+			}
+		}
+		OverlayFrameIndex = FrameIndex;
+	}
+	Clicks.RemoveAll([this](const FClick& Click) { return Click.Time > PlayTime || PlayTime - Click.Time > ClickFadeSeconds; });
+
+	if (bShowInput == false || Reader.GetFrameInput(FrameIndex, Input, Events) == false)
+	{
+		return;
+	}
+	auto ToViewport = [this](const ImVec2& Pos)
+	{
+		return ImVec2{ (Pos.x - RecordedDisplayPos.x) * ViewportScale, (Pos.y - RecordedDisplayPos.y) * ViewportScale };
+	};
+	ImDrawList* DrawList = ImGui::GetForegroundDrawList();
+	for (const FClick& Click : Clicks)
+	{
+		const float Alpha = 1.f - (PlayTime - Click.Time) / ClickFadeSeconds;
+		const ImU32 Color = Click.Button == 0 ? IM_COL32(255, 200, 0, 255 * Alpha) : IM_COL32(0, 200, 255, 255 * Alpha);
+		DrawList->AddCircle(ToViewport(Click.Pos), (6.f + 14.f * (1.f - Alpha)) * ViewportScale, Color, 0, 2.f);
+	}
+	ImGui::RenderMouseCursor(ToViewport({ Input.mouseX, Input.mouseY }), ViewportScale, Input.mouseCursor, IM_COL32_WHITE, IM_COL32_BLACK, IM_COL32(0, 0, 0, 48));
+}
+
+bool FImGuiWS_Replay::GetDrawLists(TFunctionRef<ImDrawList&()> AddDrawList)
+{
+	ImDrawData Data;
+	if (Reader.GetFrame(FrameIndex, Data, ListViews) == false)
+	{
+		return false;
+	}
+
+	const ImVec2 DisplaySize = ImGui::GetIO().DisplaySize;
+	RecordedDisplayPos = Data.DisplayPos;
+	ViewportScale = 1.f;
+	if (bFitViewport && Data.DisplaySize.x > 0.f && Data.DisplaySize.y > 0.f)
+	{
+		// uniform scale keeps the recorded aspect ratio
+		ViewportScale = FMath::Min(DisplaySize.x / Data.DisplaySize.x, DisplaySize.y / Data.DisplaySize.y);
+	}
+	const bool bTransform = ViewportScale != 1.f || RecordedDisplayPos.x != 0.f || RecordedDisplayPos.y != 0.f;
+	// the recorded textures replace the live ones with the same id
+	const TMap<uint32, uint64>& TextureBindings = Reader.GetTextureBindings();
+
+	// fixed up in the copy, the record itself is never written
+	for (const DrawListView& View : ListViews)
+	{
+		ImDrawList& DrawList = AddDrawList();
+		copyDrawList(View, DrawList);
+
+		if (TextureBindings.Num() > 0)
+		{
+			for (ImDrawCmd& Cmd : DrawList.CmdBuffer)
+			{
+				const uint32 RecordedId = static_cast<uint32>(reinterpret_cast<UPTRINT>(Cmd.TextureId));
+				if (const uint64* Hash = TextureBindings.Find(RecordedId))
+				{
+					Cmd.TextureId = reinterpret_cast<ImTextureID>(static_cast<UPTRINT>(FindOrRegisterTexture(RecordedId, *Hash)));
+				}
+			}
+		}
+		if (bTransform)
+		{
+			for (ImDrawVert& Vert : DrawList.VtxBuffer)
+			{
+				Vert.pos = { (Vert.pos.x - RecordedDisplayPos.x) * ViewportScale, (Vert.pos.y - RecordedDisplayPos.y) * ViewportScale };
+			}
+			for (ImDrawCmd& Cmd : DrawList.CmdBuffer)
+			{
+				Cmd.ClipRect = { (Cmd.ClipRect.x - RecordedDisplayPos.x) * ViewportScale, (Cmd.ClipRect.y - RecordedDisplayPos.y) * ViewportScale, (Cmd.ClipRect.z - RecordedDisplayPos.x) * ViewportScale, (Cmd.ClipRect.w - RecordedDisplayPos.y) * ViewportScale };
+			}
+		}
+	}
+
+	// contents no longer bound are released, a streamed render target records a new content per readback
+	if (RegisteredTextures.Num() > 0)
+	{
+		TSet<uint64> BoundHashes;
+		for (const auto& [RecordedId, Hash] : TextureBindings)
+		{
+			BoundHashes.Add(Hash);
+		}
+		for (auto It = RegisteredTextures.CreateIterator(); It; ++It)
+		{
+			if (BoundHashes.Contains(It->Key) == false)
+			{
+				WS.RemoveTexture(It->Value);
+				It.RemoveCurrent();
+			}
+		}
+	}
+	return true;
 }
 }
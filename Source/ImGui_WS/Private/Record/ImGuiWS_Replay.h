@@ -2,31 +2,35 @@
 
 #pragma once
 
-#include "imgui-ws-record.h"
+#include "ImGuiWS_RecordReader.h"
+
+class ImGuiWS;
 
 namespace ImGuiWS_Record
 {
 class FImGuiWS_Replay
 {
 public:
-	FImGuiWS_Replay(const char* FilePath);
+	// recorded textures are registered to ImGuiWS under temporary ids while the replay lives
+	FImGuiWS_Replay(const FString& FilePath, ImGuiWS& InImGuiWS);
+	~FImGuiWS_Replay();
+
+	bool IsValid() const { return Reader.NumFrames() > 0; }
 
 	void Draw(float DeltaTime, bool& CloseReplay);
 
-	struct FDrawData
-	{
-		ImDrawData drawData;
-		ImDrawData* operator->()
-		{
-			return &drawData;
-		}
-	private:
-		friend class FImGuiWS_Replay;
-		std::vector<ImDrawList> drawLists;
-	};
-	bool GetDrawData(FDrawData& DrawData);
+	// copies the shown frame out of the record into the lists returned by AddDrawList
+	// scaled to the current viewport when bFitViewport is set
+	bool GetDrawLists(TFunctionRef<ImDrawList&()> AddDrawList);
 private:
-	Session LoadedSession;
+	void DrawInputOverlay();
+	uint32 FindOrRegisterTexture(uint32 RecordedId, uint64 Hash);
+
+	FImGuiWS_RecordReader Reader;
+	TArray<DrawListView> ListViews;
+	ImGuiWS& WS;
+	// content hash to temporary texture id
+	TMap<uint64, uint32> RegisteredTextures;
 	float WindowHeightOffset = 0.f;
 
 	enum class EPlayState : uint8
@@ -36,5 +40,22 @@ private:
 	};
 	EPlayState PlayState = EPlayState::Play;
 	int32 FrameIndex = 0;
+	// seconds on the recorded clock
+	double PlayTime = 0.0;
+	int32 PlaySpeedIndex = 2;
+
+	bool bFitViewport = true;
+	float ViewportScale = 1.f;
+	ImVec2 RecordedDisplayPos{ 0.f, 0.f };
+
+	bool bShowInput = true;
+	int32 OverlayFrameIndex = INDEX_NONE;
+	struct FClick
+	{
+		ImVec2 Pos;
+		int32 Button;
+		double Time;
+	};
+	TArray<FClick> Clicks;
 };
 }
@@ -6,13 +6,14 @@
 
 #include "imgui.h"
 
+#include <cstdint>
 #include <vector>
-#include <fstream>
 #include <cstring>
+#include <algorithm>
 
 namespace ImGuiWS_Record{
 
-// helper functions to serialize/unserialize Dear ImGui data
+// helper functions to serialize Dear ImGui data
 
 template<typename T>
     inline void serialize(const T & t, std::vector<char> & buf) {
@@ -47,176 +48,218 @@ template<>
         }
     }
 
-template<typename T>
-    inline void unserialize(T & t, const std::vector<char> & buf, size_t & offset) {
-        std::memcpy((char *)(&t), buf.data() + offset, sizeof(T));
-        offset += sizeof(T);
-    }
-
-template<>
-    inline void unserialize<ImDrawCmd>(ImDrawCmd & t, const std::vector<char> & buf, size_t & offset) {
-        unserialize(t.ElemCount, buf, offset);
-        unserialize(t.ClipRect.x, buf, offset);
-        unserialize(t.ClipRect.y, buf, offset);
-        unserialize(t.ClipRect.z, buf, offset);
-        unserialize(t.ClipRect.w, buf, offset);
-        unserialize(t.TextureId, buf, offset);
-        unserialize(t.VtxOffset, buf, offset);
-        unserialize(t.IdxOffset, buf, offset);
-
-        t.UserCallback = NULL;
-    }
-
-template<typename T>
-    inline void unserialize(ImVector<T> & t, std::vector<char> & buf, size_t & offset) {
-        uint32_t n = 0;
-        unserialize(n, buf, offset);
-        t.resize(n);
-        std::memcpy((char *)(t.Data), buf.data() + offset, n*sizeof(T));
-        offset += n*sizeof(T);
-    }
-
-template<>
-    inline void unserialize<ImDrawCmd>(ImVector<ImDrawCmd> & t, std::vector<char> & buf, size_t & offset) {
-        uint32_t n = 0;
-        unserialize(n, buf, offset);
-        t.resize(n);
-        for (uint32_t i = 0; i < n; ++i) {
-            unserialize(t[i], buf, offset);
-        }
-    }
+// v1.0 is the frame count followed by every frame with its size
+constexpr auto kHeaderV1_0 = "Dear ImGui DrawData v1.0";
+// v1.1 is a stream of records, finished by an index record and a trailer pointing at it
+// a file cut off while recording has no trailer, its complete records are still readable
+constexpr auto kHeaderV1_1 = "Dear ImGui DrawData v1.1";
+// v2 stores compressed keyframes and xor deltas against the previous frame
+// a frame is a group of side channel records followed by the frame record, the index points at the group start
+constexpr auto kHeaderV2 = "Dear ImGui DrawData v2.0";
+constexpr uint64_t kTrailerMagic = 0x5844494352474D49; // "IMGRCIDX"
+
+enum class RecordType : uint32_t {
+    Frame = 1,
+    // uint32 nFrames, uint32 entry size, entries, then the same for TextureIndexEntry
+    Index = 2,
+    // uint32 raw size, compressed frame
+    Keyframe = 3,
+    // uint32 raw size, compressed xor of the frame and the previous frame
+    Delta = 4,
+    // double seconds since the first frame
+    FrameTime = 5,
+    // FrameInput followed by nEvents InputEvent
+    FrameInput = 6,
+    // TextureHeader followed by the pixels, compressed unless the sizes match, stored once per content
+    Texture = 7,
+    // TextureBinding, keyframe groups repeat all bindings so seeking never looks further back
+    TextureBind = 8,
+};
 
-struct Session {
-    constexpr static auto kHeader = "Dear ImGui DrawData v1.0";
+struct RecordHeader {
+    uint32_t type;
+    uint32_t size;
+};
 
-    using FrameData = std::vector<char>;
+struct IndexEntry {
+    uint64_t offset = 0;
+    // index of the frame decoding starts from
+    uint32_t keyframe = 0;
+    uint32_t reserved = 0;
+    double time = 0.0;
+};
 
-    bool save(const char * fname) const {
-        std::ofstream fs(fname, std::ios::binary);
+struct TextureHeader {
+    uint64_t hash;
+    int32_t type;
+    int32_t width;
+    int32_t height;
+    uint32_t rawSize;
+};
 
-        fs.write(kHeader, strlen(kHeader));
+// the texture id used by the draw commands shows the content with the hash
+struct TextureBinding {
+    uint32_t id;
+    uint32_t reserved = 0;
+    uint64_t hash;
+};
 
-        uint32_t nFrames = frames.size();
-        fs.write((char *)(&nFrames), sizeof(nFrames));
+struct TextureIndexEntry {
+    uint64_t hash;
+    uint64_t offset;
+};
 
-        for (uint32_t i = 0; i < nFrames; ++i) {
-            uint32_t frameSize = frames[i].size();
-            fs.write((char *)(&frameSize), sizeof(frameSize));
-            fs.write((char *)(frames[i].data()), frames[i].size());
-        }
+struct Trailer {
+    uint64_t indexOffset;
+    uint64_t magic;
+};
 
-        return true;
-    }
+// input of the controlling client applied in the frame
+struct FrameInput {
+    float mouseX = 0.0f;
+    float mouseY = 0.0f;
+    float viewportWidth = 0.0f;
+    float viewportHeight = 0.0f;
+    int32_t mouseCursor = 0;
+    int32_t controlId = -1;
+    uint32_t nEvents = 0;
+};
 
-    bool load(const char * fname) {
-        std::ifstream fs(fname, std::ios::binary);
-        char header[64];
-        std::fill(header, header + 64, 0);
-        fs.read(header, strlen(kHeader));
-        if (strcmp(header, kHeader)) {
-            return false;
-        }
+enum class InputType : int32_t {
+    MouseDown = 1,
+    MouseUp = 2,
+    MouseWheel = 3,
+    KeyDown = 4,
+    KeyUp = 5,
+    Char = 6,
+    // text content isn't recorded
+    Text = 7,
+    Resize = 8,
+};
 
-        uint32_t nFrames = 0;
-        fs.read((char *)(&nFrames), sizeof(nFrames));
+// code is the mouse button, key or character, x and y the mouse position, wheel delta or new size
+struct InputEvent {
+    int32_t type = 0;
+    int32_t code = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+};
 
-        frames.resize(nFrames);
-        for (uint32_t i = 0; i < nFrames; ++i) {
-            uint32_t frameSize = 0;
-            fs.read((char *)(&frameSize), sizeof(frameSize));
+inline void serializeFrameInput(const FrameInput & input, const InputEvent * events, std::vector<char> & buf) {
+    serialize(input, buf);
+    std::copy((const char *)(events), (const char *)(events + input.nEvents), std::back_inserter(buf));
+}
 
-            frames[i].resize(frameSize);
-            fs.read((char *)(frames[i].data()), frames[i].size());
-        }
+inline bool unserializeFrameInput(FrameInput & input, std::vector<InputEvent> & events, const char * data, size_t size) {
+    if (size < sizeof(FrameInput)) return false;
+    std::memcpy(&input, data, sizeof(FrameInput));
+    if (size < sizeof(FrameInput) + (size_t) input.nEvents*sizeof(InputEvent)) return false;
+    events.resize(input.nEvents);
+    std::memcpy(events.data(), data + sizeof(FrameInput), input.nEvents*sizeof(InputEvent));
+    return true;
+}
 
-        return true;
+// xor over the common prefix, applying it twice restores the frame
+inline void xorFrame(std::vector<char> & frame, const std::vector<char> & prev) {
+    const size_t n = std::min(frame.size(), prev.size());
+    for (size_t i = 0; i < n; ++i) {
+        frame[i] ^= prev[i];
     }
+}
 
-    bool addFrame(const ImDrawData * drawData) {
-        FrameData frame;
-
-        serialize(drawData->Valid, frame);
-        serialize(drawData->CmdListsCount, frame);
-        serialize(drawData->TotalIdxCount, frame);
-        serialize(drawData->TotalVtxCount, frame);
-        serialize(drawData->DisplayPos.x, frame);
-        serialize(drawData->DisplayPos.y, frame);
-        serialize(drawData->DisplaySize.x, frame);
-        serialize(drawData->DisplaySize.y, frame);
-        serialize(drawData->FramebufferScale.x, frame);
-        serialize(drawData->FramebufferScale.y, frame);
-
-        for (int32_t iList = 0; iList < drawData->CmdListsCount; ++iList) {
-            auto & cmdList = drawData->CmdLists[iList];
-
-            serialize(cmdList->CmdBuffer, frame);
-            serialize(cmdList->VtxBuffer, frame);
-            serialize(cmdList->IdxBuffer, frame);
-            serialize(cmdList->Flags, frame);
-        }
-
-        frames.emplace_back(std::move(frame));
-
-        return true;
+inline void serializeDrawData(const ImDrawData * drawData, std::vector<char> & frame) {
+    serialize(drawData->Valid, frame);
+    serialize(drawData->CmdListsCount, frame);
+    serialize(drawData->TotalIdxCount, frame);
+    serialize(drawData->TotalVtxCount, frame);
+    serialize(drawData->DisplayPos.x, frame);
+    serialize(drawData->DisplayPos.y, frame);
+    serialize(drawData->DisplaySize.x, frame);
+    serialize(drawData->DisplaySize.y, frame);
+    serialize(drawData->FramebufferScale.x, frame);
+    serialize(drawData->FramebufferScale.y, frame);
+
+    for (int32_t iList = 0; iList < drawData->CmdListsCount; ++iList) {
+        auto & cmdList = drawData->CmdLists[iList];
+
+        serialize(cmdList->CmdBuffer, frame);
+        serialize(cmdList->VtxBuffer, frame);
+        serialize(cmdList->IdxBuffer, frame);
+        serialize(cmdList->Flags, frame);
     }
+}
 
-    bool getFrame(int32_t fid, ImDrawData* drawData, std::vector<ImDrawList>& drawLists, ImDrawListSharedData* drawListSharedData) {
-        if (fid >= (int32_t) frames.size()) return false;
+// one list of a serialized frame, the arrays point into the frame buffer and may be unaligned
+struct DrawListView {
+    const char * cmdData = nullptr;
+    uint32_t nCmds = 0;
+    const char * vtxData = nullptr;
+    uint32_t nVtx = 0;
+    const char * idxData = nullptr;
+    uint32_t nIdx = 0;
+    ImDrawListFlags flags = 0;
+};
 
+// the size of an ImDrawCmd written by serialize<ImDrawCmd>
+constexpr size_t kSerializedDrawCmdSize = sizeof(ImDrawCmd::ElemCount) + sizeof(ImVec4) + sizeof(ImTextureID) + sizeof(ImDrawCmd::VtxOffset) + sizeof(ImDrawCmd::IdxOffset);
+
+// reads the frame in place, the header fields go to drawData and every list is handed to onList
+// drawData->CmdLists is left untouched, returns false when the buffer is truncated
+template<typename OnList>
+    inline bool viewDrawData(ImDrawData * drawData, const char * buf, size_t size, OnList && onList) {
         size_t offset = 0;
-        auto & buf = frames[fid];
-
-        unserialize(drawData->Valid, buf, offset);
-        unserialize(drawData->CmdListsCount, buf, offset);
-        unserialize(drawData->TotalIdxCount, buf, offset);
-        unserialize(drawData->TotalVtxCount, buf, offset);
-        unserialize(drawData->DisplayPos.x, buf, offset);
-        unserialize(drawData->DisplayPos.y, buf, offset);
-        unserialize(drawData->DisplaySize.x, buf, offset);
-        unserialize(drawData->DisplaySize.y, buf, offset);
-        unserialize(drawData->FramebufferScale.x, buf, offset);
-        unserialize(drawData->FramebufferScale.y, buf, offset);
-
-        if ((int) drawLists.size() < drawData->CmdListsCount) {
-            drawLists.resize(drawData->CmdListsCount, ImDrawList{ drawListSharedData });
+        auto read = [&](auto & t) {
+            if (offset + sizeof(t) > size) return false;
+            std::memcpy(&t, buf + offset, sizeof(t));
+            offset += sizeof(t);
+            return true;
+        };
+        auto skip = [&](const char *& data, uint32_t & n, size_t elemSize) {
+            if (read(n) == false || offset + n*elemSize > size) return false;
+            data = buf + offset;
+            offset += n*elemSize;
+            return true;
+        };
+
+        int32_t nLists = 0;
+        if (read(drawData->Valid) == false || read(nLists) == false ||
+            read(drawData->TotalIdxCount) == false || read(drawData->TotalVtxCount) == false ||
+            read(drawData->DisplayPos) == false || read(drawData->DisplaySize) == false || read(drawData->FramebufferScale) == false) {
+            return false;
         }
 
-        drawData->CmdLists.resize(drawData->CmdListsCount);
-
-        for (int32_t iList = 0; iList < drawData->CmdListsCount; ++iList) {
-            drawData->CmdLists[iList] = &drawLists[iList];
-
-            auto& cmdList = drawData->CmdLists[iList];
-
-            unserialize(cmdList->CmdBuffer, buf, offset);
-            unserialize(cmdList->VtxBuffer, buf, offset);
-            unserialize(cmdList->IdxBuffer, buf, offset);
-            unserialize(cmdList->Flags, buf, offset);
+        for (int32_t iList = 0; iList < nLists; ++iList) {
+            DrawListView view;
+            if (skip(view.cmdData, view.nCmds, kSerializedDrawCmdSize) == false ||
+                skip(view.vtxData, view.nVtx, sizeof(ImDrawVert)) == false ||
+                skip(view.idxData, view.nIdx, sizeof(ImDrawIdx)) == false ||
+                read(view.flags) == false) {
+                return false;
+            }
+            onList(view);
         }
-
         return true;
     }
 
-    int32_t nFrames() const {
-        return frames.size();
-    }
-
-    uint64_t totalSize_bytes() const {
-        uint64_t result = 0;
-
-        for (auto & frame : frames) {
-            result += frame.size();
-        }
-
-        return result;
-    }
-
-    void printInfo() const {
-        printf("    - Total frames      = %d\n", (int) frames.size());
-        printf("    - Total size        = %d bytes\n", (int) totalSize_bytes());
+// fills an owned list from a view, the buffers only grow so a reused list doesn't allocate
+inline void copyDrawList(const DrawListView & view, ImDrawList & list) {
+    list.CmdBuffer.resize(view.nCmds);
+    const char * cmd = view.cmdData;
+    for (uint32_t i = 0; i < view.nCmds; ++i) {
+        ImDrawCmd & t = list.CmdBuffer[i];
+        std::memcpy(&t.ElemCount, cmd, sizeof(t.ElemCount)); cmd += sizeof(t.ElemCount);
+        std::memcpy(&t.ClipRect, cmd, sizeof(t.ClipRect)); cmd += sizeof(t.ClipRect);
+        std::memcpy(&t.TextureId, cmd, sizeof(t.TextureId)); cmd += sizeof(t.TextureId);
+        std::memcpy(&t.VtxOffset, cmd, sizeof(t.VtxOffset)); cmd += sizeof(t.VtxOffset);
+        std::memcpy(&t.IdxOffset, cmd, sizeof(t.IdxOffset)); cmd += sizeof(t.IdxOffset);
+        t.UserCallback = NULL;
+        t.UserCallbackData = NULL;
     }
-
-    std::vector<FrameData> frames;
-};
+    list.VtxBuffer.resize(view.nVtx);
+    if (view.nVtx > 0) std::memcpy(list.VtxBuffer.Data, view.vtxData, view.nVtx*sizeof(ImDrawVert));
+    list.IdxBuffer.resize(view.nIdx);
+    if (view.nIdx > 0) std::memcpy(list.IdxBuffer.Data, view.idxData, view.nIdx*sizeof(ImDrawIdx));
+    list.Flags = view.flags;
+}
 
 }
@@ -0,0 +1,183 @@
+/*! \file compressor-adaptive-per-draw-list.cpp
+ *  \brief Per draw list choice between the tessellated and the semantic encoding.
+ */
+
+#include "imgui-draw-data-compressor.h"
+
+#include "imgui.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// semantic encoding is used while it is predicted below this fraction of the tessellated size
+constexpr float kSemanticMaxRatio = 0.9f;
+// lists currently sent tessellated are encoded semantically again every that many frames
+constexpr uint32_t kProbeInterval = 30;
+// weight of the latest measurement in the predicted ratio
+constexpr float kRatioAlpha = 0.25f;
+
+inline uint64_t mix(uint64_t h, uint64_t v) {
+    h ^= v*0x9E3779B97F4A7C15ull;
+    h = (h << 31) | (h >> 33);
+    return h*0xC2B2AE3D27D4EB4Full;
+}
+
+uint64_t hashBytes(uint64_t h, const void * data, size_t n) {
+    const char * p = (const char *) data;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, p + i, sizeof(v));
+        h = mix(h, v);
+    }
+    uint64_t tail = 0;
+    if (n > i) {
+        std::memcpy(&tail, p + i, n - i);
+    }
+    return mix(h, tail ^ (uint64_t) n);
+}
+
+// covers everything the encoders write, a matching hash means the previous output can be reused
+uint64_t hashDrawList(const ImDrawList * cmdList) {
+    uint64_t h = 0;
+    h = hashBytes(h, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size*sizeof(ImDrawVert));
+    h = hashBytes(h, cmdList->IdxBuffer.Data, cmdList->IdxBuffer.Size*sizeof(ImDrawIdx));
+    for (int iCmd = 0; iCmd < cmdList->CmdBuffer.Size; ++iCmd) {
+        const ImDrawCmd & cmd = cmdList->CmdBuffer[iCmd];
+        const uint32_t words[4] = { cmd.ElemCount, (uint32_t)(intptr_t) cmd.TextureId, cmd.VtxOffset, cmd.IdxOffset };
+        h = hashBytes(h, words, sizeof(words));
+        h = hashBytes(h, &cmd.ClipRect, sizeof(cmd.ClipRect));
+    }
+    return h;
+}
+
+// exact size of the tessellated encoding, see compressor-xor-rle-per-draw-list-with-vtx-offset.cpp
+uint64_t tessellatedSize(const ImDrawList * cmdList) {
+    const uint64_t nIndices = cmdList->IdxBuffer.Size + cmdList->IdxBuffer.Size%2;
+    return 4 + 8 + 4 + cmdList->VtxBuffer.Size*sizeof(ImDrawVert) + 4 + nIndices*sizeof(ImDrawIdx) + 4 + cmdList->CmdBuffer.Size*(4*4 + sizeof(ImVec4));
+}
+
+struct ListState {
+    bool valid = false;
+    uint64_t hash = 0;
+    size_t outputSize = 0;
+    float semanticRatio = 0.5f;
+    uint32_t framesSinceProbe = 0;
+};
+
+}
+
+namespace ImDrawDataCompressor {
+
+struct AdaptivePerDrawList::Impl {
+    XorRlePerDrawListWithVtxOffset tessellated;
+    SemanticPerDrawList semantic;
+
+    uint32_t cpuBudgetUs = 2000;
+    Stats stats;
+
+    std::vector<ListState> lists;
+};
+
+AdaptivePerDrawList::AdaptivePerDrawList() : m_impl(new Impl()) {}
+
+AdaptivePerDrawList::~AdaptivePerDrawList() {}
+
+void AdaptivePerDrawList::encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) {
+    // without history only the actual sizes can decide
+    const size_t begin = buf.size();
+    m_impl->semantic.encodeDrawList(drawList, buf);
+    if (buf.size() - begin >= tessellatedSize(drawList)) {
+        buf.resize(begin);
+        m_impl->tessellated.encodeDrawList(drawList, buf);
+    }
+}
+
+bool AdaptivePerDrawList::setDrawData(const ::ImDrawData * drawData) {
+    using clock = std::chrono::steady_clock;
+    const auto tStart = clock::now();
+
+    Stats & stats = m_impl->stats;
+    stats = {};
+
+    const uint32_t nCmdLists = drawData->CmdListsCount;
+    m_drawListsCur.resize(nCmdLists);
+    m_impl->lists.resize(nCmdLists);
+
+    for (uint32_t iList = 0; iList < nCmdLists; iList++) {
+        const ImDrawList * cmdList = drawData->CmdLists[iList];
+        ListState & state = m_impl->lists[iList];
+        DrawList & out = m_drawListsCur[iList];
+
+        const uint64_t tessSize = tessellatedSize(cmdList);
+        stats.bytesTessellated += tessSize;
+
+        const uint64_t hash = hashDrawList(cmdList);
+        // the caller hands back the previous output, an unchanged list is left as it is
+        if (state.valid && state.hash == hash && out.size() == state.outputSize) {
+            stats.nReused += 1;
+            stats.bytesOut += out.size();
+            continue;
+        }
+
+        const uint64_t elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - tStart).count();
+        const bool inBudget = elapsedUs < m_impl->cpuBudgetUs;
+
+        state.framesSinceProbe += 1;
+        const bool predictSemantic = state.semanticRatio < kSemanticMaxRatio;
+        const bool probe = predictSemantic == false && state.framesSinceProbe >= kProbeInterval;
+
+        out.clear();
+        bool isSemantic = false;
+        if (inBudget && (predictSemantic || probe)) {
+            m_impl->semantic.encodeDrawList(cmdList, out);
+            state.framesSinceProbe = 0;
+            stats.nProbes += probe ? 1 : 0;
+
+            const float ratio = tessSize > 0 ? (float) out.size()/tessSize : 1.0f;
+            state.semanticRatio += kRatioAlpha*(ratio - state.semanticRatio);
+
+            isSemantic = out.size() < tessSize;
+            if (isSemantic == false) {
+                out.clear();
+            }
+        } else if (inBudget == false && predictSemantic) {
+            stats.nOverBudget += 1;
+        }
+
+        if (isSemantic == false) {
+            m_impl->tessellated.encodeDrawList(cmdList, out);
+        }
+
+        stats.nSemantic += isSemantic ? 1 : 0;
+        stats.nTessellated += isSemantic ? 0 : 1;
+        stats.bytesOut += out.size();
+
+        state.valid = true;
+        state.hash = hash;
+        state.outputSize = out.size();
+    }
+
+    return true;
+}
+
+void AdaptivePerDrawList::setGlyphTable(std::shared_ptr<const GlyphTable> glyphTable) {
+    m_impl->semantic.setGlyphTable(std::move(glyphTable));
+
+    // outputs reference the previous table revision
+    for (auto & state : m_impl->lists) {
+        state.valid = false;
+    }
+}
+
+void AdaptivePerDrawList::setCpuBudgetUs(uint32_t budgetUs) {
+    m_impl->cpuBudgetUs = budgetUs;
+}
+
+const AdaptivePerDrawList::Stats & AdaptivePerDrawList::getStats() const {
+    return m_impl->stats;
+}
+
+}
@@ -0,0 +1,451 @@
+/*! \file compressor-semantic-per-draw-list.cpp
+ *  \brief Primitive stream encoding of the draw lists, the client does the tessellation.
+ */
+
+#include "imgui-draw-data-compressor.h"
+
+#include "imgui.h"
+
+#include <cstring>
+#include <iterator>
+#include <unordered_map>
+
+namespace {
+
+// vertex stream ops, each op starts with a uint32 header: op in the low 8 bits, item count in the high 24 bits
+enum VtxOp : uint32_t {
+    kVtxRaw       = 0, // count x [x, y, u, v, col]
+    kVtxRect      = 1, // count x [x0, y0, x1, y1, u0, v0, u1, v1, col] -> 4 vertices (glyphs, images)
+    kVtxSolidRect = 2, // [u, v], count x [x0, y0, x1, y1, col]        -> 4 vertices sharing one uv (fills, straight lines)
+    kVtxUniform   = 3, // [u, v, col], count x [x, y]                   -> vertices sharing uv and color (fans, rotated lines)
+    kVtxGlyphs    = 4, // [scale, col, pen y], count x [glyph, pen x]   -> 4 vertices per glyph from the glyph table
+};
+
+// index stream ops
+enum IdxOp : uint32_t {
+    kIdxRaw   = 0, // count x [idx]
+    kIdxQuads = 1, // [base], count quads: base + 4*i + { 0, 1, 2, 0, 2, 3 }
+    kIdxFan   = 2, // [base], count vertices: (base, base + i - 1, base + i) for i in [2, count)
+};
+
+constexpr uint32_t kMaxOpCount = 0x00FFFFFF;
+
+struct Vtx {
+    uint32_t x;
+    uint32_t y;
+    uint32_t u;
+    uint32_t v;
+    uint32_t col;
+};
+
+template<typename T>
+    inline void write(const T & t, std::vector<char> & buf) {
+        std::copy((char *)(&t), (char *)(&t) + sizeof(T), std::back_inserter(buf));
+    }
+
+inline uint32_t bits(float f) {
+    uint32_t res;
+    std::memcpy(&res, &f, sizeof(res));
+    return res;
+}
+
+inline float fromBits(uint32_t b) {
+    float res;
+    std::memcpy(&res, &b, sizeof(res));
+    return res;
+}
+
+inline bool sameUvCol(const Vtx & a, const Vtx & b) {
+    return a.u == b.u && a.v == b.v && a.col == b.col;
+}
+
+// op header whose count is patched once the run ends
+struct OpWriter {
+    std::vector<char> & buf;
+    uint32_t op = 0;
+    uint32_t count = 0;
+    size_t headerOffset = 0;
+    bool open = false;
+
+    explicit OpWriter(std::vector<char> & buf) : buf(buf) {}
+
+    void begin(uint32_t newOp) {
+        end();
+        op = newOp;
+        count = 0;
+        headerOffset = buf.size();
+        write(op, buf);
+        open = true;
+    }
+
+    void end() {
+        if (open == false) return;
+        const uint32_t header = op | (count << 8);
+        std::memcpy(buf.data() + headerOffset, &header, sizeof(header));
+        open = false;
+    }
+
+    bool canAppend(uint32_t expectedOp) const {
+        return open && op == expectedOp && count < kMaxOpCount;
+    }
+};
+
+struct UvRect {
+    uint32_t u0;
+    uint32_t v0;
+    uint32_t u1;
+    uint32_t v1;
+
+    bool operator==(const UvRect & other) const {
+        return u0 == other.u0 && v0 == other.v0 && u1 == other.u1 && v1 == other.v1;
+    }
+};
+
+struct UvRectHash {
+    size_t operator()(const UvRect & r) const {
+        uint64_t h = r.u0;
+        h = h*0x9E3779B97F4A7C15ull ^ r.v0;
+        h = h*0x9E3779B97F4A7C15ull ^ r.u1;
+        h = h*0x9E3779B97F4A7C15ull ^ r.v1;
+        return (size_t)(h ^ (h >> 32));
+    }
+};
+
+struct GlyphLookup {
+    std::shared_ptr<const ImDrawDataCompressor::GlyphTable> table;
+    std::unordered_map<UvRect, uint32_t, UvRectHash> byUv;
+
+    void set(std::shared_ptr<const ImDrawDataCompressor::GlyphTable> newTable) {
+        table = std::move(newTable);
+        byUv.clear();
+        if (!table) return;
+
+        const uint32_t nGlyphs = (uint32_t)(table->glyphs.size()/ImDrawDataCompressor::GlyphTable::kFloatsPerGlyph);
+        byUv.reserve(nGlyphs);
+        for (uint32_t i = 0; i < nGlyphs; ++i) {
+            const float * g = table->glyphs.data() + i*ImDrawDataCompressor::GlyphTable::kFloatsPerGlyph;
+            byUv.emplace(UvRect { bits(g[4]), bits(g[5]), bits(g[6]), bits(g[7]) }, i);
+        }
+    }
+
+    const float * find(const Vtx & a, const Vtx & c, uint32_t & glyph) const {
+        if (byUv.empty()) return nullptr;
+
+        const auto it = byUv.find(UvRect { a.u, a.v, c.u, c.v });
+        if (it == byUv.end()) return nullptr;
+
+        glyph = it->second;
+        return table->glyphs.data() + glyph*ImDrawDataCompressor::GlyphTable::kFloatsPerGlyph;
+    }
+};
+
+// the client computes pen + glyph*scale in float32, one rounding per operation.
+// separate statements alone don't stop -ffp-contract=fast or /fp:fast from fusing them into an fma,
+// the volatile product is rounded to float before the add under any floating point model
+inline float glyphEdge(float pen, float glyphPos, float scale) {
+    volatile float scaled = glyphPos*scale;
+    return pen + scaled;
+}
+
+// finds a pen position reproducing both edges exactly, tries the hint first
+inline bool glyphPen(float p0, float p1, float g0, float g1, float scale, uint32_t hint, bool hasHint, uint32_t & pen) {
+    if (hasHint) {
+        const float h = fromBits(hint);
+        if (bits(glyphEdge(h, g0, scale)) == bits(p0) && bits(glyphEdge(h, g1, scale)) == bits(p1)) {
+            pen = hint;
+            return true;
+        }
+    }
+
+    const float scaled = g0*scale;
+    const float candidate = p0 - scaled;
+    if (bits(glyphEdge(candidate, g0, scale)) == bits(p0) && bits(glyphEdge(candidate, g1, scale)) == bits(p1)) {
+        pen = bits(candidate);
+        return true;
+    }
+
+    return false;
+}
+
+struct GlyphRun {
+    uint32_t scale = 0;
+    uint32_t col = 0;
+    uint32_t penY = 0;
+};
+
+bool matchGlyph(const float * g, const Vtx & a, const Vtx & c, uint32_t scale, const GlyphRun * run, uint32_t & penX, uint32_t & penY) {
+    const float s = fromBits(scale);
+    return
+        glyphPen(fromBits(a.y), fromBits(c.y), g[1], g[3], s, run ? run->penY : 0, run != nullptr, penY) &&
+        glyphPen(fromBits(a.x), fromBits(c.x), g[0], g[2], s, 0, false, penX);
+}
+
+bool emitGlyph(const GlyphLookup & glyphs, const Vtx & a, const Vtx & c, OpWriter & writer, GlyphRun & run, std::vector<char> & buf) {
+    uint32_t glyph = 0;
+    const float * g = glyphs.find(a, c, glyph);
+    if (g == nullptr) return false;
+
+    uint32_t penX = 0;
+    uint32_t penY = 0;
+
+    // continue the current run when the text shares its scale, color and baseline
+    const bool canContinue = writer.canAppend(kVtxGlyphs) && run.col == a.col;
+    if (canContinue && matchGlyph(g, a, c, run.scale, &run, penX, penY) && penY == run.penY) {
+        write(glyph, buf);
+        write(penX, buf);
+        return true;
+    }
+
+    // candidate scales: unscaled font, then the scale implied by the quad height
+    uint32_t scales[2] = { bits(1.0f), 0 };
+    uint32_t nScales = 1;
+    if (g[3] != g[1]) {
+        const float height = fromBits(c.y) - fromBits(a.y);
+        scales[nScales++] = bits(height/(g[3] - g[1]));
+    }
+
+    for (uint32_t i = 0; i < nScales; ++i) {
+        if (matchGlyph(g, a, c, scales[i], nullptr, penX, penY)) {
+            writer.begin(kVtxGlyphs);
+            run.scale = scales[i];
+            run.col = a.col;
+            run.penY = penY;
+            write(run.scale, buf);
+            write(run.col, buf);
+            write(run.penY, buf);
+            write(glyph, buf);
+            write(penX, buf);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// returns true when glyph runs were written
+bool writeVertices(const std::vector<Vtx> & vtx, const GlyphLookup & glyphs, std::vector<char> & buf) {
+    const size_t n = vtx.size();
+
+    OpWriter writer(buf);
+    Vtx runUv = {};
+    GlyphRun runGlyph;
+    bool hasGlyphs = false;
+
+    size_t k = 0;
+    while (k < n) {
+        if (k + 4 <= n) {
+            const Vtx & a = vtx[k + 0];
+            const Vtx & b = vtx[k + 1];
+            const Vtx & c = vtx[k + 2];
+            const Vtx & d = vtx[k + 3];
+
+            const bool isRect =
+                a.col == b.col && a.col == c.col && a.col == d.col &&
+                a.x == d.x && b.x == c.x && a.y == b.y && c.y == d.y &&
+                a.u == d.u && b.u == c.u && a.v == b.v && c.v == d.v;
+
+            if (isRect) {
+                if (a.u == c.u && a.v == c.v) {
+                    if (writer.canAppend(kVtxSolidRect) == false || runUv.u != a.u || runUv.v != a.v) {
+                        writer.begin(kVtxSolidRect);
+                        write(a.u, buf);
+                        write(a.v, buf);
+                        runUv = a;
+                    }
+                    write(a.x, buf);
+                    write(a.y, buf);
+                    write(c.x, buf);
+                    write(c.y, buf);
+                    write(a.col, buf);
+                } else if (emitGlyph(glyphs, a, c, writer, runGlyph, buf)) {
+                    hasGlyphs = true;
+                } else {
+                    if (writer.canAppend(kVtxRect) == false) {
+                        writer.begin(kVtxRect);
+                    }
+                    write(a.x, buf);
+                    write(a.y, buf);
+                    write(c.x, buf);
+                    write(c.y, buf);
+                    write(a.u, buf);
+                    write(a.v, buf);
+                    write(c.u, buf);
+                    write(c.v, buf);
+                    write(a.col, buf);
+                }
+                writer.count += 1;
+                k += 4;
+                continue;
+            }
+        }
+
+        const Vtx & cur = vtx[k];
+        const bool continuesUniform = writer.canAppend(kVtxUniform) && sameUvCol(runUv, cur);
+        const bool startsUniform = k + 1 < n && sameUvCol(cur, vtx[k + 1]);
+        if (continuesUniform || startsUniform) {
+            if (continuesUniform == false) {
+                writer.begin(kVtxUniform);
+                write(cur.u, buf);
+                write(cur.v, buf);
+                write(cur.col, buf);
+                runUv = cur;
+            }
+            write(cur.x, buf);
+            write(cur.y, buf);
+        } else {
+            if (writer.canAppend(kVtxRaw) == false) {
+                writer.begin(kVtxRaw);
+            }
+            write(cur, buf);
+        }
+        writer.count += 1;
+        k += 1;
+    }
+
+    writer.end();
+    return hasGlyphs;
+}
+
+void writeIndices(const ImDrawIdx * idx, uint32_t n, std::vector<char> & buf) {
+    static_assert(sizeof(ImDrawIdx) == sizeof(uint32_t), "semantic encoding expects 32-bit indices");
+
+    OpWriter writer(buf);
+
+    auto isQuad = [&](uint32_t p, uint32_t base) {
+        return p + 6 <= n &&
+            idx[p + 0] == base + 0 && idx[p + 1] == base + 1 && idx[p + 2] == base + 2 &&
+            idx[p + 3] == base + 0 && idx[p + 4] == base + 2 && idx[p + 5] == base + 3;
+    };
+
+    uint32_t p = 0;
+    while (p < n) {
+        const uint32_t base = idx[p];
+
+        if (isQuad(p, base)) {
+            writer.begin(kIdxQuads);
+            write(base, buf);
+            uint32_t nextBase = base;
+            while (isQuad(p, nextBase) && writer.count < kMaxOpCount) {
+                writer.count += 1;
+                nextBase += 4;
+                p += 6;
+            }
+            writer.end();
+            continue;
+        }
+
+        uint32_t nTriangles = 0;
+        while (p + 3*(nTriangles + 1) <= n && nTriangles + 2 < kMaxOpCount) {
+            const uint32_t t = p + 3*nTriangles;
+            if (idx[t] != base || idx[t + 1] != base + nTriangles + 1 || idx[t + 2] != base + nTriangles + 2) {
+                break;
+            }
+            ++nTriangles;
+        }
+
+        if (nTriangles >= 2) {
+            writer.begin(kIdxFan);
+            write(base, buf);
+            writer.count = nTriangles + 2;
+            writer.end();
+            p += 3*nTriangles;
+            continue;
+        }
+
+        if (writer.canAppend(kIdxRaw) == false) {
+            writer.begin(kIdxRaw);
+        }
+        write(idx[p], buf);
+        writer.count += 1;
+        p += 1;
+    }
+
+    writer.end();
+}
+
+void writeCmdListToBuffer(const ImDrawList * cmdList, const GlyphLookup & glyphs, std::vector<Vtx> & vtx, std::vector<char> & buf) {
+    uint32_t encoding = (uint32_t) ImDrawDataCompressor::Encoding::Semantic;
+    write(encoding, buf);
+
+    // 0 unless glyph runs are written, patched below. lists without text never wait for a new glyph table
+    const size_t glyphTableRevisionOffset = buf.size();
+    uint32_t glyphTableRevision = 0;
+    write(glyphTableRevision, buf);
+
+    const uint32_t nVertices = cmdList->VtxBuffer.Size;
+    const uint32_t nIndices = cmdList->IdxBuffer.Size;
+
+    // positions are sent relative to the first vertex, moving a window keeps the payload identical
+    float offsetX = nVertices > 0 ? cmdList->VtxBuffer[0].pos.x : 0.0f;
+    float offsetY = nVertices > 0 ? cmdList->VtxBuffer[0].pos.y : 0.0f;
+    write(offsetX, buf);
+    write(offsetY, buf);
+
+    write(nVertices, buf);
+    write(nIndices, buf);
+
+    vtx.resize(nVertices);
+    for (uint32_t i = 0; i < nVertices; ++i) {
+        const ImDrawVert & src = cmdList->VtxBuffer.Data[i];
+        Vtx & dst = vtx[i];
+        dst.x = bits(src.pos.x - offsetX);
+        dst.y = bits(src.pos.y - offsetY);
+        dst.u = bits(src.uv.x);
+        dst.v = bits(src.uv.y);
+        dst.col = src.col;
+    }
+
+    if (writeVertices(vtx, glyphs, buf)) {
+        glyphTableRevision = glyphs.table->revision;
+        std::memcpy(buf.data() + glyphTableRevisionOffset, &glyphTableRevision, sizeof(glyphTableRevision));
+    }
+    writeIndices(cmdList->IdxBuffer.Data, nIndices, buf);
+
+    uint32_t nCmd = cmdList->CmdBuffer.Size;
+    write(nCmd, buf);
+
+    for (uint32_t iCmd = 0; iCmd < nCmd; iCmd++) {
+        const ImDrawCmd * pcmd = &cmdList->CmdBuffer[iCmd];
+
+        write((uint32_t) pcmd->ElemCount, buf);
+        write((uint32_t)(intptr_t) pcmd->TextureId, buf);
+        write((uint32_t) pcmd->VtxOffset, buf);
+        write((uint32_t) pcmd->IdxOffset, buf);
+        write(pcmd->ClipRect, buf);
+    }
+}
+
+}
+
+namespace ImDrawDataCompressor {
+
+struct SemanticPerDrawList::Impl {
+    std::vector<Vtx> vtx;
+    GlyphLookup glyphs;
+};
+
+SemanticPerDrawList::SemanticPerDrawList() : m_impl(new Impl()) {}
+
+SemanticPerDrawList::~SemanticPerDrawList() {}
+
+bool SemanticPerDrawList::setDrawData(const ::ImDrawData * drawData) {
+    uint32_t nCmdLists = drawData->CmdListsCount;
+    m_drawListsCur.resize(nCmdLists);
+
+    for (uint32_t iList = 0; iList < nCmdLists; iList++) {
+        m_drawListsCur[iList].clear();
+        encodeDrawList(drawData->CmdLists[iList], m_drawListsCur[iList]);
+    }
+
+    return true;
+}
+
+void SemanticPerDrawList::encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) {
+    ::writeCmdListToBuffer(drawList, m_impl->glyphs, m_impl->vtx, buf);
+}
+
+void SemanticPerDrawList::setGlyphTable(std::shared_ptr<const GlyphTable> glyphTable) {
+    m_impl->glyphs.set(std::move(glyphTable));
+}
+
+}
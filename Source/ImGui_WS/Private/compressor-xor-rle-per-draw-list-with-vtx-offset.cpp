@@ -12,6 +12,9 @@
 namespace {
 
 void writeCmdListToBuffer(const ImDrawList * cmdList, std::vector<char> & buf) {
+    uint32_t encoding = (uint32_t) ImDrawDataCompressor::Encoding::Tessellated;
+    std::copy((char *)(&encoding), (char *)(&encoding) + sizeof(encoding), std::back_inserter(buf));
+
     float offsetX = cmdList->VtxBuffer[0].pos.x;
     float offsetY = cmdList->VtxBuffer[0].pos.y;
 
@@ -81,6 +84,10 @@ XorRlePerDrawListWithVtxOffset::XorRlePerDrawListWithVtxOffset() : m_impl(new Im
 
 XorRlePerDrawListWithVtxOffset::~XorRlePerDrawListWithVtxOffset() {}
 
+void XorRlePerDrawListWithVtxOffset::encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) {
+    ::writeCmdListToBuffer(drawList, buf);
+}
+
 bool XorRlePerDrawListWithVtxOffset::setDrawData(const ::ImDrawData * drawData) {
     m_drawListsPrev = m_drawListsCur;
 
@@ -89,7 +96,7 @@ bool XorRlePerDrawListWithVtxOffset::setDrawData(const ::ImDrawData * drawData)
 
     for (uint32_t iList = 0; iList < nCmdLists; iList++) {
         m_drawListsCur[iList].clear();
-        ::writeCmdListToBuffer(drawData->CmdLists[iList], m_drawListsCur[iList]);
+        encodeDrawList(drawData->CmdLists[iList], m_drawListsCur[iList]);
     }
 
     return true;
@@ -9,9 +9,24 @@
 #include <memory>
 
 struct ImDrawData;
+struct ImDrawList;
 
 namespace ImDrawDataCompressor {
 
+// first uint32 of every encoded draw list, tells the client how to decode the rest
+enum class Encoding : uint32_t {
+    Tessellated = 0, // raw vertex/index buffers
+    Semantic    = 1, // primitive stream, the client rebuilds the vertex/index buffers
+};
+
+// glyph quads of the font atlas, sent to the clients once per revision
+struct GlyphTable {
+    static constexpr uint32_t kFloatsPerGlyph = 8; // X0, Y0, X1, Y1, U0, V0, U1, V1
+
+    uint32_t revision = 0;
+    std::vector<float> glyphs;
+};
+
 class Interface {
 public:
     using DrawList = std::vector<char>;
@@ -24,6 +39,9 @@ public:
 
     virtual bool setDrawData(const ::ImDrawData * drawData) = 0;
 
+    // appends the encoding of a single draw list to buf
+    virtual void encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) = 0;
+
     virtual DrawLists & getDrawLists() {
         return m_drawListsCur;
     }
@@ -56,6 +74,63 @@ public:
     virtual ~XorRlePerDrawListWithVtxOffset();
 
     virtual bool setDrawData(const ::ImDrawData * drawData) override;
+    virtual void encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) override;
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+// Recognizes the primitives ImDrawList tessellates (rects, glyph quads, uniform colored fans and
+// line quads, quad/fan index patterns) and sends them as compact commands instead of triangles.
+// The client rebuilds the same vertex and index buffers the tessellated encoding would have sent.
+class SemanticPerDrawList : public Interface {
+public:
+    static constexpr auto kName = "SemanticPerDrawList";
+
+    SemanticPerDrawList();
+    virtual ~SemanticPerDrawList();
+
+    virtual bool setDrawData(const ::ImDrawData * drawData) override;
+    virtual void encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) override;
+
+    // glyph quads found in the table are sent as (glyph, pen x) runs, nullptr disables it
+    void setGlyphTable(std::shared_ptr<const GlyphTable> glyphTable);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+// Picks the tessellated or the semantic encoding per draw list from a cost model. The tessellated
+// size is known exactly, the semantic one is predicted from the last measured ratio of the list and
+// probed again from time to time. Unchanged lists keep their previous encoding in place when the caller
+// swaps the last output back into getDrawLists() before setDrawData, and once the CPU budget of the frame is spent the remaining lists fall back to the cheap encoding.
+class AdaptivePerDrawList : public Interface {
+public:
+    static constexpr auto kName = "AdaptivePerDrawList";
+
+    struct Stats {
+        uint32_t nTessellated = 0;
+        uint32_t nSemantic = 0;
+        uint32_t nReused = 0;
+        uint32_t nProbes = 0;
+        uint32_t nOverBudget = 0;
+        uint64_t bytesOut = 0;
+        uint64_t bytesTessellated = 0; // what the tessellated encoding alone would have sent
+    };
+
+    AdaptivePerDrawList();
+    virtual ~AdaptivePerDrawList();
+
+    virtual bool setDrawData(const ::ImDrawData * drawData) override;
+    virtual void encodeDrawList(const ::ImDrawList * drawList, DrawList & buf) override;
+
+    void setGlyphTable(std::shared_ptr<const GlyphTable> glyphTable);
+    void setCpuBudgetUs(uint32_t budgetUs);
+
+    // decisions of the last setDrawData call
+    const Stats & getStats() const;
 
 private:
     struct Impl;
@@ -14,10 +14,23 @@
 #include <shared_mutex>
 
 #include "imgui.h"
+#include "imgui_internal.h"
 #include "Incppect.h"
 #include "UnrealImGui_Log.h"
+#include "UnrealImGuiProfiler.h"
+#include "UnrealImGuiStat.h"
+#include "Algo/NoneOf.h"
+#include "Async/ParallelFor.h"
 #include "Containers/Queue.h"
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_Tessellated"), STAT_ImGuiWS_DrawList_Tessellated, STATGROUP_ImGui);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_Semantic"), STAT_ImGuiWS_DrawList_Semantic, STATGROUP_ImGui);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_Reused"), STAT_ImGuiWS_DrawList_Reused, STATGROUP_ImGui);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_Probes"), STAT_ImGuiWS_DrawList_Probes, STATGROUP_ImGui);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_OverBudget"), STAT_ImGuiWS_DrawList_OverBudget, STATGROUP_ImGui);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_Bytes"), STAT_ImGuiWS_DrawList_Bytes, STATGROUP_ImGui);
+DECLARE_DWORD_COUNTER_STAT(TEXT("ImGuiWS_DrawList_TessellatedBytes"), STAT_ImGuiWS_DrawList_TessellatedBytes, STATGROUP_ImGui);
+
 struct ImGuiWS::FImpl
 {
     struct FData
@@ -26,9 +39,51 @@ struct ImGuiWS::FImpl
         TMap<FTextureId, FTexture> Textures;
     };
 
+    // compressors keep state of the previous frame, every stream of draw data needs its own
+    struct FEncoder
+    {
+        FEncoder()
+            : CompressorTessellated(new ImDrawDataCompressor::XorRlePerDrawListWithVtxOffset())
+            , CompressorSemantic(new ImDrawDataCompressor::SemanticPerDrawList())
+            , CompressorAdaptive(new ImDrawDataCompressor::AdaptivePerDrawList())
+        {
+        }
+
+        std::unique_ptr<ImDrawDataCompressor::Interface> CompressorTessellated;
+        std::unique_ptr<ImDrawDataCompressor::SemanticPerDrawList> CompressorSemantic;
+        std::unique_ptr<ImDrawDataCompressor::AdaptivePerDrawList> CompressorAdaptive;
+        // the output lists hold the previous frame of the adaptive compressor
+        bool bAdaptiveOutput = false;
+
+        ImDrawDataCompressor::Interface& GetCompressor(EDrawListEncoding DrawListEncoding) const
+        {
+            switch (DrawListEncoding)
+            {
+            case EDrawListEncoding::Semantic:
+                return *CompressorSemantic;
+            case EDrawListEncoding::Adaptive:
+                return *CompressorAdaptive;
+            default:
+                return *CompressorTessellated;
+            }
+        }
+
+        void SetGlyphTable(const std::shared_ptr<const ImDrawDataCompressor::GlyphTable>& GlyphTable)
+        {
+            CompressorSemantic->setGlyphTable(GlyphTable);
+            CompressorAdaptive->setGlyphTable(GlyphTable);
+        }
+    };
+
+    struct FSession
+    {
+        FEncoder Encoder;
+        ImDrawDataCompressor::Interface::DrawLists DrawLists;
+        FDrawInfo DrawInfo;
+    };
+
     FImpl()
         : DrawInfo()
-        , CompressorDrawData(new ImDrawDataCompressor::XorRlePerDrawListWithVtxOffset())
     {
     }
 
@@ -37,6 +92,26 @@ struct ImGuiWS::FImpl
     TMap<int32, FTextureId> TextureIdMap;
     TMap<FTextureId, FTexture> Textures;
 
+    int64 TextureBudgetBytes = 0;
+    int64 TextureBytes = 0;
+    // advances once per frame of draw data, textures drawn in the current frame are never evicted
+    uint64 TextureFrame = 0;
+    bool bTextureFrameUsed = false;
+    // largest size the textures were drawn at in the current frame over all sessions
+    TMap<FTextureId, FVector2f> FrameDrawnSizes;
+    // set since the last tick, their served mip is rebuilt
+    TSet<FTextureId> ChangedTextures;
+    // a smaller drawn size lowers the served mip only after this many frames, zooming in raises it right away
+    static constexpr uint64 DrawnSizeHoldFrames = 120;
+    struct FEvictedTexture
+    {
+        // continued when the texture comes back, recorders key their content hashes by revision
+        int32 Revision;
+        bool bRestoreRequested = false;
+    };
+    TMap<FTextureId, FEvictedTexture> EvictedTextures;
+    TQueue<FTextureId> RestoreRequests;
+
     ImDrawDataCompressor::Interface::DrawLists DrawLists;
     FDrawInfo DrawInfo;
 
@@ -47,7 +122,314 @@ struct ImGuiWS::FImpl
     THandler HandlerConnect;
     THandler HandlerDisconnect;
 
-    std::unique_ptr<ImDrawDataCompressor::Interface> CompressorDrawData;
+    EDrawListEncoding DrawListEncoding = EDrawListEncoding::Tessellated;
+    uint32 AdaptiveEncodingBudgetUs = 2000;
+    FEncoder Encoder;
+
+    // keyed by client id, only touched by the ws thread
+    TMap<int32, TUniquePtr<FSession>> Sessions;
+
+    int32 GlyphTableRevision = 0;
+    TArray<uint8> GlyphTableData;
+    int32 FontSdfSpread = 0;
+    std::shared_ptr<const ImDrawDataCompressor::GlyphTable> GlyphTable;
+
+    bool Encode(FEncoder& InEncoder, const ImDrawData* DrawData, ImDrawDataCompressor::Interface::DrawLists& OutDrawLists) const
+    {
+        ImDrawDataCompressor::Interface& Compressor = InEncoder.GetCompressor(DrawListEncoding);
+
+        // hand the previous output back so unchanged lists are kept in place instead of copied
+        const bool bAdaptive = DrawListEncoding == EDrawListEncoding::Adaptive;
+        if (bAdaptive && InEncoder.bAdaptiveOutput)
+        {
+            Swap(Compressor.getDrawLists(), OutDrawLists);
+        }
+        InEncoder.bAdaptiveOutput = bAdaptive;
+
+        const bool Result = Compressor.setDrawData(DrawData);
+
+        if (bAdaptive)
+        {
+            const ImDrawDataCompressor::AdaptivePerDrawList::Stats& Stats = InEncoder.CompressorAdaptive->getStats();
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_Tessellated, Stats.nTessellated);
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_Semantic, Stats.nSemantic);
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_Reused, Stats.nReused);
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_Probes, Stats.nProbes);
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_OverBudget, Stats.nOverBudget);
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_Bytes, Stats.bytesOut);
+            INC_DWORD_STAT_BY(STAT_ImGuiWS_DrawList_TessellatedBytes, Stats.bytesTessellated);
+        }
+
+        OutDrawLists = MoveTemp(Compressor.getDrawLists());
+        return Result;
+    }
+
+    // the session of the client whose vars are being updated
+    const FSession* FindRequestingSession() const
+    {
+        const TUniquePtr<FSession>* Session = Sessions.Find(Incpp.RequestingClientId());
+        return Session ? Session->Get() : nullptr;
+    }
+
+    const FDrawInfo& GetDrawInfo() const
+    {
+        const FSession* Session = FindRequestingSession();
+        return Session ? Session->DrawInfo : DrawInfo;
+    }
+
+    const ImDrawDataCompressor::Interface::DrawLists& GetDrawLists() const
+    {
+        const FSession* Session = FindRequestingSession();
+        return Session ? Session->DrawLists : DrawLists;
+    }
+
+    void UpdateTextureIdMap()
+    {
+        TextureIdMap.Empty();
+        int32 Idx = 0;
+        for (const auto& [Id, _] : Textures)
+        {
+            TextureIdMap.Add(Idx, Id);
+            Idx += 1;
+        }
+    }
+
+    bool RemoveTexture(FTextureId TextureId)
+    {
+        FTexture Texture;
+        if (Textures.RemoveAndCopyValue(TextureId, Texture) == false)
+        {
+            return false;
+        }
+        TextureBytes -= Texture.Data.Num();
+        UpdateTextureIdMap();
+
+        TArray<uint8> Payload;
+        Payload.Append(reinterpret_cast<const uint8*>(&TextureId), sizeof(TextureId));
+        Incpp.ServerEvent(INDEX_NONE, EServerEventType::FreeTexture, MoveTemp(Payload));
+        return true;
+    }
+
+    void MarkUsedTextures(const ImDrawData* DrawData)
+    {
+        if (DrawData == nullptr)
+        {
+            return;
+        }
+        for (int32 ListIdx = 0; ListIdx < DrawData->CmdListsCount; ++ListIdx)
+        {
+            const ImDrawList* DrawList = DrawData->CmdLists[ListIdx];
+            for (const ImDrawCmd& Cmd : DrawList->CmdBuffer)
+            {
+                const FTextureId TextureId = (FTextureId)(intptr_t)Cmd.TextureId;
+                // the font atlas is always sent whole and draws most triangles
+                // textures set in this frame are only added with the next tick, their size is still taken
+                if (TextureId != 0)
+                {
+                    AddDrawnSize(TextureId, *DrawList, Cmd);
+                }
+                if (FTexture* Texture = Textures.Find(TextureId))
+                {
+                    Texture->LastUsedFrame = TextureFrame;
+                }
+                else if (FEvictedTexture* Evicted = EvictedTextures.Find(TextureId))
+                {
+                    if (Evicted->bRestoreRequested == false)
+                    {
+                        Evicted->bRestoreRequested = true;
+                        RestoreRequests.Enqueue(TextureId);
+                    }
+                }
+            }
+        }
+        bTextureFrameUsed = true;
+    }
+
+    // pixels across the whole texture from the position and uv extents of every triangle
+    void AddDrawnSize(FTextureId TextureId, const ImDrawList& DrawList, const ImDrawCmd& Cmd)
+    {
+        FVector2f& DrawnSize = FrameDrawnSizes.FindOrAdd(TextureId, FVector2f::ZeroVector);
+        for (uint32 Idx = 0; Idx + 3 <= Cmd.ElemCount; Idx += 3)
+        {
+            ImVec2 PosMin{ FLT_MAX, FLT_MAX }, PosMax{ -FLT_MAX, -FLT_MAX };
+            ImVec2 UVMin{ FLT_MAX, FLT_MAX }, UVMax{ -FLT_MAX, -FLT_MAX };
+            for (uint32 Corner = 0; Corner < 3; ++Corner)
+            {
+                const ImDrawVert& Vtx = DrawList.VtxBuffer[Cmd.VtxOffset + DrawList.IdxBuffer[Cmd.IdxOffset + Idx + Corner]];
+                PosMin = ImMin(PosMin, Vtx.pos);
+                PosMax = ImMax(PosMax, Vtx.pos);
+                UVMin = ImMin(UVMin, Vtx.uv);
+                UVMax = ImMax(UVMax, Vtx.uv);
+            }
+            constexpr float MinUVExtent = 1e-4f;
+            if (UVMax.x - UVMin.x > MinUVExtent)
+            {
+                DrawnSize.X = FMath::Max(DrawnSize.X, (PosMax.x - PosMin.x) / (UVMax.x - UVMin.x));
+            }
+            if (UVMax.y - UVMin.y > MinUVExtent)
+            {
+                DrawnSize.Y = FMath::Max(DrawnSize.Y, (PosMax.y - PosMin.y) / (UVMax.y - UVMin.y));
+            }
+        }
+    }
+
+    static int32 GetBytesPerPixel(FTexture::Type TextureType)
+    {
+        switch (TextureType)
+        {
+            case FTexture::Type::RGB24:  return 3;
+            case FTexture::Type::RGBA32: return 4;
+            default: return 1;
+        }
+    }
+
+    // the smallest mip still covering the drawn size, textures nobody draws get the last one
+    static int32 GetServedLevel(const FTexture& Texture)
+    {
+        const int32 NeedWidth = FMath::CeilToInt(Texture.DrawnSize.X);
+        const int32 NeedHeight = FMath::CeilToInt(Texture.DrawnSize.Y);
+        int32 Level = 0;
+        while ((Texture.Width >> (Level + 1)) >= FMath::Max(NeedWidth, 1) && (Texture.Height >> (Level + 1)) >= FMath::Max(NeedHeight, 1))
+        {
+            Level += 1;
+        }
+        return Level;
+    }
+
+    // every level halves the image, a pixel averages the 2x2 pixels under it
+    static void BoxFilter(const uint8* Src, int32 Width, int32 Height, int32 Bpp, int32 Levels, TArray<uint8>& Out, int32& OutWidth, int32& OutHeight)
+    {
+        TArray<uint8> Level;
+        for (int32 L = 0; L < Levels; ++L)
+        {
+            const int32 MipWidth = FMath::Max(Width / 2, 1);
+            const int32 MipHeight = FMath::Max(Height / 2, 1);
+            Level.SetNumUninitialized(MipWidth * MipHeight * Bpp);
+            for (int32 Y = 0; Y < MipHeight; ++Y)
+            {
+                const uint8* Row0 = Src + FMath::Min(2 * Y, Height - 1) * Width * Bpp;
+                const uint8* Row1 = Src + FMath::Min(2 * Y + 1, Height - 1) * Width * Bpp;
+                uint8* Dst = Level.GetData() + Y * MipWidth * Bpp;
+                for (int32 X = 0; X < MipWidth; ++X)
+                {
+                    const int32 X0 = FMath::Min(2 * X, Width - 1) * Bpp;
+                    const int32 X1 = FMath::Min(2 * X + 1, Width - 1) * Bpp;
+                    for (int32 C = 0; C < Bpp; ++C)
+                    {
+                        Dst[X * Bpp + C] = (Row0[X0 + C] + Row0[X1 + C] + Row1[X0 + C] + Row1[X1 + C] + 2) / 4;
+                    }
+                }
+            }
+            Out = MoveTemp(Level);
+            Src = Out.GetData();
+            Width = MipWidth;
+            Height = MipHeight;
+        }
+        OutWidth = Width;
+        OutHeight = Height;
+    }
+
+    void UpdateServedData(FTexture& Texture)
+    {
+        Texture.ServedData.Reset();
+        if (Texture.ServedLevel == 0)
+        {
+            return;
+        }
+        TArray<uint8> Pixels;
+        int32 Width, Height;
+        BoxFilter(Texture.GetPixels().GetData(), Texture.Width, Texture.Height, GetBytesPerPixel(Texture.TextureType), Texture.ServedLevel, Pixels, Width, Height);
+        Texture.ServedData.SetNumUninitialized(FTexture::HeaderSize + Pixels.Num());
+        // the header of Data with the size of the mip
+        FMemory::Memcpy(Texture.ServedData.GetData(), Texture.Data.GetData(), FTexture::HeaderSize);
+        FMemory::Memcpy(Texture.ServedData.GetData() + sizeof(FTextureId) + sizeof(FTexture::Type), &Width, sizeof(Width));
+        FMemory::Memcpy(Texture.ServedData.GetData() + sizeof(FTextureId) + sizeof(FTexture::Type) + sizeof(int32), &Height, sizeof(Height));
+        FMemory::Memcpy(Texture.ServedData.GetData() + FTexture::HeaderSize, Pixels.GetData(), Pixels.Num());
+    }
+
+    void UpdateServedLevels(bool bNewFrame)
+    {
+        for (auto& [Id, Texture] : Textures)
+        {
+            if (Id == 0)
+            {
+                continue;
+            }
+            if (bNewFrame)
+            {
+                const FVector2f FrameSize = FrameDrawnSizes.FindRef(Id);
+                if (FrameSize.X > Texture.DrawnSize.X || FrameSize.Y > Texture.DrawnSize.Y)
+                {
+                    Texture.DrawnSize = FVector2f::Max(Texture.DrawnSize, FrameSize);
+                    Texture.DrawnSizeFrame = TextureFrame;
+                }
+                else if (TextureFrame - Texture.DrawnSizeFrame > DrawnSizeHoldFrames)
+                {
+                    Texture.DrawnSize = FrameSize;
+                    Texture.DrawnSizeFrame = TextureFrame;
+                }
+            }
+
+            bool bChanged = ChangedTextures.Contains(Id);
+            const int32 Level = GetServedLevel(Texture);
+            if (Level != Texture.ServedLevel)
+            {
+                Texture.ServedLevel = Level;
+                // a new revision makes the clients fetch the other mip, a changed texture already has one
+                if (bChanged == false)
+                {
+                    Texture.Revision += 1;
+                    FMemory::Memcpy(Texture.Data.GetData() + FTexture::HeaderSize - sizeof(int32), &Texture.Revision, sizeof(Texture.Revision));
+                    bChanged = true;
+                }
+            }
+            if (bChanged)
+            {
+                UpdateServedData(Texture);
+            }
+        }
+        ChangedTextures.Reset();
+        if (bNewFrame)
+        {
+            FrameDrawnSizes.Reset();
+        }
+    }
+
+    void TickTextures()
+    {
+        UpdateServedLevels(bTextureFrameUsed);
+        EvictTextures();
+        if (bTextureFrameUsed)
+        {
+            bTextureFrameUsed = false;
+            TextureFrame += 1;
+        }
+    }
+
+    void EvictTextures()
+    {
+        while (TextureBudgetBytes > 0 && TextureBytes > TextureBudgetBytes)
+        {
+            // rare and few textures, a linear search for the least recently drawn
+            const FTextureId* OldestId = nullptr;
+            const FTexture* Oldest = nullptr;
+            for (const auto& [Id, Texture] : Textures)
+            {
+                if (Texture.bEvictable && Texture.LastUsedFrame < TextureFrame && (Oldest == nullptr || Texture.LastUsedFrame < Oldest->LastUsedFrame))
+                {
+                    OldestId = &Id;
+                    Oldest = &Texture;
+                }
+            }
+            if (Oldest == nullptr)
+            {
+                break;
+            }
+            const FTextureId TextureId = *OldestId;
+            EvictedTextures.Add(TextureId, { Oldest->Revision });
+            RemoveTexture(TextureId);
+        }
+    }
 
     using FAsyncTask = TFunction<void(FImpl&)>;
     TQueue<FAsyncTask> AsyncTasks;
@@ -101,41 +483,41 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
     // sync mouse cursor
     Impl->Incpp.Var(TEXT("imgui.mouse_cursor"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawInfo.MouseCursor);
+        return FIncppect::view(Impl->GetDrawInfo().MouseCursor);
     });
 
     // current control_id
     Impl->Incpp.Var(TEXT("control_id"), [this](const auto& )
     {
-       return FIncppect::view(Impl->DrawInfo.ControlId);
+       return FIncppect::view(Impl->GetDrawInfo().ControlId);
     });
 
     // current control IP
     Impl->Incpp.Var(TEXT("control_ip"), [this](const auto& )
     {
-       return FIncppect::view(Impl->DrawInfo.ControlIp);
+       return FIncppect::view(Impl->GetDrawInfo().ControlIp);
     });
 
     Impl->Incpp.Var(TEXT("imgui.want_input_text"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawInfo.bWantTextInput);
+        return FIncppect::view(Impl->GetDrawInfo().bWantTextInput);
     });
 
     Impl->Incpp.Var(TEXT("imgui.input_pos"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawInfo.ImeInputPos);
+        return FIncppect::view(Impl->GetDrawInfo().ImeInputPos);
     });
 
     // sync to uncontrol mouse position
     Impl->Incpp.Var(TEXT("imgui.mouse_pos"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawInfo.MousePos);
+        return FIncppect::view(Impl->GetDrawInfo().MousePos);
     });
 
     // sync to uncontrol viewport size
     Impl->Incpp.Var(TEXT("imgui.viewport_size"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawInfo.ViewportSize);
+        return FIncppect::view(Impl->GetDrawInfo().ViewportSize);
     });
 
     // texture ids
@@ -165,30 +547,48 @@ bool ImGuiWS::Init(int32 PortListen, const FString& PathOnDisk)
         if (const FTexture* Texture = Impl->Textures.Find(TextureId))
         {
             static TArray<uint8> Data;
-            Data = Texture->Data;
+            Data = Texture->ServedData.Num() > 0 ? Texture->ServedData : Texture->Data;
             return std::string_view { reinterpret_cast<char*>(Data.GetData()), (uint32)Data.Num() };
         }
         return std::string_view { nullptr, 0 };
     });
 
+    // glyph table of the font atlas, used to expand glyph runs of semantic draw lists
+    Impl->Incpp.Var(TEXT("imgui.glyph_table_revision"), [this](const auto& )
+    {
+        return FIncppect::view(Impl->GlyphTableRevision);
+    });
+
+    Impl->Incpp.Var(TEXT("imgui.glyph_table"), [this](const auto& )
+    {
+        return std::string_view { reinterpret_cast<char*>(Impl->GlyphTableData.GetData()), (uint32)Impl->GlyphTableData.Num() };
+    });
+
+    // clients resolve the font texture as distance field when not 0
+    Impl->Incpp.Var(TEXT("imgui.font_sdf_spread"), [this](const auto& )
+    {
+        return FIncppect::view(Impl->FontSdfSpread);
+    });
+
     // get imgui's draw data
     Impl->Incpp.Var(TEXT("imgui.n_draw_lists"), [this](const auto& )
     {
-        return FIncppect::view(Impl->DrawLists.size());
+        return FIncppect::view(Impl->GetDrawLists().size());
     });
 
     Impl->Incpp.Var(TEXT("imgui.draw_list[%d]"), [this](const auto& idxs)
     {
         static std::vector<char> data;
         {
-            if (idxs[0] >= (int32) Impl->DrawLists.size())
+            const auto& DrawLists = Impl->GetDrawLists();
+            if (idxs[0] >= (int32) DrawLists.size())
             {
                 return std::string_view { nullptr, 0 };
             }
 
             data.clear();
-            std::copy(Impl->DrawLists[idxs[0]].data(),
-                      Impl->DrawLists[idxs[0]].data() + Impl->DrawLists[idxs[0]].size(),
+            std::copy(DrawLists[idxs[0]].data(),
+                      DrawLists[idxs[0]].data() + DrawLists[idxs[0]].size(),
                       std::back_inserter(data));
         }
 
@@ -324,10 +724,26 @@ void ImGuiWS::Tick()
         Impl->AsyncTasks.Dequeue(Task);
         Task(*Impl);
     }
+    Impl->TickTextures();
     Impl->Incpp.Tick();
+
+    using namespace UnrealImGui;
+    if (Profiler::IsEnabled())
+    {
+        const FIncppect::FTickStats& TickStats = Impl->Incpp.GetTickStats();
+        if (TickStats.SentBytes.Num() > 0)
+        {
+            Profiler::AddSample(Profiler::EGroup::WSThread, TEXT("Diff"), TickStats.DiffMs);
+            Profiler::AddSample(Profiler::EGroup::WSThread, TEXT("Send"), TickStats.SendMs);
+        }
+        for (const auto& [ClientId, SentBytes] : TickStats.SentBytes)
+        {
+            Profiler::AddSample(Profiler::EGroup::Clients, *FString::Printf(TEXT("Client %d"), ClientId), SentBytes);
+        }
+    }
 }
 
-bool ImGuiWS::SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32 Width, int32 Height, const uint8* Data)
+bool ImGuiWS::SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32 Width, int32 Height, const uint8* Data, bool bEvictable)
 {
     int32 bpp = 1; // bytes per pixel
     switch (TextureType)
@@ -338,7 +754,7 @@ bool ImGuiWS::SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32
         case FTexture::Type::RGBA32: bpp = 4; break;
     }
     TArray<uint8> TextureData;
-    TextureData.SetNumUninitialized(sizeof(FTextureId) + sizeof(FTexture::Type) + 3*sizeof(int32) + bpp*Width*Height);
+    TextureData.SetNumUninitialized(FTexture::HeaderSize + bpp*Width*Height);
 
     size_t Offset = 0;
     FMemory::Memcpy(TextureData.GetData() + Offset, &TextureId, sizeof(TextureId)); Offset += sizeof(TextureId);
@@ -348,43 +764,175 @@ bool ImGuiWS::SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32
     const int32 RevisionOffset = Offset; Offset += sizeof(int32);
     FMemory::Memcpy(TextureData.GetData() + Offset, Data, bpp*Width*Height);
 
-    Impl->AsyncTasks.Enqueue([TextureId, TextureData = MoveTemp(TextureData), RevisionOffset](FImpl& ImplRef) mutable
+    Impl->AsyncTasks.Enqueue([TextureId, TextureType, Width, Height, TextureData = MoveTemp(TextureData), RevisionOffset, bEvictable](FImpl& ImplRef) mutable
     {
-        FTexture& Texture = ImplRef.Textures.FindOrAdd(TextureId);
-        if (Texture.Revision == 0)
+        FTexture* Texture = ImplRef.Textures.Find(TextureId);
+        if (Texture == nullptr)
         {
-            ImplRef.TextureIdMap.Empty();
-            int32 Idx = 0;
-            for (const auto& [Id, _] : ImplRef.Textures)
+            Texture = &ImplRef.Textures.Add(TextureId);
+            FImpl::FEvictedTexture Evicted;
+            if (ImplRef.EvictedTextures.RemoveAndCopyValue(TextureId, Evicted))
             {
-                ImplRef.TextureIdMap.Add(Idx, Id);
-                Idx += 1;
+                Texture->Revision = Evicted.Revision;
             }
+            ImplRef.UpdateTextureIdMap();
         }
-        Texture.Revision++;
-        const int32 Revision = Texture.Revision;
-
-        Texture.Data = MoveTemp(TextureData);
-        FMemory::Memcpy(Texture.Data.GetData() + RevisionOffset, &Revision, sizeof(Revision));
+        Texture->TextureType = TextureType;
+        Texture->Width = Width;
+        Texture->Height = Height;
+        Texture->bEvictable = bEvictable;
+        Texture->LastUsedFrame = ImplRef.TextureFrame;
+        Texture->Revision++;
+        const int32 Revision = Texture->Revision;
+
+        ImplRef.TextureBytes += TextureData.Num() - Texture->Data.Num();
+        Texture->Data = MoveTemp(TextureData);
+        FMemory::Memcpy(Texture->Data.GetData() + RevisionOffset, &Revision, sizeof(Revision));
+        ImplRef.ChangedTextures.Add(TextureId);
     });
 
     return true;
 }
 
-bool ImGuiWS::SetDrawData(const ImDrawData* DrawData)
+void ImGuiWS::RemoveTexture(FTextureId TextureId)
+{
+    Impl->AsyncTasks.Enqueue([TextureId](FImpl& ImplRef)
+    {
+        ImplRef.EvictedTextures.Remove(TextureId);
+        ImplRef.RemoveTexture(TextureId);
+    });
+}
+
+void ImGuiWS::SetTextureBudget(int64 MaxBytes)
+{
+    Impl->TextureBudgetBytes = MaxBytes;
+}
+
+TQueue<ImGuiWS::FTextureId>& ImGuiWS::TakeRestoreRequests()
+{
+    return Impl->RestoreRequests;
+}
+
+void ImGuiWS::ForEachTexture(TFunctionRef<void(FTextureId TextureId, const FTexture& Texture)> Func) const
 {
-    bool Result = true;
+    for (const auto& [Id, Texture] : Impl->Textures)
+    {
+        Func(Id, Texture);
+    }
+}
+
+void ImGuiWS::SetFontAtlas(const ImFontAtlas* FontAtlas, int32 SdfSpread)
+{
+    static std::atomic<uint32> NextRevision = 0;
+
+    using ImDrawDataCompressor::GlyphTable;
+    const std::shared_ptr<GlyphTable> Table = std::make_shared<GlyphTable>();
+    Table->revision = ++NextRevision;
+    for (const ImFont* Font : FontAtlas->Fonts)
+    {
+        for (const ImFontGlyph& Glyph : Font->Glyphs)
+        {
+            if (Glyph.Visible == false)
+            {
+                continue;
+            }
+            const float Floats[GlyphTable::kFloatsPerGlyph] = { Glyph.X0, Glyph.Y0, Glyph.X1, Glyph.Y1, Glyph.U0, Glyph.V0, Glyph.U1, Glyph.V1 };
+            Table->glyphs.insert(Table->glyphs.end(), std::begin(Floats), std::end(Floats));
+        }
+    }
 
-    Result &= Impl->CompressorDrawData->setDrawData(DrawData);
+    // revision, number of glyphs, glyphs
+    const uint32 NumGlyphs = Table->glyphs.size() / GlyphTable::kFloatsPerGlyph;
+    TArray<uint8> TableData;
+    TableData.SetNumUninitialized(2*sizeof(uint32) + Table->glyphs.size()*sizeof(float));
+    FMemory::Memcpy(TableData.GetData(), &Table->revision, sizeof(uint32));
+    FMemory::Memcpy(TableData.GetData() + sizeof(uint32), &NumGlyphs, sizeof(uint32));
+    FMemory::Memcpy(TableData.GetData() + 2*sizeof(uint32), Table->glyphs.data(), Table->glyphs.size()*sizeof(float));
 
-    auto& DrawLists = Impl->CompressorDrawData->getDrawLists();
+    Impl->AsyncTasks.Enqueue([Table, TableData = MoveTemp(TableData), SdfSpread](FImpl& ImplRef) mutable
+    {
+        ImplRef.FontSdfSpread = SdfSpread;
+        ImplRef.GlyphTableRevision = Table->revision;
+        ImplRef.GlyphTableData = MoveTemp(TableData);
+        ImplRef.GlyphTable = Table;
+        ImplRef.Encoder.SetGlyphTable(Table);
+        for (const auto& [ClientId, Session] : ImplRef.Sessions)
+        {
+            Session->Encoder.SetGlyphTable(Table);
+        }
+    });
+}
 
+bool ImGuiWS::SetDrawData(const ImDrawData* DrawData)
+{
+    Impl->MarkUsedTextures(DrawData);
     // make the draw lists available to incppect clients
-    Impl->DrawLists = MoveTemp(DrawLists);
+    return Impl->Encode(Impl->Encoder, DrawData, Impl->DrawLists);
+}
+
+bool ImGuiWS::SetSessionsDrawData(TConstArrayView<FSessionDrawData> SessionsDrawData)
+{
+    for (auto It = Impl->Sessions.CreateIterator(); It; ++It)
+    {
+        const int32 ClientId = It.Key();
+        if (Algo::NoneOf(SessionsDrawData, [ClientId](const FSessionDrawData& SessionDrawData) { return SessionDrawData.ClientId == ClientId; }))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    TArray<FImpl::FSession*, TInlineAllocator<8>> Sessions;
+    for (const FSessionDrawData& SessionDrawData : SessionsDrawData)
+    {
+        TUniquePtr<FImpl::FSession>& Session = Impl->Sessions.FindOrAdd(SessionDrawData.ClientId);
+        if (Session.IsValid() == false)
+        {
+            Session = MakeUnique<FImpl::FSession>();
+            Session->Encoder.CompressorAdaptive->setCpuBudgetUs(Impl->AdaptiveEncodingBudgetUs);
+            if (Impl->GlyphTable)
+            {
+                Session->Encoder.SetGlyphTable(Impl->GlyphTable);
+            }
+        }
+        Session->DrawInfo = SessionDrawData.DrawInfo;
+        Sessions.Add(Session.Get());
+    }
+
+    for (const FSessionDrawData& SessionDrawData : SessionsDrawData)
+    {
+        Impl->MarkUsedTextures(SessionDrawData.DrawData);
+    }
+
+    // sessions share no compressor state, encode them on the task graph
+    std::atomic<bool> Result = true;
+    ParallelFor(Sessions.Num(), [&](int32 Idx)
+    {
+        if (Impl->Encode(Sessions[Idx]->Encoder, SessionsDrawData[Idx].DrawData, Sessions[Idx]->DrawLists) == false)
+        {
+            Result = false;
+        }
+    });
 
     return Result;
 }
 
+void ImGuiWS::SetDrawListEncoding(EDrawListEncoding Encoding)
+{
+    static_assert((int32)EDrawListEncoding::Tessellated == (int32)ImDrawDataCompressor::Encoding::Tessellated, "");
+    static_assert((int32)EDrawListEncoding::Semantic == (int32)ImDrawDataCompressor::Encoding::Semantic, "");
+    Impl->DrawListEncoding = Encoding;
+}
+
+void ImGuiWS::SetAdaptiveEncodingBudget(uint32 BudgetUs)
+{
+    Impl->AdaptiveEncodingBudgetUs = BudgetUs;
+    Impl->Encoder.CompressorAdaptive->setCpuBudgetUs(BudgetUs);
+    for (const auto& [ClientId, Session] : Impl->Sessions)
+    {
+        Session->Encoder.CompressorAdaptive->setCpuBudgetUs(BudgetUs);
+    }
+}
+
 void ImGuiWS::SetDrawInfo(const FDrawInfo& DrawInfo)
 {
     Impl->DrawInfo = DrawInfo;
@@ -29,9 +29,25 @@ public:
             RGB24  = 2,
             RGBA32 = 3,
         };
+        // id, type, width, height and revision in front of the pixels
+        static constexpr int32 HeaderSize = sizeof(FTextureId) + sizeof(Type) + 3*sizeof(int32);
 
         int32 Revision = 0;
+        Type TextureType = Type::Alpha8;
+        int32 Width = 0;
+        int32 Height = 0;
         TArray<uint8> Data;
+        // the owner can set it again, so it may be dropped when over the texture budget
+        bool bEvictable = false;
+        uint64 LastUsedFrame = 0;
+        // largest size in pixels the whole texture was recently drawn at
+        FVector2f DrawnSize = FVector2f::ZeroVector;
+        uint64 DrawnSizeFrame = 0;
+        // box filtered mip sent to the clients while the texture is only drawn small, empty sends Data
+        int32 ServedLevel = 0;
+        TArray<uint8> ServedData;
+
+        TConstArrayView<uint8> GetPixels() const { return TConstArrayView<uint8>{ Data }.RightChop(HeaderSize); }
     };
 
     struct FEvent
@@ -77,14 +93,36 @@ public:
         std::string InputtedText;
     };
 
+    // how draw lists are encoded for the clients, see ImDrawDataCompressor::Encoding
+    enum class EDrawListEncoding : int32
+    {
+        Tessellated = 0,
+        Semantic = 1,
+        // per draw list choice of the smaller encoding under a cpu budget
+        Adaptive = 2,
+    };
+
     ImGuiWS();
     ~ImGuiWS();
 
     bool Init(int32 PortListen, const FString& PathOnDisk);
     bool Init(int32 PortListen, const FString& PathOnDisk, THandler&& ConnectHandler, THandler&& DisconnectHandler);
     void Tick();
-    bool SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32 Width, int32 Height, const uint8* Data);
+    bool SetTexture(FTextureId TextureId, FTexture::Type TextureType, int32 Width, int32 Height, const uint8* Data, bool bEvictable = false);
+    // the clients are told to free it as well
+    void RemoveTexture(FTextureId TextureId);
+    // evictable textures drawn least recently are dropped while the textures take more bytes, 0 keeps all
+    void SetTextureBudget(int64 MaxBytes);
+    // evicted textures that are drawn again, the owner is expected to set them again
+    TQueue<FTextureId>& TakeRestoreRequests();
+    // only on the thread calling Tick, textures set since the last Tick aren't visited yet
+    void ForEachTexture(TFunctionRef<void(FTextureId TextureId, const FTexture& Texture)> Func) const;
     bool SetDrawData(const struct ImDrawData* DrawData);
+    void SetDrawListEncoding(EDrawListEncoding Encoding);
+    void SetAdaptiveEncodingBudget(uint32 BudgetUs);
+    // sends glyph quads as runs against the atlas glyphs, call again when the atlas is rebuilt
+    // SdfSpread is the distance in pixels covered by the glyphs of a distance field atlas, 0 when they hold coverage
+    void SetFontAtlas(const struct ImFontAtlas* FontAtlas, int32 SdfSpread = 0);
     struct FDrawInfo
     {
         int32 MouseCursor = 0;
@@ -96,11 +134,29 @@ public:
         FVector2f ImeInputPos;
     };
     void SetDrawInfo(const FDrawInfo& DrawInfo);
+    struct FSessionDrawData
+    {
+        int32 ClientId;
+        const struct ImDrawData* DrawData;
+        FDrawInfo DrawInfo;
+    };
+    // independent frame per client, clients without a session receive the SetDrawData frame
+    bool SetSessionsDrawData(TConstArrayView<FSessionDrawData> SessionsDrawData);
     void AddVar(const TPath& Path, TGetter&& Getter);
     void AddServerEvent(int32 ClientId, int32 EventId, TArray<uint8>&& Payload);
 
     int32 NumConnected() const;
 
+    // must match ServerEventType in imgui-ws.js
+    struct EServerEventType
+    {
+        enum Type : int32
+        {
+            SetClipboardText,
+            FreeTexture,
+        };
+    };
+
     TQueue<FEvent>& TakeEvents();
 private:
     struct FImpl;
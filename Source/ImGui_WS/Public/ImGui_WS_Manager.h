@@ -27,6 +27,8 @@ public:
 	bool IsRecording() const;
 	void StartRecord();
 	void StopRecord();
+	// saves the last served frames kept by the black box record in the background, see ImGui.WS.BlackBoxSeconds
+	bool DumpBlackBox();
 protected:
 	int32 DrawContextIndex = 0;
 	void Initialize(FSubsystemCollectionBase& Collection) override;
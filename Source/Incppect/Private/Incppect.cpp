@@ -9,12 +9,83 @@
 
 DECLARE_STATS_GROUP (TEXT("Incppect"), STATGROUP_Incppect, STATCAT_Advanced);
 
+DECLARE_DWORD_COUNTER_STAT(TEXT("Incppect_NumFull"), STAT_Incppect_NumFull, STATGROUP_Incppect);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Incppect_NumDiff"), STAT_Incppect_NumDiff, STATGROUP_Incppect);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Incppect_NumSkipped"), STAT_Incppect_NumSkipped, STATGROUP_Incppect);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Incppect_NumDiffRejected"), STAT_Incppect_NumDiffRejected, STATGROUP_Incppect);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Incppect_SentBytes"), STAT_Incppect_SentBytes, STATGROUP_Incppect);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Incppect_SavedBytes"), STAT_Incppect_SavedBytes, STATGROUP_Incppect);
+
 namespace
 {
     inline int64 TimeStamp()
     {
         return FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64());
     }
+
+    // requests whose diffs stop paying off are sent full, and probed again every few updates
+    constexpr float kMaxDiffRatio = 0.9f;
+    constexpr int32 kDiffProbeInterval = 16;
+
+    // run-length encoding of PrevData ^ CurData, gives up once the diff reaches MaxBytes
+    bool WriteRleDiff(const uint8* PrevData, const uint8* CurData, int32 Num, int32 MaxBytes, TArray<uint8>& DiffData)
+    {
+        uint32 a = 0;
+        uint32 b = 0;
+        uint32 c = 0;
+        uint32 n = 0;
+        for (int32 Idx = 0; Idx + 4 <= Num; Idx += 4)
+        {
+            FMemory::Memcpy(&a, PrevData + Idx, sizeof(a));
+            FMemory::Memcpy(&b, CurData + Idx, sizeof(b));
+            a = a ^ b;
+            if (a == c)
+            {
+                ++n;
+            }
+            else
+            {
+                if (n > 0)
+                {
+                    DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+                    DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+                    if (DiffData.Num() >= MaxBytes)
+                    {
+                        return false;
+                    }
+                }
+                n = 1;
+                c = a;
+            }
+        }
+
+        if (Num % 4 != 0)
+        {
+            a = 0;
+            b = 0;
+            const uint32 Idx = (Num/4)*4;
+            const uint32 k = Num - Idx;
+            FMemory::Memcpy(&a, PrevData + Idx, k);
+            FMemory::Memcpy(&b, CurData + Idx, k);
+            a = a ^ b;
+            if (a == c)
+            {
+                ++n;
+            }
+            else
+            {
+                DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+                DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+                n = 1;
+                c = a;
+            }
+        }
+
+        DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
+        DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
+
+        return DiffData.Num() < MaxBytes;
+    }
 }
 
 struct FIncppect::FImpl
@@ -31,6 +102,10 @@ struct FIncppect::FImpl
         int32 GetterId = -1;
 
         TArray<uint8> PrevData;
+
+        // diff size / full size of the last diff computed for this request
+        float DiffRatio = 0.0f;
+        int32 UpdatesSinceDiffProbe = 0;
     };
 
     struct FClientData
@@ -270,6 +345,8 @@ struct FIncppect::FImpl
     {
         for (auto& [ClientId, ClientData] : ClientDataMap)
         {
+            RequestingClientId = ClientId;
+
             TArray<uint8> CurBuffer;
             auto& PrevBuffer = ClientData.PrevBuffer;
 
@@ -295,6 +372,7 @@ struct FIncppect::FImpl
                 return PaddingBytes;
             };
 
+            const double DiffStartSeconds = FPlatformTime::Seconds();
             for (auto& [RequestId, Req] : ClientData.Requests)
             {
                 DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Getter"), STAT_Incppect_Getter, STATGROUP_Incppect);
@@ -316,10 +394,39 @@ struct FIncppect::FImpl
                     int32 DataSizeBytes = CurData.Num();
                     int32 PaddingBytes = GetPaddingBytes(DataSizeBytes);
 
+                    // the client already has this data
+                    if (Req.PrevData.Num() == CurData.Num() && (CurData.Num() == 0 || FMemory::Memcmp(Req.PrevData.GetData(), CurData.GetData(), CurData.Num()) == 0))
+                    {
+                        INC_DWORD_STAT(STAT_Incppect_NumSkipped);
+                        INC_DWORD_STAT_BY(STAT_Incppect_SavedBytes, DataSizeBytes);
+                        continue;
+                    }
+
                     int32 Type = 0; // full update
+                    TArray<uint8> DiffData;
                     if (Req.PrevData.Num() == CurData.Num() + PaddingBytes && CurData.Num() > 256)
                     {
-                        Type = 1; // run-length encoding of diff
+                        bool bTryDiff = true;
+                        if (Req.DiffRatio > kMaxDiffRatio)
+                        {
+                            Req.UpdatesSinceDiffProbe += 1;
+                            bTryDiff = Req.UpdatesSinceDiffProbe >= kDiffProbeInterval;
+                        }
+
+                        if (bTryDiff)
+                        {
+                            Req.UpdatesSinceDiffProbe = 0;
+                            if (WriteRleDiff(Req.PrevData.GetData(), CurData.GetData(), CurData.Num(), DataSizeBytes, DiffData))
+                            {
+                                Type = 1; // run-length encoding of diff
+                                Req.DiffRatio = (float)DiffData.Num() / DataSizeBytes;
+                            }
+                            else
+                            {
+                                Req.DiffRatio = 1.0f;
+                                INC_DWORD_STAT(STAT_Incppect_NumDiffRejected);
+                            }
+                        }
                     }
 
                     CurBuffer.Append(reinterpret_cast<uint8*>(&Type), sizeof(Type));
@@ -327,6 +434,8 @@ struct FIncppect::FImpl
 
                     if (Type == 0)
                     {
+                        INC_DWORD_STAT(STAT_Incppect_NumFull);
+                        INC_DWORD_STAT_BY(STAT_Incppect_SentBytes, DataSizeBytes);
                         CurBuffer.Append(reinterpret_cast<uint8*>(&DataSizeBytes), sizeof(DataSizeBytes));
                         CurBuffer.Append(CurData);
                         {
@@ -338,57 +447,9 @@ struct FIncppect::FImpl
                     }
                     else if (Type == 1)
                     {
-                        uint32 a = 0;
-                        uint32 b = 0;
-                        uint32 c = 0;
-                        uint32 n = 0;
-                        TArray<uint8> DiffData;
-                        for (int32 Idx = 0; Idx < CurData.Num(); Idx += 4)
-                        {
-                            FMemory::Memcpy(&a, Req.PrevData.GetData() + Idx, sizeof(a));
-                            FMemory::Memcpy(&b, CurData.GetData() + Idx, sizeof(b));
-                            a = a ^ b;
-                            if (a == c)
-                            {
-                                ++n;
-                            }
-                            else
-                            {
-                                if (n > 0)
-                                {
-                                    DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                                    DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-                                }
-                                n = 1;
-                                c = a;
-                            }
-                        }
-
-                        if (CurData.Num() % 4 != 0)
-                        {
-                            a = 0;
-                            b = 0;
-                            const uint32 Idx = (CurData.Num()/4)*4;
-                            const uint32 k = CurData.Num() - Idx;
-                            FMemory::Memcpy(&a, Req.PrevData.GetData() + Idx, k);
-                            FMemory::Memcpy(&b, CurData.GetData() + Idx, k);
-                            a = a ^ b;
-                            if (a == c)
-                            {
-                                ++n;
-                            }
-                            else
-                            {
-                                DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                                DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-                                n = 1;
-                                c = a;
-                            }
-                        }
-
-                        DiffData.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
-                        DiffData.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
-
+                        INC_DWORD_STAT(STAT_Incppect_NumDiff);
+                        INC_DWORD_STAT_BY(STAT_Incppect_SentBytes, DiffData.Num());
+                        INC_DWORD_STAT_BY(STAT_Incppect_SavedBytes, DataSizeBytes - DiffData.Num());
                         DataSizeBytes = DiffData.Num();
                         CurBuffer.Append(reinterpret_cast<uint8*>(&DataSizeBytes), sizeof(DataSizeBytes));
                         CurBuffer.Append(DiffData);
@@ -398,6 +459,8 @@ struct FIncppect::FImpl
                 }
             }
 
+            TickStats.DiffMs += (FPlatformTime::Seconds() - DiffStartSeconds) * 1000.0;
+
             if (ClientData.ToServerEvents.Num() > 0)
             {
                 for (const auto& Event : ClientData.ToServerEvents)
@@ -422,6 +485,8 @@ struct FIncppect::FImpl
             if (CurBuffer.Num() > 4)
             {
                 DECLARE_SCOPE_CYCLE_COUNTER(TEXT("Incppect_Diff"), STAT_Incppect_Diff, STATGROUP_Incppect);
+                const double SendStartSeconds = FPlatformTime::Seconds();
+                int32 SentBytes = CurBuffer.Num();
 
                 if (CurBuffer.Num() == PrevBuffer.Num() && CurBuffer.Num() > 256)
                 {
@@ -458,6 +523,7 @@ struct FIncppect::FImpl
                     DiffBuffer.Append(reinterpret_cast<uint8*>(&n), sizeof(n));
                     DiffBuffer.Append(reinterpret_cast<uint8*>(&c), sizeof(c));
 
+                    SentBytes = DiffBuffer.Num();
                     if (SocketDataMap[ClientId].Socket->Send(DiffBuffer.GetData(), DiffBuffer.Num(), false) == false)
                     {
                         UE_LOG(LogIncppect, Warning, TEXT("backpressure for client %d increased"), ClientId);
@@ -472,10 +538,13 @@ struct FIncppect::FImpl
                 }
 
                 TxTotalBytes += CurBuffer.Num();
+                TickStats.SentBytes.FindOrAdd(ClientId) += SentBytes;
+                TickStats.SendMs += (FPlatformTime::Seconds() - SendStartSeconds) * 1000.0;
 
                 PrevBuffer = MoveTemp(CurBuffer);
             }
         }
+        RequestingClientId = INDEX_NONE;
     }
 
     FParameters Parameters;
@@ -483,6 +552,10 @@ struct FIncppect::FImpl
     double TxTotalBytes = 0;
     double RxTotalBytes = 0;
 
+    // client whose requests are being served, lets getters return per client data
+    int32 RequestingClientId = INDEX_NONE;
+    FTickStats TickStats;
+
     TMap<TPath, int32> PathToGetter;
     TArray<TGetter> Getters;
 
@@ -520,6 +593,7 @@ void FIncppect::Init(const FParameters& Parameters)
 
 void FIncppect::Tick()
 {
+    Impl->TickStats = {};
     Impl->Server->Tick();
 }
 
@@ -533,6 +607,16 @@ int32 FIncppect::NumConnected() const
     return Impl->SocketDataMap.Num();
 }
 
+int32 FIncppect::RequestingClientId() const
+{
+    return Impl->RequestingClientId;
+}
+
+const FIncppect::FTickStats& FIncppect::GetTickStats() const
+{
+    return Impl->TickStats;
+}
+
 void FIncppect::Var(const TPath& Path, TGetter&& Getter)
 {
     Impl->PathToGetter.Add(Path, Impl->Getters.Num());
@@ -541,6 +625,14 @@ void FIncppect::Var(const TPath& Path, TGetter&& Getter)
 
 void FIncppect::ServerEvent(int32 ClientId, int32 EventId, TArray<uint8>&& Payload)
 {
+    if (ClientId == INDEX_NONE)
+    {
+        for (auto& [Id, ClientData] : Impl->ClientDataMap)
+        {
+            ClientData.ToServerEvents.Add({ EventId, Payload });
+        }
+        return;
+    }
     if (const auto ClientData = Impl->ClientDataMap.Find(ClientId))
     {
         ClientData->ToServerEvents.Add({ EventId, MoveTemp(Payload) });
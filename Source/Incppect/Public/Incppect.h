@@ -52,6 +52,21 @@ public:
     // number of connected clients
     int32 NumConnected() const;
 
+    // id of the client being updated while a getter runs, INDEX_NONE outside of getters
+    int32 RequestingClientId() const;
+
+    // work done by the updates of the last Tick
+    struct FTickStats
+    {
+        // getters and per var diffs
+        double DiffMs = 0.0;
+        // message diff and socket send
+        double SendMs = 0.0;
+        // by client id
+        TMap<int32, int32> SentBytes;
+    };
+    const FTickStats& GetTickStats() const;
+
     // define variable/memory to inspect
     //
     // examples:
@@ -61,7 +76,7 @@ public:
     //   Var("path2[%d].foo[%d]", [](auto idxs) { ... idxs[0], idxs[1] ... });
     //
     void Var(const TPath& Path, TGetter&& Getter);
-    // direct send event to server
+    // direct send event to server, INDEX_NONE sends it to every client
     void ServerEvent(int32 ClientId, int32 EventId, TArray<uint8>&& Payload);
 
     // handle input from the clients